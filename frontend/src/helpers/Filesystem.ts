@@ -1,6 +1,7 @@
 import axios from "axios";
 import { ApiPaths, ApiResponse } from "../types/Api";
 import { Notify } from "quasar";
+import { Peaks } from "../types/Filesystem";
 
 // Make API request to delete a file
 export function deleteFile(filepath: string)
@@ -30,4 +31,14 @@ export function deleteFile(filepath: string)
       });
     }
   });
-}
\ No newline at end of file
+}
+
+// Fetch waveform peaks of a recording, resolves to null while the peaks are being generated
+export async function fetchPeaks(filepath: string, points: number, start_ms = 0, end_ms = 0): Promise<Peaks | null>
+{
+  const response = await axios.get(ApiPaths.Peaks + filepath, {
+    params: { start_ms, end_ms, points }
+  });
+
+  return response.status === 202 ? null : response.data;
+}
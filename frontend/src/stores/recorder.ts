@@ -2,7 +2,7 @@ import { defineStore } from "pinia";
 import { ApiPaths, ApiResponse } from "../types/Api";
 import { Notify } from "quasar";
 import axios from "axios";
-import { Recorder, RecordParam } from "../types/Recorder";
+import { Recorder, RecordFormat, RecordParam } from "../types/Recorder";
 
 const axiosInstance = axios.create();
 axiosInstance.defaults.timeout = 600;
@@ -13,13 +13,25 @@ export const useRecorderStore = defineStore({
     filepath: "sample.wav",
     duration_seconds: 10,
     duration_minutes: 0,
-    duration_hours: 0
+    duration_hours: 0,
+    segment_sec: 0,
+    segment_mb: 0,
+    min_free_mb: 0,
+    format: RecordFormat.PCM,
+    logger: 0,
+    sample_rate: 32000
   }),
   actions: {
     async scheduleRecording() {
       const recordParam: RecordParam = {
         filepath: this.filepath,
-        duration_sec: this.durationTotalInSeconds
+        duration_sec: this.durationTotalInSeconds,
+        segment_sec: this.segment_sec,
+        segment_mb: this.segment_mb,
+        min_free_mb: this.min_free_mb,
+        format: this.format,
+        logger: this.logger,
+        sample_rate: this.sample_rate
       }
       const jsonData = JSON.stringify(recordParam);
       axiosInstance
@@ -41,6 +53,27 @@ export const useRecorderStore = defineStore({
           if (error.response) {
             let response: ApiResponse = error.response;
 
+            Notify.create({
+              message: response.data.response,
+              color: "negative"
+            });
+          }
+        });
+    },
+    async stopRecording() {
+      axiosInstance
+        .delete(ApiPaths.Record)
+        .then((response: ApiResponse) => {
+          Notify.create({
+            message: response.data.response,
+            color: "positive"
+          });
+        })
+        .catch((error) => {
+          console.error(error);
+          if (error.response) {
+            let response: ApiResponse = error.response;
+
             Notify.create({
               message: response.data.response,
               color: "negative"
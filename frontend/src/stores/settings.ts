@@ -22,16 +22,26 @@ export const useSettingsStore = defineStore({
     "gpio.ptt": 13,
     "audio.out.volume": 100,
     "audio.in.squelch": 3,
+    "audio.in.upsample_factor": 2,
+    "audio.in.preroll_ms": 500,
+    "audio.in.agc": 1,
+    "audio.in.filter": 0,
+    "audio.in.packet": 1,
+    "audio.in.cw": 0,
     "led.max_brightness": 5,
     "beacon.mode": BeaconMode.MORSE_CODE,
     "beacon.text": "-..--.",
     "beacon.delay_seconds": 12,
-    "beacon.morse_code.baud": 5,
+    "beacon.morse_code.wpm": 12,
+    "beacon.morse_code.farnsworth_wpm": 0,
     "beacon.morse_code.tone_freq": 800,
     "beacon.afsk.baud": 1200,
     "beacon.afsk.zero_freq": 2200,
     "beacon.afsk.one_freq": 1200,
-    "beacon.wav.filepath": "/storage/sample.wav"
+    "beacon.wav.filepath": "/storage/sample.wav",
+    "beacon.aprs.callsign": "N0CALL",
+    "beacon.aprs.destination": "APRS",
+    "beacon.aprs.path": "WIDE1-1,WIDE2-1"
   }),
   actions: {
     async fetchSettings() {
@@ -8,7 +8,8 @@ export enum ApiPaths {
   DeepSleep = "/api/system/deep_sleep",
   FactoryReset = "/api/system/factory_reset",
   FileUpload = "/upload",
-  FileDelete = "/delete"
+  FileDelete = "/delete",
+  Peaks = "/api/audio/peaks"
 }
 
 export interface ApiResponse {
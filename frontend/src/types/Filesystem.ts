@@ -20,4 +20,13 @@ export interface Listing {
 export interface StoragePath {
   prefix :string;
   path :string;
-}
\ No newline at end of file
+}
+
+// Waveform peaks of a recording, min and max value pairs from -128 to 127
+export interface Peaks {
+  peak_ms: number;
+  duration_ms: number;
+  start_ms: number;
+  end_ms: number;
+  peaks: number[];
+}
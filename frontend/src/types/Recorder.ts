@@ -3,9 +3,28 @@ export interface Recorder {
   duration_seconds: number
   duration_minutes: number
   duration_hours: number
+  segment_sec: number
+  segment_mb: number
+  min_free_mb: number
+  format: RecordFormat
+  logger: number
+  sample_rate: number
+}
+
+export enum RecordFormat {
+  PCM = 0,
+  IMA_ADPCM = 1,
+  CODEC2_3200 = 2,
+  CODEC2_1600 = 3
 }
 
 export interface RecordParam {
   filepath: string,
   duration_sec: number
+  segment_sec: number
+  segment_mb: number
+  min_free_mb: number
+  format: RecordFormat
+  logger: number
+  sample_rate: number
 }
\ No newline at end of file
@@ -8,7 +8,8 @@ export enum BeaconMode {
   OFF,
   MORSE_CODE,
   AFSK,
-  WAV
+  WAV,
+  APRS
 }
 
 export interface Settings {
@@ -23,14 +24,24 @@ export interface Settings {
   "gpio.ptt": number;
   "audio.out.volume": number;
   "audio.in.squelch": number;
+  "audio.in.upsample_factor": number;
+  "audio.in.preroll_ms": number;
+  "audio.in.agc": number;
+  "audio.in.filter": number;
+  "audio.in.packet": number;
+  "audio.in.cw": number;
   "led.max_brightness": number;
   "beacon.mode": BeaconMode;
   "beacon.text": string;
   "beacon.delay_seconds": number;
-  "beacon.morse_code.baud": number;
+  "beacon.morse_code.wpm": number;
+  "beacon.morse_code.farnsworth_wpm": number;
   "beacon.morse_code.tone_freq": number;
   "beacon.afsk.baud": number;
   "beacon.afsk.zero_freq": number;
   "beacon.afsk.one_freq": number;
   "beacon.wav.filepath": string;
+  "beacon.aprs.callsign": string;
+  "beacon.aprs.destination": string;
+  "beacon.aprs.path": string;
 }
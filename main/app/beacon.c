@@ -21,10 +21,59 @@
 
 #include "settings.h"
 #include "transmit.h"
-#include "helper/rtos.h"
 
 static const char *TAG = "APP/BEACON";
 
+// Queue beacon of the configured mode, the transmit queue copies the text
+static void BEACON_Queue(void)
+{
+    switch (gSettings.beacon.mode)
+    {
+    case SETTINGS_BEACON_MODE_OFF:
+        break;
+
+    case SETTINGS_BEACON_MODE_AFSK:
+        TRANSMIT_AfskParam_t afsk_param = {
+            .input = gSettings.beacon.text,
+            .len = strlen(gSettings.beacon.text),
+            .baud = gSettings.beacon.afsk.baud,
+            .zero_freq = gSettings.beacon.afsk.zero_freq,
+            .one_freq = gSettings.beacon.afsk.one_freq};
+
+        TRANSMIT_Afsk(&afsk_param, TRANSMIT_PRIORITY_LOW);
+        break;
+
+    case SETTINGS_BEACON_MODE_MORSE_CODE:
+        TRANSMIT_MorseCodeParam_t morse_code_param = {
+            .input = gSettings.beacon.text,
+            .len = strlen(gSettings.beacon.text),
+            .wpm = gSettings.beacon.morse_code.wpm,
+            .farnsworth_wpm = gSettings.beacon.morse_code.farnsworth_wpm,
+            .tone_freq = gSettings.beacon.morse_code.tone_freq};
+
+        TRANSMIT_MorseCode(&morse_code_param, TRANSMIT_PRIORITY_LOW);
+        break;
+
+    case SETTINGS_BEACON_MODE_WAV:
+        TRANSMIT_WavParam_t wav_param;
+
+        strlcpy(wav_param.filepath, gSettings.beacon.wav.filepath, sizeof(wav_param.filepath));
+        TRANSMIT_Wav(&wav_param, TRANSMIT_PRIORITY_LOW);
+        break;
+
+    case SETTINGS_BEACON_MODE_APRS:
+        TRANSMIT_AprsParam_t aprs_param = {
+            .input = gSettings.beacon.text,
+            .len = strlen(gSettings.beacon.text),
+            .source = gSettings.beacon.aprs.callsign,
+            .destination = gSettings.beacon.aprs.destination,
+            .path = gSettings.beacon.aprs.path};
+
+        TRANSMIT_Aprs(&aprs_param, TRANSMIT_PRIORITY_LOW);
+        break;
+    }
+}
+
 void BEACON_Scheduler(void *pvParameters)
 {
     uint32_t delay_in_ms = gSettings.beacon.delay_seconds * 1000;
@@ -33,38 +82,18 @@ void BEACON_Scheduler(void *pvParameters)
 
     while (1)
     {
-        switch (gSettings.beacon.mode)
+        TRANSMIT_Status_t status;
+
+        TRANSMIT_GetStatus(&status);
+
+        // Beacons are not queued behind transmissions still waiting, so they never pile up
+        if (gSettings.beacon.mode != SETTINGS_BEACON_MODE_OFF && status.depth > 0)
+        {
+            ESP_LOGW(TAG, "Transmit queue is busy, beacon skipped.");
+        }
+        else
         {
-        case SETTINGS_BEACON_MODE_OFF:
-            break;
-
-        case SETTINGS_BEACON_MODE_AFSK:
-            // Schedule transmit task
-            TRANSMIT_AfskParam_t afsk_param = {
-                .input = gSettings.beacon.text,
-                .len = strlen(gSettings.beacon.text),
-                .baud = gSettings.beacon.afsk.baud,
-                .zero_freq = gSettings.beacon.afsk.zero_freq,
-                .one_freq = gSettings.beacon.afsk.one_freq};
-
-            xTaskCreate(TRANSMIT_Afsk, "TRANSMIT_Afsk", 4096, &afsk_param, RTOS_PRIORITY_HIGHEST, NULL);
-            break;
-
-        case SETTINGS_BEACON_MODE_MORSE_CODE:
-            // Schedule transmit task
-            TRANSMIT_MorseCodeParam_t morse_code_param = {
-                .input = gSettings.beacon.text,
-                .len = strlen(gSettings.beacon.text)};
-
-            xTaskCreate(TRANSMIT_MorseCode, "TRANSMIT_MorseCode", 4096, &morse_code_param, RTOS_PRIORITY_HIGHEST, NULL);
-            break;
-
-        case SETTINGS_BEACON_MODE_WAV:
-            // Schedule transmit task
-            TRANSMIT_WavParam_t wav_param;
-            strcpy(wav_param.filepath, gSettings.beacon.wav.filepath);
-            xTaskCreate(TRANSMIT_Wav, "TRANSMIT_Wav", 4096, &wav_param, RTOS_PRIORITY_HIGHEST, NULL);
-            break;
+            BEACON_Queue();
         }
 
         // Delay before re-scheduling attempt
@@ -0,0 +1,115 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_cpu.h>
+
+#include "cwreader.h"
+#include "settings.h"
+#include "hardware/audio.h"
+#include "helper/telemetry.h"
+#include "dsp/cw.h"
+#include "web/handlers/websocket.h"
+
+static const char *TAG = "APP/CWREADER";
+
+// Decoder state is too big for the task stack
+static CW_t cw;
+
+// Text of the word being received
+static char text[CWREADER_TEXT_SIZE + 1];
+static size_t textLen = 0;
+
+// Send the text received so far
+static void CWREADER_Flush(void)
+{
+    if (textLen == 0)
+        return;
+
+    text[textLen] = '\0';
+
+    ESP_LOGI(TAG, "Received: %s (%u Hz, %u wpm)", text, CW_Frequency(&cw), CW_Wpm(&cw));
+    WEBSOCKET_Send(TAG, "%s", text);
+
+    textLen = 0;
+}
+
+// Handle decoded character, text goes out word by word
+static void CWREADER_Character(char c, void *arg)
+{
+    if (c == ' ')
+    {
+        CWREADER_Flush();
+        return;
+    }
+
+    text[textLen++] = c;
+
+    if (textLen == CWREADER_TEXT_SIZE)
+    {
+        CWREADER_Flush();
+    }
+}
+
+// Task decoding Morse code from the audio input
+// Subscribes to the audio bus like the recorder does, so it runs next to it
+void CWREADER_Task(void *pvParameters)
+{
+    BUS_Consumer_t *consumer = NULL;
+    const BUS_Block_t *block;
+
+    if (gSettings.audio.in.cw != SETTINGS_TRUE)
+    {
+        ESP_LOGI(TAG, "CW decoder disabled.");
+        goto Done;
+    }
+
+    if (!CW_Init(&cw, AUDIO_INPUT_SAMPLE_FREQ, CWREADER_Character, NULL))
+    {
+        ESP_LOGE(TAG, "Unsupported decoder parameters");
+        goto Done;
+    }
+
+    consumer = AUDIO_Subscribe("cw");
+
+    if (consumer == NULL)
+        goto Done;
+
+    ESP_LOGI(TAG, "CW decoder started.");
+
+    while (1)
+    {
+        // ADC is stopped while transmitting, there is nothing to decode until it comes back
+        block = AUDIO_WaitBlock(consumer, AUDIO_INPUT_BLOCK_TIMEOUT_MS);
+
+        if (block == NULL)
+            continue;
+
+        const uint32_t cycles_start = esp_cpu_get_cycle_count();
+
+        CW_Process(&cw, block->samples, block->len);
+        BUS_Release(&gAudioBus, consumer);
+
+        TELEMETRY_Record(TELEMETRY_STAGE_CW, esp_cpu_get_cycle_count() - cycles_start);
+    }
+
+Done:
+    // Delete self
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,26 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef APP_CWREADER_H
+#define APP_CWREADER_H
+
+// Define max amount of characters sent in one websocket message, the text is sent at each word end anyway
+#define CWREADER_TEXT_SIZE 64
+
+void CWREADER_Task(void *pvParameters);
+
+#endif
@@ -0,0 +1,144 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_cpu.h>
+
+#include "packet.h"
+#include "writer.h"
+#include "settings.h"
+#include "hardware/audio.h"
+#include "helper/telemetry.h"
+#include "dsp/ax25.h"
+#include "dsp/demod.h"
+#include "web/handlers/websocket.h"
+
+_Static_assert(AX25_MAX_FRAME_SIZE + HDLC_FCS_SIZE <= HDLC_MAX_FRAME_SIZE, "AX.25 frame does not fit the HDLC decoder");
+
+static const char *TAG = "APP/PACKET";
+
+// Demodulator state is too big for the task stack
+static DEMOD_t demod;
+
+// Append log line, runs on the writer task so slow SD card never stalls the demodulator
+static void PACKET_LogWrite(void *arg)
+{
+    char *line = (char *)arg;
+    FILE *fd = fopen(PACKET_LOG_FILEPATH, "a");
+
+    if (fd == NULL)
+    {
+        ESP_LOGW(TAG, "Failed to open %s", PACKET_LOG_FILEPATH);
+    }
+    else
+    {
+        fputs(line, fd);
+        fclose(fd);
+    }
+
+    free(line);
+}
+
+// Handle decoded frame
+static void PACKET_Received(const uint8_t *frame, size_t len, void *arg)
+{
+    char text[AX25_MAX_TEXT_SIZE];
+
+    // Good FCS on a frame that is not AX.25 UI is most likely noise
+    if (AX25_Format(frame, len, text, sizeof(text)) == 0)
+        return;
+
+    ESP_LOGI(TAG, "Received: %s", text);
+    WEBSOCKET_Send(TAG, "%s", text);
+
+    char *line = malloc(PACKET_LOG_TIMESTAMP_SIZE + strlen(text) + 2);
+
+    if (line == NULL)
+    {
+        ESP_LOGE(TAG, "Packet log malloc failed");
+        return;
+    }
+
+    // Counts from boot unless the clock was set
+    const time_t now = time(NULL);
+    struct tm tm;
+
+    localtime_r(&now, &tm);
+    strftime(line, PACKET_LOG_TIMESTAMP_SIZE, "%Y-%m-%d %H:%M:%S ", &tm);
+    strcat(line, text);
+    strcat(line, "\n");
+
+    // Dropped while the storage is behind, the frame was shown on the websocket already
+    if (!WRITER_Call(PACKET_LogWrite, line))
+    {
+        free(line);
+    }
+}
+
+// Task decoding AX.25 packets from the audio input
+// Subscribes to the audio bus like the recorder does, so it runs next to it
+void PACKET_Task(void *pvParameters)
+{
+    BUS_Consumer_t *consumer = NULL;
+    const BUS_Block_t *block;
+
+    if (gSettings.audio.in.packet != SETTINGS_TRUE)
+    {
+        ESP_LOGI(TAG, "Packet decoder disabled.");
+        goto Done;
+    }
+
+    if (!DEMOD_Init(&demod, AUDIO_INPUT_SAMPLE_FREQ, PACKET_BAUD, PACKET_MARK_FREQ, PACKET_SPACE_FREQ, PACKET_Received, NULL))
+    {
+        ESP_LOGE(TAG, "Unsupported demodulator parameters");
+        goto Done;
+    }
+
+    consumer = AUDIO_Subscribe("packet");
+
+    if (consumer == NULL)
+        goto Done;
+
+    ESP_LOGI(TAG, "Packet decoder started.");
+
+    while (1)
+    {
+        // ADC is stopped while transmitting, there is nothing to decode until it comes back
+        block = AUDIO_WaitBlock(consumer, AUDIO_INPUT_BLOCK_TIMEOUT_MS);
+
+        if (block == NULL)
+            continue;
+
+        const uint32_t cycles_start = esp_cpu_get_cycle_count();
+
+        // Demodulate straight from the bus, block overwritten meanwhile only damages the frame in flight and fails its FCS
+        DEMOD_Process(&demod, block->samples, block->len);
+        BUS_Release(&gAudioBus, consumer);
+
+        TELEMETRY_Record(TELEMETRY_STAGE_DEMOD, esp_cpu_get_cycle_count() - cycles_start);
+    }
+
+Done:
+    // Delete self
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,34 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef APP_PACKET_H
+#define APP_PACKET_H
+
+#include "hardware/sd.h"
+
+// Define received packet modulation, Bell 202 AFSK
+#define PACKET_BAUD 1200
+#define PACKET_MARK_FREQ 1200
+#define PACKET_SPACE_FREQ 2200
+// Define log of the received packets, one line in TNC2 format per packet
+#define PACKET_LOG_FILEPATH SD_BASE_PATH "/packets.log"
+// Define size of the timestamp in front of each log line
+#define PACKET_LOG_TIMESTAMP_SIZE 24
+
+void PACKET_Task(void *pvParameters);
+
+#endif
@@ -15,113 +15,487 @@
  */
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "transmit.h"
 #include "hardware/audio.h"
 #include "hardware/ptt.h"
+#include "helper/misc.h"
 #include "settings.h"
+#include "dsp/ax25.h"
+#include "dsp/hdlc.h"
+#include "dsp/morse.h"
 
 static const char *TAG = "APP/TRANSMIT";
 
-// Task to transmit morse code message
-void TRANSMIT_MorseCode(void *pvParameters)
+// Transmit job, param strings point into the payload which the job owns
+typedef struct
 {
-    TRANSMIT_MorseCodeParam_t *param = (TRANSMIT_MorseCodeParam_t *)pvParameters;
+    bool queued;                  // slot holds a job waiting to be transmitted
+    TRANSMIT_JobType_t type;
+    TRANSMIT_Priority_t priority;
+    uint32_t sequence;            // queue order, same priority jobs go first in first out
+    int64_t queued_us;            // time the job was queued
+    void *payload;                // freed once the job is done or dropped
+    union
+    {
+        TRANSMIT_ToneParam_t tone;
+        TRANSMIT_MorseCodeParam_t morse_code;
+        TRANSMIT_AfskParam_t afsk;
+        size_t aprs_bits;         // APRS frames are HDLC encoded when queued, payload holds the line bits
+        TRANSMIT_WavParam_t wav;
+        TRANSMIT_StreamParam_t stream;
+    } param;
+} TRANSMIT_Job_t;
+
+static const char *jobNames[] = {
+    "tone",
+    "morse_code",
+    "afsk",
+    "aprs",
+    "wav",
+    "stream"};
+
+// Jobs waiting to be transmitted, guarded by queueMutex
+static TRANSMIT_Job_t jobs[TRANSMIT_QUEUE_SIZE];
+static uint32_t sequence;
+static TRANSMIT_Status_t status;
+static SemaphoreHandle_t queueMutex;
+// Notified for each queued job
+static TaskHandle_t transmitTaskHandle;
+
+// Free what the job owns, the stream producer is told its job is over
+static void TRANSMIT_Release(TRANSMIT_Job_t *job)
+{
+    free(job->payload);
+    job->payload = NULL;
 
-    // TODO: This is wrong, it should be delivered as param
-    uint16_t dot_duration_ms = 1000 / gSettings.beacon.morse_code.baud;
+    if (job->type == TRANSMIT_JOB_STREAM && job->param.stream.done != NULL)
+    {
+        job->param.stream.done(job->param.stream.arg);
+    }
+}
 
-    PTT_Press();
+// Copy text into the payload at the cursor and move the cursor past it
+static char *TRANSMIT_Copy(char **cursor, const char *text, size_t len)
+{
+    char *copy = *cursor;
 
-    esp_err_t ret = AUDIO_TransmitStart();
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    *cursor += len + 1;
 
-    // If we cannot start TX (audio resource likely busy) we abort
-    if (ret == ESP_FAIL)
-        goto Done;
+    return copy;
+}
 
-    ESP_LOGI(TAG, "Transmitting <Morse code>: %s", param->input);
-    ESP_LOGI(TAG, "dot_duration_ms: %d", dot_duration_ms);
+// Put the job into a free slot, the queue takes over what the job owns even if it fails
+static esp_err_t TRANSMIT_Queue(TRANSMIT_Job_t *job, TRANSMIT_Priority_t priority)
+{
+    TRANSMIT_Job_t *slot = NULL;
+
+    if (queueMutex == NULL)
+    {
+        ESP_LOGE(TAG, "Transmit task is not running");
+        TRANSMIT_Release(job);
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    for (uint8_t i = 0; i < param->len; i++)
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+
+    for (size_t i = 0; i < TRANSMIT_QUEUE_SIZE; i++)
     {
-        switch (param->input[i])
+        if (!jobs[i].queued)
         {
-        case '.':
-            AUDIO_PlayTone(gSettings.beacon.morse_code.tone_freq, dot_duration_ms);
-            vTaskDelay(dot_duration_ms / portTICK_PERIOD_MS);
-            break;
-        case '-':
-            AUDIO_PlayTone(gSettings.beacon.morse_code.tone_freq, dot_duration_ms * 3);
-            vTaskDelay(dot_duration_ms / portTICK_PERIOD_MS);
+            slot = &jobs[i];
             break;
         }
-        vTaskDelay((dot_duration_ms * 3) / portTICK_PERIOD_MS);
     }
 
-    AUDIO_TransmitStop();
+    if (slot == NULL)
+    {
+        status.rejected++;
+        xSemaphoreGive(queueMutex);
 
-    PTT_Release();
+        ESP_LOGW(TAG, "Transmit queue is full, %s job dropped", jobNames[job->type]);
+        TRANSMIT_Release(job);
+        return ESP_ERR_NO_MEM;
+    }
 
-Done:
+    *slot = *job;
+    slot->queued = true;
+    slot->priority = priority;
+    slot->sequence = sequence++;
+    slot->queued_us = esp_timer_get_time();
+
+    status.depth++;
+    status.max_depth = MAX(status.max_depth, status.depth);
+
+    xSemaphoreGive(queueMutex);
+
+    xTaskNotifyGive(transmitTaskHandle);
 
-    // Delete self
-    vTaskDelete(NULL);
+    return ESP_OK;
 }
 
-// Task to transmit AFSK message
-void TRANSMIT_Afsk(void *pvParameters)
+// Take the highest priority job out of the queue
+// Returns false if the queue is empty
+static bool TRANSMIT_Next(TRANSMIT_Job_t *job)
 {
-    TRANSMIT_AfskParam_t *param = (TRANSMIT_AfskParam_t *)pvParameters;
+    TRANSMIT_Job_t *next = NULL;
 
-    esp_err_t ret = AUDIO_TransmitStart();
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
 
-    // If we cannot start TX (audio resource likely busy) we abort
-    if (ret == ESP_FAIL)
-        goto Done;
+    for (size_t i = 0; i < TRANSMIT_QUEUE_SIZE; i++)
+    {
+        if (!jobs[i].queued)
+            continue;
+
+        if (next == NULL || jobs[i].priority > next->priority ||
+            (jobs[i].priority == next->priority && (int32_t)(jobs[i].sequence - next->sequence) < 0))
+        {
+            next = &jobs[i];
+        }
+    }
+
+    if (next != NULL)
+    {
+        const uint32_t wait_ms = (esp_timer_get_time() - next->queued_us) / 1000;
 
-    PTT_Press();
+        *job = *next;
+        next->queued = false;
 
-    ESP_LOGI(TAG, "Transmitting <Afsk>: %s", param->input);
+        status.depth--;
+        status.active = true;
+        status.job = job->type;
+        status.jobs++;
+        status.last_wait_ms = wait_ms;
+        status.max_wait_ms = MAX(status.max_wait_ms, wait_ms);
+        status.total_wait_ms += wait_ms;
 
-    AUDIO_PlayAFSK(
-        (const uint8_t *)param->input,
-        param->len,
-        param->baud,
-        param->zero_freq,
-        param->one_freq);
+        // Cancel only applies to the jobs queued before it
+        AUDIO_SetPlayCancelled(false);
+    }
 
-    AUDIO_TransmitStop();
+    xSemaphoreGive(queueMutex);
 
-    PTT_Release();
+    return next != NULL;
+}
 
-Done:
+// Mark the job taken by TRANSMIT_Next as done, dropped is set if it never went on air
+static void TRANSMIT_Done(bool dropped)
+{
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
 
-    // Delete self
-    vTaskDelete(NULL);
+    status.active = false;
+
+    if (dropped)
+    {
+        status.jobs--;
+        status.rejected++;
+    }
+
+    xSemaphoreGive(queueMutex);
 }
 
-// Task to transmit .wav audio file
-void TRANSMIT_Wav(void *pvParameters)
+/// @brief Queue single tone
+/// @param param tone frequency and duration
+/// @param priority queue priority
+/// @return ESP_ERR_NO_MEM if the queue is full
+esp_err_t TRANSMIT_Tone(const TRANSMIT_ToneParam_t *param, TRANSMIT_Priority_t priority)
 {
-    TRANSMIT_WavParam_t *param = (TRANSMIT_WavParam_t *)pvParameters;
+    TRANSMIT_Job_t job = {.type = TRANSMIT_JOB_TONE, .param.tone = *param};
+
+    return TRANSMIT_Queue(&job, priority);
+}
+
+/// @brief Queue Morse code message, the text is copied
+/// @param param text and keying speed
+/// @param priority queue priority
+/// @return ESP_ERR_NO_MEM if the queue is full or out of memory
+esp_err_t TRANSMIT_MorseCode(const TRANSMIT_MorseCodeParam_t *param, TRANSMIT_Priority_t priority)
+{
+    TRANSMIT_Job_t job = {.type = TRANSMIT_JOB_MORSE_CODE, .param.morse_code = *param};
+    char *cursor = job.payload = malloc(param->len + 1);
+
+    if (job.payload == NULL)
+    {
+        ESP_LOGE(TAG, "Morse code payload malloc failed");
+        return ESP_ERR_NO_MEM;
+    }
+
+    job.param.morse_code.input = TRANSMIT_Copy(&cursor, param->input, param->len);
+
+    return TRANSMIT_Queue(&job, priority);
+}
+
+/// @brief Queue AFSK message, the data is copied
+/// @param param data and modulation
+/// @param priority queue priority
+/// @return ESP_ERR_NO_MEM if the queue is full or out of memory
+esp_err_t TRANSMIT_Afsk(const TRANSMIT_AfskParam_t *param, TRANSMIT_Priority_t priority)
+{
+    TRANSMIT_Job_t job = {.type = TRANSMIT_JOB_AFSK, .param.afsk = *param};
+    char *cursor = job.payload = malloc(param->len + 1);
+
+    if (job.payload == NULL)
+    {
+        ESP_LOGE(TAG, "AFSK payload malloc failed");
+        return ESP_ERR_NO_MEM;
+    }
+
+    job.param.afsk.input = TRANSMIT_Copy(&cursor, param->input, param->len);
+
+    return TRANSMIT_Queue(&job, priority);
+}
+
+/// @brief Queue APRS packet, it is built as AX.25 UI frame and HDLC encoded right away
+/// @param param information field and addresses
+/// @param priority queue priority
+/// @return ESP_ERR_INVALID_ARG if the frame cannot be built, ESP_ERR_NO_MEM if the queue is full or out of memory
+esp_err_t TRANSMIT_Aprs(const TRANSMIT_AprsParam_t *param, TRANSMIT_Priority_t priority)
+{
+    TRANSMIT_Job_t job = {.type = TRANSMIT_JOB_APRS};
+    uint8_t frame[AX25_MAX_FRAME_SIZE];
+    const size_t size = HDLC_ENCODED_SIZE(AX25_MAX_FRAME_SIZE, TRANSMIT_APRS_PREAMBLE_FLAGS + TRANSMIT_APRS_TAIL_FLAGS);
+    HDLC_Encoder_t encoder;
+
+    const size_t len = AX25_BuildUI(frame, sizeof(frame), param->source, param->destination, param->path, (const uint8_t *)param->input, param->len);
+
+    if (len == 0)
+    {
+        ESP_LOGE(TAG, "Invalid APRS frame, check callsign, destination and path");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    job.payload = malloc(size);
+
+    if (job.payload == NULL)
+    {
+        ESP_LOGE(TAG, "APRS line bits malloc failed");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Flags ahead of the frame give the receiver time to open squelch and lock on
+    HDLC_EncoderInit(&encoder, job.payload, size);
+    HDLC_EncodeFlags(&encoder, TRANSMIT_APRS_PREAMBLE_FLAGS);
+    HDLC_EncodeFrame(&encoder, frame, len);
+    HDLC_EncodeFlags(&encoder, TRANSMIT_APRS_TAIL_FLAGS);
 
-    esp_err_t ret = AUDIO_TransmitStart();
+    job.param.aprs_bits = encoder.bits;
 
-    // If we cannot start TX (audio resource likely busy) we abort
-    if (ret == ESP_FAIL)
+    ESP_LOGI(TAG, "Queued <APRS>: %s>%s,%s:%.*s", param->source, param->destination, param->path, param->len, param->input);
+
+    return TRANSMIT_Queue(&job, priority);
+}
+
+/// @brief Queue .wav audio file
+/// @param param file path
+/// @param priority queue priority
+/// @return ESP_ERR_NO_MEM if the queue is full
+esp_err_t TRANSMIT_Wav(const TRANSMIT_WavParam_t *param, TRANSMIT_Priority_t priority)
+{
+    TRANSMIT_Job_t job = {.type = TRANSMIT_JOB_WAV, .param.wav = *param};
+
+    return TRANSMIT_Queue(&job, priority);
+}
+
+/// @brief Queue stream of samples produced on the fly
+/// The done callback is called once the stream ends, is cancelled or cannot be queued
+/// @param param sample and done callbacks
+/// @param priority queue priority
+/// @return ESP_ERR_NO_MEM if the queue is full
+esp_err_t TRANSMIT_Stream(const TRANSMIT_StreamParam_t *param, TRANSMIT_Priority_t priority)
+{
+    TRANSMIT_Job_t job = {.type = TRANSMIT_JOB_STREAM, .param.stream = *param};
+
+    return TRANSMIT_Queue(&job, priority);
+}
+
+// Drop the queued jobs and stop the one on air at its next block
+void TRANSMIT_Cancel(void)
+{
+    if (queueMutex == NULL)
+        return;
+
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+
+    for (size_t i = 0; i < TRANSMIT_QUEUE_SIZE; i++)
+    {
+        if (!jobs[i].queued)
+            continue;
+
+        jobs[i].queued = false;
+        TRANSMIT_Release(&jobs[i]);
+        status.cancelled++;
+    }
+
+    status.depth = 0;
+
+    if (status.active)
+    {
+        AUDIO_SetPlayCancelled(true);
+        status.cancelled++;
+    }
+
+    xSemaphoreGive(queueMutex);
+
+    ESP_LOGI(TAG, "Transmissions cancelled.");
+}
+
+// Snapshot of the queue statistics
+void TRANSMIT_GetStatus(TRANSMIT_Status_t *output)
+{
+    if (queueMutex == NULL)
+    {
+        *output = (TRANSMIT_Status_t){0};
+        return;
+    }
+
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+    *output = status;
+    xSemaphoreGive(queueMutex);
+}
+
+// Reset the counters, the queue itself is kept
+void TRANSMIT_ResetStatus(void)
+{
+    if (queueMutex == NULL)
+        return;
+
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+    status = (TRANSMIT_Status_t){.depth = status.depth, .max_depth = status.depth, .active = status.active, .job = status.job};
+    xSemaphoreGive(queueMutex);
+}
+
+const char *TRANSMIT_JobName(TRANSMIT_JobType_t type)
+{
+    return jobNames[type];
+}
+
+// Transmit Morse code message
+static void TRANSMIT_PlayMorseCode(const TRANSMIT_MorseCodeParam_t *param)
+{
+    const size_t max = MORSE_MAX_ELEMENTS(param->len);
+    MORSE_Element_t *elements = malloc(max * sizeof(MORSE_Element_t));
+    AUDIO_Tone_t *tones = malloc(max * sizeof(AUDIO_Tone_t));
+    MORSE_Timing_t timing;
+
+    if (elements == NULL || tones == NULL)
+    {
+        ESP_LOGE(TAG, "Morse code elements malloc failed");
         goto Done;
+    }
+
+    // Whole message is timed up front, so it is played sample accurate no matter the RTOS load
+    MORSE_Timing(&timing, param->wpm, param->farnsworth_wpm);
 
-    PTT_Press();
+    const size_t count = MORSE_Encode(param->input, param->len, &timing, elements, max);
 
-    AUDIO_PlayWav(param->filepath);
+    for (size_t i = 0; i < count; i++)
+    {
+        tones[i] = (AUDIO_Tone_t){.freq = elements[i].key ? param->tone_freq : 0, .duration_ms = elements[i].duration_ms};
+    }
 
-    AUDIO_TransmitStop();
+    ESP_LOGI(TAG, "Transmitting <Morse code>: %s", param->input);
+    ESP_LOGI(TAG, "dot: %d ms, letter gap: %d ms, word gap: %d ms", timing.dot_ms, timing.letter_gap_ms, timing.word_gap_ms);
 
-    PTT_Release();
+    AUDIO_PlayTones(tones, count);
 
 Done:
+    free(elements);
+    free(tones);
+}
+
+// Put the job on air, the transmitter is already keyed
+static void TRANSMIT_Play(const TRANSMIT_Job_t *job)
+{
+    switch (job->type)
+    {
+    case TRANSMIT_JOB_TONE:
+        ESP_LOGI(TAG, "Transmitting <Tone>: %d Hz, %d ms", job->param.tone.freq, job->param.tone.duration_ms);
+        AUDIO_PlayTone(job->param.tone.freq, job->param.tone.duration_ms);
+        break;
+
+    case TRANSMIT_JOB_MORSE_CODE:
+        TRANSMIT_PlayMorseCode(&job->param.morse_code);
+        break;
+
+    case TRANSMIT_JOB_AFSK:
+        ESP_LOGI(TAG, "Transmitting <Afsk>: %s", job->param.afsk.input);
+        AUDIO_PlayAFSK(
+            (const uint8_t *)job->param.afsk.input,
+            job->param.afsk.len,
+            job->param.afsk.baud,
+            job->param.afsk.zero_freq,
+            job->param.afsk.one_freq);
+        break;
+
+    case TRANSMIT_JOB_APRS:
+        ESP_LOGI(TAG, "Transmitting <APRS>: %u line bits", (unsigned int)job->param.aprs_bits);
+        AUDIO_PlayAFSKLine(job->payload, job->param.aprs_bits, TRANSMIT_APRS_BAUD, TRANSMIT_APRS_SPACE_FREQ, TRANSMIT_APRS_MARK_FREQ);
+        break;
+
+    case TRANSMIT_JOB_WAV:
+        ESP_LOGI(TAG, "Transmitting <Wav>: %s", job->param.wav.filepath);
+        AUDIO_PlayWav(job->param.wav.filepath);
+        break;
+
+    case TRANSMIT_JOB_STREAM:
+        ESP_LOGI(TAG, "Transmitting <Stream>");
+        AUDIO_PlayStream(job->param.stream.callback, job->param.stream.arg);
+        break;
+    }
+}
+
+// Task putting the queued jobs on air one by one
+// Transmitter stays keyed while there are more jobs, so back to back jobs go out without PTT delays in between
+void TRANSMIT_Task(void *pvParameters)
+{
+    TRANSMIT_Job_t job;
+    bool transmitting = false;
+
+    transmitTaskHandle = xTaskGetCurrentTaskHandle();
+    queueMutex = xSemaphoreCreateMutex();
+
+    ESP_LOGI(TAG, "Transmit task started.");
+
+    while (1)
+    {
+        if (!TRANSMIT_Next(&job))
+        {
+            if (transmitting)
+            {
+                AUDIO_TransmitStop();
+                PTT_Release();
+                transmitting = false;
+            }
+
+            // Wait for the next job
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        if (!transmitting)
+        {
+            // If we cannot start TX (audio resource likely busy) we drop the job
+            if (AUDIO_TransmitStart() != ESP_OK)
+            {
+                ESP_LOGE(TAG, "Could not start transmitting, %s dropped.", TRANSMIT_JobName(job.type));
+                TRANSMIT_Done(true);
+                TRANSMIT_Release(&job);
+                continue;
+            }
+
+            PTT_Press();
+            transmitting = true;
+        }
 
-    // Delete self
-    vTaskDelete(NULL);
-}
\ No newline at end of file
+        TRANSMIT_Play(&job);
+        TRANSMIT_Done(false);
+        TRANSMIT_Release(&job);
+    }
+}
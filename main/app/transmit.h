@@ -18,11 +18,53 @@
 #define APP_TRANSMIT_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "hardware/audio.h"
+
+// Define max amount of jobs waiting in the transmit queue
+#define TRANSMIT_QUEUE_SIZE 8
+// Define APRS modulation, Bell 202 AFSK
+#define TRANSMIT_APRS_BAUD 1200
+#define TRANSMIT_APRS_MARK_FREQ 1200
+#define TRANSMIT_APRS_SPACE_FREQ 2200
+// Define amount of flags sent before the frame, 45 flags take 300 ms at 1200 baud
+#define TRANSMIT_APRS_PREAMBLE_FLAGS 45
+// Define amount of flags sent after the frame
+#define TRANSMIT_APRS_TAIL_FLAGS 3
+
+// Jobs of higher priority go on air first, same priority jobs in the order they were queued
+typedef enum
+{
+    TRANSMIT_PRIORITY_LOW,    // beacons
+    TRANSMIT_PRIORITY_NORMAL, // user requests
+    TRANSMIT_PRIORITY_HIGH
+} TRANSMIT_Priority_t;
+
+typedef enum
+{
+    TRANSMIT_JOB_TONE,
+    TRANSMIT_JOB_MORSE_CODE,
+    TRANSMIT_JOB_AFSK,
+    TRANSMIT_JOB_APRS,
+    TRANSMIT_JOB_WAV,
+    TRANSMIT_JOB_STREAM
+} TRANSMIT_JobType_t;
+
+typedef struct
+{
+    uint16_t freq;
+    uint16_t duration_ms;
+} TRANSMIT_ToneParam_t;
 
 typedef struct
 {
     const char *input;
     uint8_t len;
+    uint8_t wpm;            // character speed in words per minute
+    uint8_t farnsworth_wpm; // overall speed with Farnsworth spacing, 0 disables
+    uint16_t tone_freq;
 } TRANSMIT_MorseCodeParam_t;
 
 typedef struct
@@ -34,13 +76,56 @@ typedef struct
     uint16_t one_freq;
 } TRANSMIT_AfskParam_t;
 
+typedef struct
+{
+    const char *input; // information field
+    uint8_t len;
+    const char *source;
+    const char *destination;
+    const char *path; // comma separated digipeaters
+} TRANSMIT_AprsParam_t;
+
 typedef struct
 {
     char filepath[64];
 } TRANSMIT_WavParam_t;
 
-void TRANSMIT_MorseCode(void *pvParameters);
-void TRANSMIT_Afsk(void *pvParameters);
-void TRANSMIT_Wav(void *pvParameters);
+// Called once the stream job is done, cancelled or dropped, so the producer can free its state
+// It may run with the queue locked, so it must not call the TRANSMIT functions
+typedef void (*TRANSMIT_StreamDone_t)(void *arg);
+
+typedef struct
+{
+    AUDIO_StreamCallback_t callback; // produces the samples, see AUDIO_PlayStream
+    TRANSMIT_StreamDone_t done;      // optional
+    void *arg;                       // passed to both callbacks, owned by the producer
+} TRANSMIT_StreamParam_t;
+
+// Transmit queue statistics, wait is the time from queueing a job to putting it on air
+typedef struct
+{
+    uint8_t depth;          // jobs waiting
+    uint8_t max_depth;      // most jobs waiting at once
+    bool active;            // job on air
+    TRANSMIT_JobType_t job; // type of the job on air
+    uint32_t jobs;          // jobs put on air
+    uint32_t rejected;      // jobs not queued as the queue was full or dropped as the transmitter could not start
+    uint32_t cancelled;     // jobs dropped or stopped by TRANSMIT_Cancel
+    uint32_t last_wait_ms;
+    uint32_t max_wait_ms;
+    uint64_t total_wait_ms;
+} TRANSMIT_Status_t;
+
+esp_err_t TRANSMIT_Tone(const TRANSMIT_ToneParam_t *param, TRANSMIT_Priority_t priority);
+esp_err_t TRANSMIT_MorseCode(const TRANSMIT_MorseCodeParam_t *param, TRANSMIT_Priority_t priority);
+esp_err_t TRANSMIT_Afsk(const TRANSMIT_AfskParam_t *param, TRANSMIT_Priority_t priority);
+esp_err_t TRANSMIT_Aprs(const TRANSMIT_AprsParam_t *param, TRANSMIT_Priority_t priority);
+esp_err_t TRANSMIT_Wav(const TRANSMIT_WavParam_t *param, TRANSMIT_Priority_t priority);
+esp_err_t TRANSMIT_Stream(const TRANSMIT_StreamParam_t *param, TRANSMIT_Priority_t priority);
+void TRANSMIT_Cancel(void);
+void TRANSMIT_GetStatus(TRANSMIT_Status_t *status);
+void TRANSMIT_ResetStatus(void);
+const char *TRANSMIT_JobName(TRANSMIT_JobType_t type);
+void TRANSMIT_Task(void *pvParameters);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,313 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <esp_log.h>
+
+#include "waveform.h"
+#include "hardware/audio.h"
+#include "helper/misc.h"
+#include "dsp/peaks.h"
+#include "dsp/adpcm.h"
+
+static const char *TAG = "APP/WAVEFORM";
+
+// Recordings waiting for the indexer
+static QueueHandle_t indexQueue;
+
+_Static_assert(sizeof(WAVEFORM_Header_t) == 12, "Peaks sidecar header layout changed");
+
+// Build sidecar filepath of the recording, <name>.<ext>.pk so recordings sharing a name do not share peaks
+// Returns false if it does not fit or the file is a sidecar itself
+bool WAVEFORM_Path(char *sidecar, size_t size, const char *filepath)
+{
+    const size_t len = strlen(filepath);
+    const size_t ext_len = strlen(WAVEFORM_FILE_EXT);
+
+    if (len >= ext_len && strcmp(filepath + len - ext_len, WAVEFORM_FILE_EXT) == 0)
+    {
+        return false;
+    }
+
+    const int written = snprintf(sidecar, size, "%s" WAVEFORM_FILE_EXT, filepath);
+
+    return written > 0 && (size_t)written < size;
+}
+
+// Fill sidecar header for the recording sample rate
+void WAVEFORM_HeaderInit(WAVEFORM_Header_t *header, uint32_t sample_rate)
+{
+    memcpy(header->magic, WAVEFORM_MAGIC, sizeof(header->magic));
+    header->sample_rate = sample_rate;
+    header->per_peak = MAX(sample_rate / WAVEFORM_PEAKS_PER_SECOND, 1);
+    header->reserved = 0;
+}
+
+// Open finished or growing sidecar of the recording
+// Returns file positioned at the first peak and the amount of peaks, NULL if there is no valid sidecar
+FILE *WAVEFORM_Open(const char *filepath, WAVEFORM_Header_t *header, size_t *count)
+{
+    char sidecar[64];
+    struct stat file_stat;
+
+    if (!WAVEFORM_Path(sidecar, sizeof(sidecar), filepath) || stat(sidecar, &file_stat) == -1)
+    {
+        return NULL;
+    }
+
+    FILE *fd = fopen(sidecar, "rb");
+
+    if (fd == NULL)
+    {
+        return NULL;
+    }
+
+    if (fread(header, 1, sizeof(WAVEFORM_Header_t), fd) != sizeof(WAVEFORM_Header_t) ||
+        memcmp(header->magic, WAVEFORM_MAGIC, sizeof(header->magic)) != 0 ||
+        header->sample_rate == 0 || header->per_peak == 0)
+    {
+        fclose(fd);
+        return NULL;
+    }
+
+    *count = (file_stat.st_size - sizeof(WAVEFORM_Header_t)) / 2;
+
+    return fd;
+}
+
+// Queue recording without the sidecar for the indexer
+esp_err_t WAVEFORM_Index(const char *filepath)
+{
+    char item[64];
+
+    if (indexQueue == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (strlcpy(item, filepath, sizeof(item)) >= sizeof(item))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xQueueSend(indexQueue, item, 0) == pdFALSE)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+// Track samples and write the peaks once the buffer fills
+static bool WAVEFORM_Write(PEAKS_t *peaks, FILE *fd, const int16_t *samples, size_t len)
+{
+    size_t tracked = 0;
+
+    while (tracked < len)
+    {
+        tracked += PEAKS_Process(peaks, &samples[tracked], len - tracked);
+
+        if (PEAKS_Full(peaks))
+        {
+            if (fwrite(peaks->data, 1, peaks->len, fd) != peaks->len)
+                return false;
+
+            PEAKS_Clear(peaks);
+        }
+    }
+
+    return true;
+}
+
+// Compute peaks of 16-bit PCM data
+static bool WAVEFORM_ScanPcm(PEAKS_t *peaks, FILE *in, FILE *out, uint8_t *buffer, size_t data_bytes)
+{
+    size_t len;
+
+    while (data_bytes > 0 && (len = fread(buffer, 1, MIN(data_bytes, (size_t)WAVEFORM_INDEX_BUFFER_SIZE), in)) > 0)
+    {
+        if (!WAVEFORM_Write(peaks, out, (const int16_t *)buffer, len / sizeof(int16_t)))
+            return false;
+
+        data_bytes -= len;
+    }
+
+    return true;
+}
+
+// Compute peaks of IMA ADPCM blocks
+static bool WAVEFORM_ScanAdpcm(PEAKS_t *peaks, FILE *in, FILE *out, uint8_t *buffer, size_t block_align, size_t samples_left)
+{
+    // Codes go first, decoded samples (two per code byte and the header one) after them
+    int16_t *samples = (int16_t *)&buffer[WAVEFORM_INDEX_BUFFER_SIZE / 4];
+    ADPCM_State_t state;
+
+    while (samples_left > 0 && fread(buffer, 1, block_align, in) == block_align)
+    {
+        samples[0] = ADPCM_DecodeHeader(&state, buffer);
+
+        const size_t count = MIN(1 + ADPCM_Decode(&state, &buffer[ADPCM_BLOCK_HEADER_SIZE], block_align - ADPCM_BLOCK_HEADER_SIZE, &samples[1]), samples_left);
+
+        if (!WAVEFORM_Write(peaks, out, samples, count))
+            return false;
+
+        samples_left -= count;
+    }
+
+    return true;
+}
+
+// Write the sidecar of the recording, the magic is filled in last so readers skip an unfinished file
+static esp_err_t WAVEFORM_Build(const char *filepath)
+{
+    char sidecar[64];
+    WAVEFORM_Header_t header;
+    WAV_Info_t wav;
+    PEAKS_t peaks;
+    size_t count;
+    FILE *in = NULL;
+    FILE *out = NULL;
+    uint8_t *buffer = NULL;
+    bool written = false;
+    esp_err_t ret = ESP_FAIL;
+
+    if (!WAVEFORM_Path(sidecar, sizeof(sidecar), filepath))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Already indexed, i.e. requested twice
+    out = WAVEFORM_Open(filepath, &header, &count);
+
+    if (out != NULL)
+    {
+        fclose(out);
+        return ESP_OK;
+    }
+
+    in = fopen(filepath, "rb");
+
+    if (in == NULL)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (WAV_Parse(in, &wav) != ESP_OK)
+    {
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto Done;
+    }
+
+    const bool pcm = wav.format == AUDIO_WAV_FORMAT_PCM && wav.bits == 16;
+    const bool adpcm = wav.format == AUDIO_WAV_FORMAT_IMA_ADPCM && wav.channels == 1 &&
+                       wav.block_align > ADPCM_BLOCK_HEADER_SIZE && wav.block_align <= WAVEFORM_INDEX_BUFFER_SIZE / 8;
+
+    if (!pcm && !adpcm)
+    {
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto Done;
+    }
+
+    buffer = malloc(WAVEFORM_INDEX_BUFFER_SIZE);
+    out = fopen(sidecar, "wb");
+
+    if (buffer == NULL || out == NULL)
+    {
+        goto Done;
+    }
+
+    // Interleaved channels are tracked together, a peak still covers the same time
+    WAVEFORM_HeaderInit(&header, wav.sample_rate);
+    PEAKS_Init(&peaks, header.per_peak * wav.channels);
+    memset(header.magic, 0, sizeof(header.magic));
+
+    if (fwrite(&header, 1, sizeof(WAVEFORM_Header_t), out) != sizeof(WAVEFORM_Header_t))
+    {
+        goto Done;
+    }
+
+    if (pcm)
+    {
+        written = WAVEFORM_ScanPcm(&peaks, in, out, buffer, wav.data_len);
+    }
+    else
+    {
+        written = WAVEFORM_ScanAdpcm(&peaks, in, out, buffer, wav.block_align, WAV_Samples(&wav));
+    }
+
+    PEAKS_Finish(&peaks);
+
+    if (!written || fwrite(peaks.data, 1, peaks.len, out) != peaks.len)
+    {
+        goto Done;
+    }
+
+    fseek(out, 0, SEEK_SET);
+
+    if (fwrite(WAVEFORM_MAGIC, 1, sizeof(header.magic), out) == sizeof(header.magic))
+    {
+        ret = ESP_OK;
+    }
+
+Done:
+    if (out != NULL)
+    {
+        fclose(out);
+
+        if (ret != ESP_OK)
+        {
+            unlink(sidecar);
+        }
+    }
+
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+
+    free(buffer);
+
+    return ret;
+}
+
+// Indexer task, writes sidecars of the recordings made before they existed
+void WAVEFORM_Task(void *pvParameters)
+{
+    char filepath[64];
+
+    indexQueue = xQueueCreate(WAVEFORM_QUEUE_SIZE, sizeof(filepath));
+
+    while (1)
+    {
+        if (xQueueReceive(indexQueue, filepath, portMAX_DELAY) == pdTRUE)
+        {
+            ESP_LOGI(TAG, "Indexing %s", filepath);
+
+            const esp_err_t ret = WAVEFORM_Build(filepath);
+
+            if (ret != ESP_OK)
+            {
+                ESP_LOGW(TAG, "Failed to index %s: %s", filepath, esp_err_to_name(ret));
+            }
+        }
+    }
+}
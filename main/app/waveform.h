@@ -0,0 +1,53 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef APP_WAVEFORM_H
+#define APP_WAVEFORM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+// Define extension of the peaks sidecar file, it is appended to the filename of the recording
+// so the name is not longer than the recording one (SPIFFS names are limited to 31 characters)
+#define WAVEFORM_FILE_EXT ".pk"
+// Define how many peaks are stored per second of audio
+#define WAVEFORM_PEAKS_PER_SECOND 20
+// Define amount of files waiting for the indexer
+#define WAVEFORM_QUEUE_SIZE 4
+// Define size of the buffer the indexer decodes the recording in
+#define WAVEFORM_INDEX_BUFFER_SIZE 4096
+
+// Peaks sidecar file header, min, max int8_t pairs follow it
+typedef struct
+{
+    uint8_t magic[4];     // "PEAK", zeros while the indexer is writing the file
+    uint32_t sample_rate; // sample rate of the recording in Hz
+    uint16_t per_peak;    // samples covered by a single peak
+    uint16_t reserved;
+} WAVEFORM_Header_t;
+
+// Define sidecar header magic
+#define WAVEFORM_MAGIC "PEAK"
+
+bool WAVEFORM_Path(char *sidecar, size_t size, const char *filepath);
+void WAVEFORM_HeaderInit(WAVEFORM_Header_t *header, uint32_t sample_rate);
+FILE *WAVEFORM_Open(const char *filepath, WAVEFORM_Header_t *header, size_t *count);
+esp_err_t WAVEFORM_Index(const char *filepath);
+void WAVEFORM_Task(void *pvParameters);
+
+#endif
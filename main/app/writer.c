@@ -0,0 +1,477 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <esp_heap_caps.h>
+#include <esp_cpu.h>
+#include <esp_log.h>
+
+#include "writer.h"
+#include "helper/misc.h"
+#include "helper/telemetry.h"
+
+static const char *TAG = "APP/WRITER";
+
+// Define amount of job queue entries kept for the jobs that wait instead of being dropped,
+// a write per buffer, the close of the open file and the sync of WRITER_Stop
+#define WRITER_RESERVED_JOBS (WRITER_BUFFER_COUNT + 2)
+
+typedef enum
+{
+    WRITER_JOB_OPEN,          // open file and write its header
+    WRITER_JOB_WRITE,         // write buffer and give it back to the free queue
+    WRITER_JOB_CLOSE,         // rewrite the header (if any) and close the file and its sidecar
+    WRITER_JOB_SIDECAR_OPEN,  // create file kept open along the current one and write its header, i.e. peaks
+    WRITER_JOB_SIDECAR_WRITE, // write small data to the sidecar
+    WRITER_JOB_APPEND,        // append small record to other file, i.e. index
+    WRITER_JOB_CALL,          // run callback, i.e. slow filesystem maintenance
+    WRITER_JOB_SYNC           // give the sync semaphore once all the previous jobs are done
+} WRITER_JobType_t;
+
+typedef struct
+{
+    WRITER_JobType_t type;
+    WRITER_Buffer_t *buffer;
+    WRITER_Callback_t callback;
+    void *arg;
+    char filepath[64];
+    uint8_t header[WRITER_HEADER_MAX_SIZE];
+    uint8_t header_len;
+} WRITER_Job_t;
+
+static WRITER_Buffer_t buffers[WRITER_BUFFER_COUNT];
+static size_t bufferSize;
+
+// Buffers ready to be filled by the capture side
+static QueueHandle_t freeQueue;
+// Jobs processed in order by the writer task
+static QueueHandle_t jobQueue;
+// Serializes the jobs that must leave the reserved entries free
+static SemaphoreHandle_t queueMutex;
+static SemaphoreHandle_t syncSemaphore;
+// WRITER_Stop gave up waiting, the writer task frees the buffers once it gets to the sync job
+static atomic_bool orphaned;
+
+// File currently written and its sidecar, only accessed by the writer task
+static FILE *fd;
+static FILE *sidecarFd;
+static char sidecarBuffer[WRITER_SIDECAR_BUFFER_SIZE];
+// First error of the current session, read by the capture side
+static volatile esp_err_t status = ESP_OK;
+
+// Allocate writer buffers, shrinks them if there is not enough memory
+esp_err_t WRITER_Start(void)
+{
+    if (jobQueue == NULL)
+    {
+        ESP_LOGE(TAG, "Writer task is not running");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Buffers are still owned by the previous session
+    if (buffers[0].data != NULL)
+    {
+        ESP_LOGE(TAG, "Writer is already in use");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Drop the sync given after the previous session timed out
+    xSemaphoreTake(syncSemaphore, 0);
+
+    for (bufferSize = WRITER_BUFFER_SIZE; bufferSize >= WRITER_MIN_BUFFER_SIZE; bufferSize /= 2)
+    {
+        size_t allocated = 0;
+
+        for (; allocated < WRITER_BUFFER_COUNT; allocated++)
+        {
+            // DMA capable memory lets the SD driver transfer straight from the buffer
+            buffers[allocated].data = heap_caps_malloc(bufferSize, MALLOC_CAP_DMA);
+
+            if (buffers[allocated].data == NULL)
+                break;
+        }
+
+        if (allocated == WRITER_BUFFER_COUNT)
+            break;
+
+        while (allocated > 0)
+        {
+            free(buffers[--allocated].data);
+            buffers[allocated].data = NULL;
+        }
+    }
+
+    if (bufferSize < WRITER_MIN_BUFFER_SIZE)
+    {
+        ESP_LOGE(TAG, "Writer buffers malloc failed");
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (bufferSize < WRITER_BUFFER_SIZE)
+    {
+        ESP_LOGW(TAG, "Writer buffers shortened to %d bytes due to low memory", (int)bufferSize);
+    }
+
+    status = ESP_OK;
+    xQueueReset(freeQueue);
+
+    for (size_t i = 0; i < WRITER_BUFFER_COUNT; i++)
+    {
+        WRITER_Buffer_t *buffer = &buffers[i];
+
+        buffer->len = 0;
+        xQueueSend(freeQueue, &buffer, 0);
+    }
+
+    return ESP_OK;
+}
+
+static void WRITER_FreeBuffers(void)
+{
+    for (size_t i = 0; i < WRITER_BUFFER_COUNT; i++)
+    {
+        free(buffers[i].data);
+        buffers[i].data = NULL;
+    }
+}
+
+// Wait for all the pending jobs and free the buffers
+void WRITER_Stop(void)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_SYNC};
+
+    xQueueSend(jobQueue, &job, portMAX_DELAY);
+
+    if (xSemaphoreTake(syncSemaphore, WRITER_STOP_TIMEOUT_MS / portTICK_PERIOD_MS) == pdFALSE)
+    {
+        // Buffers might still be in use, leave them to the writer task
+        ESP_LOGE(TAG, "Writer did not finish in time");
+        atomic_store(&orphaned, true);
+
+        // Sync job was done in the meantime, before the writer task could see the flag
+        if (xSemaphoreTake(syncSemaphore, 0) == pdFALSE || !atomic_exchange(&orphaned, false))
+        {
+            return;
+        }
+    }
+
+    WRITER_FreeBuffers();
+}
+
+// Size of the buffers allocated by WRITER_Start
+size_t WRITER_BufferSize(void)
+{
+    return bufferSize;
+}
+
+// First error since WRITER_Start, i.e. failed open or write
+esp_err_t WRITER_Status(void)
+{
+    return status;
+}
+
+// Get empty buffer without waiting
+// Returns NULL if both buffers are still waiting to be written
+WRITER_Buffer_t *WRITER_Acquire(void)
+{
+    WRITER_Buffer_t *buffer = NULL;
+
+    if (xQueueReceive(freeQueue, &buffer, 0) == pdFALSE)
+    {
+        return NULL;
+    }
+
+    buffer->len = 0;
+
+    return buffer;
+}
+
+// Queue job unless it would take the entries reserved for the writes, the close and the sync
+// Never waits for the storage, the job is dropped and counted instead
+static bool WRITER_QueueUnreserved(const WRITER_Job_t *job)
+{
+    bool queued = false;
+
+    xSemaphoreTake(queueMutex, portMAX_DELAY);
+
+    if (uxQueueSpacesAvailable(jobQueue) > WRITER_RESERVED_JOBS)
+    {
+        queued = xQueueSend(jobQueue, job, 0) == pdTRUE;
+    }
+
+    xSemaphoreGive(queueMutex);
+
+    if (!queued)
+    {
+        TELEMETRY_Count(TELEMETRY_COUNTER_WRITER_DROPPED_JOBS, 1);
+    }
+
+    return queued;
+}
+
+// Queue filled buffer to be written to the open file
+void WRITER_Write(WRITER_Buffer_t *buffer)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_WRITE, .buffer = buffer};
+
+    // There is a reserved entry for each buffer, so it never blocks on writes
+    xQueueSend(jobQueue, &job, portMAX_DELAY);
+}
+
+// Queue opening of the file, existing file is overwritten
+// Returns false if the storage is too far behind, the file is not opened then
+bool WRITER_Open(const char *filepath, const void *header, size_t header_len)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_OPEN, .header_len = MIN(header_len, WRITER_HEADER_MAX_SIZE)};
+
+    strlcpy(job.filepath, filepath, sizeof(job.filepath));
+    memcpy(job.header, header, job.header_len);
+
+    return WRITER_QueueUnreserved(&job);
+}
+
+// Queue closing of the file, header is rewritten unless it is NULL
+// Has a reserved entry, as only one file is open at a time
+void WRITER_Close(const void *header, size_t header_len)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_CLOSE, .header_len = header ? MIN(header_len, WRITER_HEADER_MAX_SIZE) : 0};
+
+    if (header != NULL)
+    {
+        memcpy(job.header, header, job.header_len);
+    }
+
+    xQueueSend(jobQueue, &job, portMAX_DELAY);
+}
+
+// Queue creation of the sidecar of the file being written, it stays open until WRITER_Close
+// Sidecar is optional, its failures are logged and do not affect WRITER_Status
+// Returns false if the job was dropped as the storage is too far behind
+bool WRITER_OpenSidecar(const char *filepath, const void *header, size_t header_len)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_SIDECAR_OPEN, .header_len = MIN(header_len, WRITER_HEADER_MAX_SIZE)};
+
+    strlcpy(job.filepath, filepath, sizeof(job.filepath));
+    memcpy(job.header, header, job.header_len);
+
+    return WRITER_QueueUnreserved(&job);
+}
+
+// Queue writing of the data (up to WRITER_HEADER_MAX_SIZE) to the sidecar
+// Returns false if the job was dropped as the storage is too far behind
+bool WRITER_WriteSidecar(const void *data, size_t len)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_SIDECAR_WRITE, .header_len = MIN(len, WRITER_HEADER_MAX_SIZE)};
+
+    memcpy(job.header, data, job.header_len);
+
+    return WRITER_QueueUnreserved(&job);
+}
+
+// Queue appending of the data (up to WRITER_HEADER_MAX_SIZE) to other file than the one being written
+// Failures are logged and do not affect WRITER_Status
+// Returns false if the job was dropped as the storage is too far behind
+bool WRITER_Append(const char *filepath, const void *data, size_t len)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_APPEND, .header_len = MIN(len, WRITER_HEADER_MAX_SIZE)};
+
+    strlcpy(job.filepath, filepath, sizeof(job.filepath));
+    memcpy(job.header, data, job.header_len);
+
+    return WRITER_QueueUnreserved(&job);
+}
+
+// Queue callback to be run by the writer task once the previous jobs are done
+// Returns false if the job was dropped as the storage is too far behind, the caller still owns arg then
+bool WRITER_Call(WRITER_Callback_t callback, void *arg)
+{
+    WRITER_Job_t job = {.type = WRITER_JOB_CALL, .callback = callback, .arg = arg};
+
+    return WRITER_QueueUnreserved(&job);
+}
+
+static void WRITER_Fail(esp_err_t err)
+{
+    if (status == ESP_OK)
+    {
+        status = err;
+    }
+}
+
+static void WRITER_CloseSidecar(void)
+{
+    if (sidecarFd == NULL)
+        return;
+
+    if (fclose(sidecarFd) != 0)
+    {
+        ESP_LOGE(TAG, "Failed to close sidecar");
+    }
+
+    sidecarFd = NULL;
+}
+
+static void WRITER_ProcessJob(WRITER_Job_t *job)
+{
+    switch (job->type)
+    {
+    case WRITER_JOB_OPEN:
+        fd = fopen(job->filepath, "wb");
+
+        if (fd == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to open %s", job->filepath);
+            WRITER_Fail(ESP_ERR_NOT_FOUND);
+            break;
+        }
+
+        // Buffers are already cluster sized, skip stdio buffering
+        setvbuf(fd, NULL, _IONBF, 0);
+
+        if (fwrite(job->header, 1, job->header_len, fd) != job->header_len)
+        {
+            ESP_LOGE(TAG, "Failed to write header of %s", job->filepath);
+            WRITER_Fail(ESP_FAIL);
+        }
+        break;
+
+    case WRITER_JOB_WRITE:
+        if (fd != NULL)
+        {
+            const uint32_t cycles_start = esp_cpu_get_cycle_count();
+
+            if (fwrite(job->buffer->data, 1, job->buffer->len, fd) != job->buffer->len)
+            {
+                ESP_LOGE(TAG, "Write failed, storage might be full");
+                WRITER_Fail(ESP_FAIL);
+            }
+
+            TELEMETRY_Record(TELEMETRY_STAGE_FILE_WRITE, esp_cpu_get_cycle_count() - cycles_start);
+        }
+
+        xQueueSend(freeQueue, &job->buffer, 0);
+        break;
+
+    case WRITER_JOB_CLOSE:
+        WRITER_CloseSidecar();
+
+        if (fd == NULL)
+            break;
+
+        // File with stale sizes in the header looks empty or open-ended to the readers
+        if (job->header_len > 0 &&
+            (fseek(fd, 0, SEEK_SET) != 0 || fwrite(job->header, 1, job->header_len, fd) != job->header_len))
+        {
+            ESP_LOGE(TAG, "Failed to update file header");
+            WRITER_Fail(ESP_FAIL);
+        }
+
+        if (fclose(fd) != 0)
+        {
+            ESP_LOGE(TAG, "Failed to close file");
+            WRITER_Fail(ESP_FAIL);
+        }
+
+        fd = NULL;
+        break;
+
+    case WRITER_JOB_SIDECAR_OPEN:
+        WRITER_CloseSidecar();
+        sidecarFd = fopen(job->filepath, "wb");
+
+        if (sidecarFd == NULL)
+        {
+            ESP_LOGE(TAG, "Failed to open sidecar %s", job->filepath);
+            break;
+        }
+
+        // Small writes are collected, the file is not reopened for each of them
+        setvbuf(sidecarFd, sidecarBuffer, _IOFBF, sizeof(sidecarBuffer));
+
+        if (fwrite(job->header, 1, job->header_len, sidecarFd) != job->header_len)
+        {
+            ESP_LOGE(TAG, "Failed to write sidecar %s", job->filepath);
+            WRITER_CloseSidecar();
+        }
+        break;
+
+    case WRITER_JOB_SIDECAR_WRITE:
+        // Sidecar written so far stays usable, the recording goes on without the rest
+        if (sidecarFd != NULL && fwrite(job->header, 1, job->header_len, sidecarFd) != job->header_len)
+        {
+            ESP_LOGE(TAG, "Failed to write sidecar");
+            WRITER_CloseSidecar();
+        }
+        break;
+
+    case WRITER_JOB_APPEND:
+    {
+        FILE *append_fd = fopen(job->filepath, "ab");
+
+        if (append_fd == NULL || fwrite(job->header, 1, job->header_len, append_fd) != job->header_len)
+        {
+            ESP_LOGE(TAG, "Failed to write %s", job->filepath);
+        }
+
+        if (append_fd != NULL)
+        {
+            fclose(append_fd);
+        }
+        break;
+    }
+
+    case WRITER_JOB_CALL:
+        job->callback(job->arg);
+        break;
+
+    case WRITER_JOB_SYNC:
+        // Nobody waits for the late sync, the session can be started again once the buffers are freed
+        if (atomic_exchange(&orphaned, false))
+        {
+            WRITER_FreeBuffers();
+            ESP_LOGW(TAG, "Writer finished late, buffers freed");
+            break;
+        }
+
+        xSemaphoreGive(syncSemaphore);
+        break;
+    }
+}
+
+// Task writing the buffers filled by the capture side, slow storage only delays this task
+void WRITER_Task(void *pvParameters)
+{
+    WRITER_Job_t job;
+
+    freeQueue = xQueueCreate(WRITER_BUFFER_COUNT, sizeof(WRITER_Buffer_t *));
+    syncSemaphore = xSemaphoreCreateBinary();
+    queueMutex = xSemaphoreCreateMutex();
+    // Reserved entries and the small jobs around them, i.e. peaks appended while a buffer is written
+    jobQueue = xQueueCreate(WRITER_RESERVED_JOBS + WRITER_UNRESERVED_JOBS, sizeof(WRITER_Job_t));
+
+    while (1)
+    {
+        if (xQueueReceive(jobQueue, &job, portMAX_DELAY) == pdTRUE)
+        {
+            WRITER_ProcessJob(&job);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef APP_WRITER_H
+#define APP_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <esp_err.h>
+
+#include "hardware/sd.h"
+
+// Define size of the writer buffer, whole FAT clusters are written at once
+#define WRITER_BUFFER_SIZE SD_ALLOCATION_UNIT_SIZE
+// Define smallest buffer the writer falls back to when there is not enough memory
+#define WRITER_MIN_BUFFER_SIZE (4 * 1024)
+// Define amount of writer buffers, one is filled while the other one is written
+#define WRITER_BUFFER_COUNT 2
+// Define amount of small jobs (open, sidecar, append, call) that can wait for the storage, more are dropped
+#define WRITER_UNRESERVED_JOBS 8
+// Define max size of the file header (and of the data written by WRITER_OpenSidecar, WRITER_WriteSidecar and WRITER_Append)
+#define WRITER_HEADER_MAX_SIZE 64
+// Define stdio buffer of the sidecar kept open along the file, small writes reach the storage in pieces of this size
+#define WRITER_SIDECAR_BUFFER_SIZE 512
+// Define how long WRITER_Stop waits for pending writes in ms
+#define WRITER_STOP_TIMEOUT_MS 10000
+
+// Buffer filled by the capture side and written by the writer task
+typedef struct
+{
+    uint8_t *data; // preallocated data
+    size_t len;    // amount of valid bytes
+} WRITER_Buffer_t;
+
+// Function run by the writer task in between the file jobs
+typedef void (*WRITER_Callback_t)(void *arg);
+
+esp_err_t WRITER_Start(void);
+void WRITER_Stop(void);
+size_t WRITER_BufferSize(void);
+esp_err_t WRITER_Status(void);
+WRITER_Buffer_t *WRITER_Acquire(void);
+void WRITER_Write(WRITER_Buffer_t *buffer);
+bool WRITER_Open(const char *filepath, const void *header, size_t header_len);
+void WRITER_Close(const void *header, size_t header_len);
+bool WRITER_OpenSidecar(const char *filepath, const void *header, size_t header_len);
+bool WRITER_WriteSidecar(const void *data, size_t len);
+bool WRITER_Append(const char *filepath, const void *data, size_t len);
+bool WRITER_Call(WRITER_Callback_t callback, void *arg);
+void WRITER_Task(void *pvParameters);
+
+#endif
@@ -0,0 +1,216 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "adpcm.h"
+
+// IMA ADPCM quantizer step sizes
+static const int16_t stepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+// Step index adjustment for each code magnitude
+static const int8_t indexTable[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+// Update predictor with the code, identical on both sides so they stay in sync
+static int16_t update(ADPCM_State_t *state, uint8_t code)
+{
+    const int32_t step = stepTable[state->index];
+    int32_t diff = step >> 3;
+
+    if (code & 4)
+        diff += step;
+    if (code & 2)
+        diff += step >> 1;
+    if (code & 1)
+        diff += step >> 2;
+
+    int32_t predictor = state->predictor + ((code & 8) ? -diff : diff);
+
+    if (predictor > INT16_MAX)
+        predictor = INT16_MAX;
+    else if (predictor < INT16_MIN)
+        predictor = INT16_MIN;
+
+    int32_t index = state->index + indexTable[code & 7];
+
+    if (index < 0)
+        index = 0;
+    else if (index > 88)
+        index = 88;
+
+    state->predictor = predictor;
+    state->index = index;
+
+    return state->predictor;
+}
+
+// Quantize difference between the sample and the prediction into 4-bit code
+static uint8_t encode(ADPCM_State_t *state, int16_t sample)
+{
+    int32_t diff = sample - state->predictor;
+    int32_t step = stepTable[state->index];
+    uint8_t code = 0;
+
+    if (diff < 0)
+    {
+        code = 8;
+        diff = -diff;
+    }
+
+    if (diff >= step)
+    {
+        code |= 4;
+        diff -= step;
+    }
+    step >>= 1;
+
+    if (diff >= step)
+    {
+        code |= 2;
+        diff -= step;
+    }
+    step >>= 1;
+
+    if (diff >= step)
+    {
+        code |= 1;
+    }
+
+    update(state, code);
+
+    return code;
+}
+
+/// @brief Initialize block encoder
+/// @param encoder pointer to encoder
+void ADPCM_EncoderInit(ADPCM_Encoder_t *encoder)
+{
+    encoder->state.predictor = 0;
+    encoder->state.index = 0;
+    encoder->len = 0;
+}
+
+/// @brief Encode samples into the current block, a new block is started if the previous one is full
+/// @param encoder pointer to encoder
+/// @param samples input samples
+/// @param len amount of input samples
+/// @return amount of samples consumed, stops at the end of the block
+size_t ADPCM_Encode(ADPCM_Encoder_t *encoder, const int16_t *samples, size_t len)
+{
+    size_t consumed = 0;
+
+    if (ADPCM_EncoderFull(encoder))
+    {
+        encoder->len = 0;
+    }
+
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    // Block header carries the first sample as is, the decoder resyncs on it
+    if (encoder->len == 0)
+    {
+        encoder->state.predictor = samples[0];
+        encoder->block[0] = (uint16_t)samples[0] & 0xFF;
+        encoder->block[1] = (uint16_t)samples[0] >> 8;
+        encoder->block[2] = encoder->state.index;
+        encoder->block[3] = 0;
+        encoder->len = 1;
+        consumed = 1;
+    }
+
+    for (; consumed < len && encoder->len < ADPCM_SAMPLES_PER_BLOCK; consumed++, encoder->len++)
+    {
+        const uint8_t code = encode(&encoder->state, samples[consumed]);
+        // Codes follow the header, first one goes into the low nibble
+        const size_t nibble = encoder->len - 1;
+        uint8_t *byte = &encoder->block[ADPCM_BLOCK_HEADER_SIZE + nibble / 2];
+
+        *byte = (nibble & 1) ? (*byte | (code << 4)) : code;
+    }
+
+    return consumed;
+}
+
+/// @brief Check whether the block is complete
+/// @param encoder pointer to encoder
+/// @return true if the block is ready to be written
+bool ADPCM_EncoderFull(const ADPCM_Encoder_t *encoder)
+{
+    return encoder->len == ADPCM_SAMPLES_PER_BLOCK;
+}
+
+/// @brief Complete partially filled block with silence codes, used at the end of the stream
+/// @param encoder pointer to encoder
+/// @return amount of real samples in the block
+size_t ADPCM_EncoderPad(ADPCM_Encoder_t *encoder)
+{
+    const size_t len = encoder->len;
+
+    if (len == 0 || len == ADPCM_SAMPLES_PER_BLOCK)
+    {
+        return len;
+    }
+
+    // High nibble of the last byte is already clear when the amount of codes is odd
+    const size_t used = ADPCM_BLOCK_HEADER_SIZE + len / 2;
+
+    memset(&encoder->block[used], 0, ADPCM_BLOCK_SIZE - used);
+
+    encoder->len = ADPCM_SAMPLES_PER_BLOCK;
+
+    return len;
+}
+
+/// @brief Start decoding of the block
+/// @param state decoder state
+/// @param header first ADPCM_BLOCK_HEADER_SIZE bytes of the block
+/// @return first sample of the block
+int16_t ADPCM_DecodeHeader(ADPCM_State_t *state, const uint8_t *header)
+{
+    state->predictor = (int16_t)(header[0] | (header[1] << 8));
+    state->index = (header[2] > 88) ? 88 : header[2];
+
+    return state->predictor;
+}
+
+/// @brief Decode codes following the block header
+/// @param state decoder state
+/// @param data encoded bytes, two samples each
+/// @param len amount of encoded bytes
+/// @param samples output, room for len * 2 samples
+/// @return amount of decoded samples
+size_t ADPCM_Decode(ADPCM_State_t *state, const uint8_t *data, size_t len, int16_t *samples)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        samples[2 * i] = update(state, data[i] & 0x0F);
+        samples[2 * i + 1] = update(state, data[i] >> 4);
+    }
+
+    return len * 2;
+}
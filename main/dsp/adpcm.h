@@ -0,0 +1,53 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_ADPCM_H
+#define DSP_ADPCM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Define size of the IMA ADPCM block in bytes (mono, 4 byte header followed by 4-bit codes)
+#define ADPCM_BLOCK_SIZE 256
+// Define size of the block header
+#define ADPCM_BLOCK_HEADER_SIZE 4
+// Define amount of samples in the block, first one is stored in the block header
+#define ADPCM_SAMPLES_PER_BLOCK ((ADPCM_BLOCK_SIZE - ADPCM_BLOCK_HEADER_SIZE) * 2 + 1)
+
+// Predictor state shared by the encoder and the decoder
+typedef struct
+{
+    int16_t predictor; // last reconstructed sample
+    uint8_t index;     // index into the step table
+} ADPCM_State_t;
+
+// Block encoder, the block is complete once it holds ADPCM_SAMPLES_PER_BLOCK samples
+typedef struct
+{
+    ADPCM_State_t state;
+    uint8_t block[ADPCM_BLOCK_SIZE]; // encoded block
+    size_t len;                      // amount of samples in the block
+} ADPCM_Encoder_t;
+
+void ADPCM_EncoderInit(ADPCM_Encoder_t *encoder);
+size_t ADPCM_Encode(ADPCM_Encoder_t *encoder, const int16_t *samples, size_t len);
+bool ADPCM_EncoderFull(const ADPCM_Encoder_t *encoder);
+size_t ADPCM_EncoderPad(ADPCM_Encoder_t *encoder);
+int16_t ADPCM_DecodeHeader(ADPCM_State_t *state, const uint8_t *header);
+size_t ADPCM_Decode(ADPCM_State_t *state, const uint8_t *data, size_t len, int16_t *samples);
+
+#endif
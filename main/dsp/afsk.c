@@ -0,0 +1,60 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "afsk.h"
+
+/// @brief Initialize modulator
+/// @param afsk pointer to modulator
+/// @param sample_rate output sample rate in Hz
+/// @param baud bits per second
+/// @param one_freq frequency of the "1" tone in Hz
+/// @param zero_freq frequency of the "0" tone in Hz
+/// @param amplitude peak sample value
+void AFSK_Init(AFSK_t *afsk, uint32_t sample_rate, uint16_t baud, uint16_t one_freq, uint16_t zero_freq, int16_t amplitude)
+{
+    NCO_Init(&afsk->nco);
+    afsk->one_step = NCO_Step(one_freq, sample_rate);
+    afsk->zero_step = NCO_Step(zero_freq, sample_rate);
+    afsk->sample_rate = sample_rate;
+    afsk->baud = baud;
+    afsk->remainder = 0;
+    afsk->amplitude = amplitude;
+}
+
+/// @brief Largest amount of samples a single bit takes
+/// @param afsk pointer to modulator
+/// @return samples
+size_t AFSK_MaxBitSamples(const AFSK_t *afsk)
+{
+    return (afsk->sample_rate + afsk->baud - 1) / afsk->baud;
+}
+
+/// @brief Render a single bit, bits take sample_rate / baud samples on average so the timing never drifts
+/// @param afsk pointer to modulator
+/// @param bit bit value
+/// @param output rendered samples, room for AFSK_MaxBitSamples is needed
+/// @return amount of samples rendered
+size_t AFSK_RenderBit(AFSK_t *afsk, bool bit, int16_t *output)
+{
+    const uint32_t total = afsk->remainder + afsk->sample_rate;
+    const size_t len = total / afsk->baud;
+
+    afsk->remainder = total - len * afsk->baud;
+    afsk->nco.step = bit ? afsk->one_step : afsk->zero_step;
+    NCO_Render(&afsk->nco, output, len, afsk->amplitude);
+
+    return len;
+}
@@ -0,0 +1,42 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_AFSK_H
+#define DSP_AFSK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "nco.h"
+
+// Phase continuous AFSK modulator, tone switches keep the phase of the oscillator
+typedef struct
+{
+    NCO_t nco;            // tone oscillator
+    uint32_t one_step;    // phase increment of the "1" tone
+    uint32_t zero_step;   // phase increment of the "0" tone
+    uint32_t sample_rate; // output sample rate in Hz
+    uint16_t baud;        // bits per second
+    uint32_t remainder;   // fraction of a sample carried over to the next bit, in 1/baud units
+    int16_t amplitude;    // peak sample value
+} AFSK_t;
+
+void AFSK_Init(AFSK_t *afsk, uint32_t sample_rate, uint16_t baud, uint16_t one_freq, uint16_t zero_freq, int16_t amplitude);
+size_t AFSK_MaxBitSamples(const AFSK_t *afsk);
+size_t AFSK_RenderBit(AFSK_t *afsk, bool bit, int16_t *output);
+
+#endif
@@ -87,4 +87,13 @@ int16_t AGC_Update(AGC_t *agc, int16_t value)
         // Otherwise return amplified value
         return value *= agc->current_gain;
     }
-}
\ No newline at end of file
+}
+
+// AGC block of samples in place
+void AGC_Process(AGC_t *agc, int16_t *samples, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        samples[i] = AGC_Update(agc, samples[i]);
+    }
+}
@@ -18,6 +18,7 @@
 #define DSP_AGC_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 #define DSP_AGC_MIN_GAIN 1
 #define DSP_AGC_MAX_GAIN 255
@@ -39,5 +40,6 @@ typedef struct
 
 void AGC_Init(AGC_t *agc, uint8_t initial_gain);
 int16_t AGC_Update(AGC_t *agc, int16_t value);
+void AGC_Process(AGC_t *agc, int16_t *samples, size_t len);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,246 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "ax25.h"
+
+/// @brief Encode address like "N0CALL-7", characters are shifted left and the lowest bit marks the last address
+/// @param output room for AX25_ADDRESS_SIZE bytes
+/// @param text callsign with optional SSID, lowercase is converted to uppercase
+/// @param len length of text
+/// @param command sets the C bit (command for destination, repeated for digipeaters)
+/// @param last address ends the address field
+/// @return false if the address is invalid
+bool AX25_EncodeAddress(uint8_t *output, const char *text, size_t len, bool command, bool last)
+{
+    const char *dash = memchr(text, '-', len);
+    const size_t callsign_len = dash ? (size_t)(dash - text) : len;
+    uint8_t ssid = 0;
+
+    if (callsign_len == 0 || callsign_len > AX25_CALLSIGN_MAX_LEN)
+        return false;
+
+    for (size_t i = 0; i < AX25_CALLSIGN_MAX_LEN; i++)
+    {
+        char c = ' ';
+
+        if (i < callsign_len)
+        {
+            if (!isalnum((unsigned char)text[i]))
+                return false;
+
+            c = toupper((unsigned char)text[i]);
+        }
+
+        output[i] = c << 1;
+    }
+
+    if (dash)
+    {
+        const char *digits = dash + 1;
+        const size_t digits_len = len - callsign_len - 1;
+
+        if (digits_len == 0 || digits_len > 2)
+            return false;
+
+        for (size_t i = 0; i < digits_len; i++)
+        {
+            if (!isdigit((unsigned char)digits[i]))
+                return false;
+
+            ssid = ssid * 10 + (digits[i] - '0');
+        }
+
+        if (ssid > 15)
+            return false;
+    }
+
+    // Reserved bits are set to 1
+    output[AX25_CALLSIGN_MAX_LEN] = (command ? 0x80 : 0) | 0x60 | (ssid << 1) | (last ? 1 : 0);
+
+    return true;
+}
+
+/// @brief Build unnumbered information frame, as used by APRS, without FCS
+/// @param frame output buffer
+/// @param size size of frame, AX25_MAX_FRAME_SIZE always fits
+/// @param source source callsign, e.g. "N0CALL-7"
+/// @param destination destination callsign, e.g. "APRS"
+/// @param path comma separated digipeaters, e.g. "WIDE1-1,WIDE2-1", may be empty
+/// @param info information field
+/// @param info_len length of info
+/// @return length of the frame, 0 if the input is invalid or it does not fit
+size_t AX25_BuildUI(uint8_t *frame, size_t size, const char *source, const char *destination, const char *path, const uint8_t *info, size_t info_len)
+{
+    const char *digipeaters[AX25_MAX_DIGIPEATERS];
+    size_t digipeater_lens[AX25_MAX_DIGIPEATERS];
+    size_t digipeater_count = 0;
+    size_t len = 0;
+
+    // Split the path first so we know which address is the last one
+    while (*path != '\0')
+    {
+        const char *comma = strchr(path, ',');
+        const size_t item_len = comma ? (size_t)(comma - path) : strlen(path);
+
+        if (digipeater_count == AX25_MAX_DIGIPEATERS)
+            return 0;
+
+        digipeaters[digipeater_count] = path;
+        digipeater_lens[digipeater_count] = item_len;
+        digipeater_count++;
+
+        path += item_len + (comma ? 1 : 0);
+    }
+
+    if (info_len > AX25_MAX_INFO_SIZE || (2 + digipeater_count) * AX25_ADDRESS_SIZE + 2 + info_len > size)
+        return 0;
+
+    if (!AX25_EncodeAddress(&frame[len], destination, strlen(destination), true, false))
+        return 0;
+    len += AX25_ADDRESS_SIZE;
+
+    if (!AX25_EncodeAddress(&frame[len], source, strlen(source), false, digipeater_count == 0))
+        return 0;
+    len += AX25_ADDRESS_SIZE;
+
+    for (size_t i = 0; i < digipeater_count; i++)
+    {
+        if (!AX25_EncodeAddress(&frame[len], digipeaters[i], digipeater_lens[i], false, i == digipeater_count - 1))
+            return 0;
+        len += AX25_ADDRESS_SIZE;
+    }
+
+    frame[len++] = AX25_CONTROL_UI;
+    frame[len++] = AX25_PID_NO_LAYER3;
+
+    memcpy(&frame[len], info, info_len);
+
+    return len + info_len;
+}
+
+/// @brief Decode address into text like "N0CALL-7"
+/// @param address encoded address
+/// @param output room for 10 characters and terminator
+/// @return length of the text, 0 if the address is invalid
+size_t AX25_FormatAddress(const uint8_t *address, char *output)
+{
+    const uint8_t ssid = (address[AX25_CALLSIGN_MAX_LEN] >> 1) & 0x0f;
+    size_t len = 0;
+
+    for (size_t i = 0; i < AX25_CALLSIGN_MAX_LEN; i++)
+    {
+        const char c = address[i] >> 1;
+
+        // Callsign is padded by spaces
+        if (c == ' ')
+            break;
+
+        if (!isupper((unsigned char)c) && !isdigit((unsigned char)c))
+            return 0;
+
+        output[len++] = c;
+    }
+
+    if (len == 0)
+        return 0;
+
+    if (ssid > 0)
+    {
+        len += sprintf(&output[len], "-%d", ssid);
+    }
+
+    output[len] = '\0';
+
+    return len;
+}
+
+/// @brief Format UI frame in the TNC2 monitor format, e.g. "N0CALL-7>APRS,WIDE1-1*:info"
+/// @param frame frame without FCS
+/// @param len length of frame
+/// @param output text output
+/// @param size size of output, AX25_MAX_TEXT_SIZE always fits
+/// @return length of the text, 0 if it is not a valid UI frame
+size_t AX25_Format(const uint8_t *frame, size_t len, char *output, size_t size)
+{
+    char destination[11];
+    size_t addresses = 0;
+    size_t pos = 0;
+
+    // Last address has the lowest bit set
+    while (addresses < 2 + AX25_MAX_DIGIPEATERS && (addresses + 1) * AX25_ADDRESS_SIZE <= len)
+    {
+        const bool last = frame[(addresses + 1) * AX25_ADDRESS_SIZE - 1] & 1;
+
+        addresses++;
+
+        if (last)
+            break;
+    }
+
+    if (addresses < 2 || !(frame[addresses * AX25_ADDRESS_SIZE - 1] & 1))
+        return 0;
+
+    const size_t header = addresses * AX25_ADDRESS_SIZE + 2;
+
+    if (len < header || frame[header - 2] != AX25_CONTROL_UI || size < AX25_MAX_TEXT_SIZE)
+        return 0;
+
+    if (AX25_FormatAddress(frame, destination) == 0)
+        return 0;
+
+    // Source
+    if ((pos = AX25_FormatAddress(&frame[AX25_ADDRESS_SIZE], output)) == 0)
+        return 0;
+
+    pos += sprintf(&output[pos], ">%s", destination);
+
+    for (size_t i = 2; i < addresses; i++)
+    {
+        const uint8_t *address = &frame[i * AX25_ADDRESS_SIZE];
+
+        output[pos++] = ',';
+
+        const size_t address_len = AX25_FormatAddress(address, &output[pos]);
+
+        if (address_len == 0)
+            return 0;
+
+        pos += address_len;
+
+        // Has been repeated
+        if (address[AX25_CALLSIGN_MAX_LEN] & 0x80)
+        {
+            output[pos++] = '*';
+        }
+    }
+
+    output[pos++] = ':';
+
+    // Keep the text printable
+    for (size_t i = header; i < len && i - header < AX25_MAX_INFO_SIZE; i++)
+    {
+        output[pos++] = (frame[i] >= 0x20 && frame[i] < 0x7f) ? frame[i] : '.';
+    }
+
+    output[pos] = '\0';
+
+    return pos;
+}
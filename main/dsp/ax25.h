@@ -0,0 +1,47 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef DSP_AX25_H
+#define DSP_AX25_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Define size of an encoded address (6 callsign characters and SSID)
+#define AX25_ADDRESS_SIZE 7
+// Define max callsign length
+#define AX25_CALLSIGN_MAX_LEN 6
+// Define max amount of digipeaters in the path
+#define AX25_MAX_DIGIPEATERS 8
+// Define max size of the information field
+#define AX25_MAX_INFO_SIZE 256
+// Define control field of an unnumbered information frame
+#define AX25_CONTROL_UI 0x03
+// Define protocol identifier for no layer 3, used by APRS
+#define AX25_PID_NO_LAYER3 0xf0
+// Define max length of a frame in text form, addresses take up to 10 characters and a separator each
+#define AX25_MAX_TEXT_SIZE ((2 + AX25_MAX_DIGIPEATERS) * 11 + 1 + AX25_MAX_INFO_SIZE + 1)
+// Define max size of a UI frame without FCS
+#define AX25_MAX_FRAME_SIZE ((2 + AX25_MAX_DIGIPEATERS) * AX25_ADDRESS_SIZE + 2 + AX25_MAX_INFO_SIZE)
+
+bool AX25_EncodeAddress(uint8_t *output, const char *text, size_t len, bool command, bool last);
+size_t AX25_FormatAddress(const uint8_t *address, char *output);
+size_t AX25_Format(const uint8_t *frame, size_t len, char *output, size_t size);
+size_t AX25_BuildUI(uint8_t *frame, size_t size, const char *source, const char *destination, const char *path, const uint8_t *info, size_t info_len);
+
+#endif
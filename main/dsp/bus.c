@@ -0,0 +1,189 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stddef.h>
+
+#include "bus.h"
+
+// Blocks readable by consumers, the remaining one is owned by the producer
+#define BUS_READABLE_BLOCKS (BUS_BLOCK_COUNT - 1)
+
+/// @brief Initialize the bus
+/// @param bus pointer to bus
+/// @param notify callback used to wake up consumers, can be NULL
+void BUS_Init(BUS_t *bus, void (*notify)(void *waiter))
+{
+    atomic_init(&bus->head, 0);
+    atomic_init(&bus->notifying, 0);
+    bus->notify = notify;
+
+    for (size_t i = 0; i < BUS_MAX_CONSUMERS; i++)
+    {
+        atomic_init(&bus->consumers[i].in_use, false);
+        atomic_init(&bus->consumers[i].tail, 0);
+        atomic_init(&bus->consumers[i].overruns, 0);
+        bus->consumers[i].name = NULL;
+        atomic_init(&bus->consumers[i].waiter, NULL);
+    }
+}
+
+/// @brief Get block the producer writes into, it becomes visible after BUS_Publish
+/// @param bus pointer to bus
+/// @return block to be filled by the producer
+BUS_Block_t *BUS_WriteBlock(BUS_t *bus)
+{
+    uint32_t head = atomic_load_explicit(&bus->head, memory_order_relaxed);
+
+    return &bus->blocks[head & (BUS_BLOCK_COUNT - 1)];
+}
+
+/// @brief Make the written block visible to consumers and wake them up
+/// @param bus pointer to bus
+void BUS_Publish(BUS_t *bus)
+{
+    atomic_fetch_add_explicit(&bus->head, 1, memory_order_release);
+
+    if (bus->notify == NULL)
+        return;
+
+    // Unsubscribed consumer either sees this or its cleared waiter is seen here, see BUS_Notifying
+    atomic_fetch_add(&bus->notifying, 1);
+
+    for (size_t i = 0; i < BUS_MAX_CONSUMERS; i++)
+    {
+        void *waiter = atomic_load(&bus->consumers[i].waiter);
+
+        if (atomic_load_explicit(&bus->consumers[i].in_use, memory_order_acquire) && waiter != NULL)
+        {
+            bus->notify(waiter);
+        }
+    }
+
+    atomic_fetch_sub(&bus->notifying, 1);
+}
+
+/// @brief Claim consumer slot, consumer starts reading from the next published block
+/// @param bus pointer to bus
+/// @param name consumer name
+/// @param waiter passed to notify callback, i.e. task handle
+/// @return consumer or NULL if all the slots are taken
+BUS_Consumer_t *BUS_Subscribe(BUS_t *bus, const char *name, void *waiter)
+{
+    for (size_t i = 0; i < BUS_MAX_CONSUMERS; i++)
+    {
+        BUS_Consumer_t *consumer = &bus->consumers[i];
+        bool expected = false;
+
+        if (atomic_compare_exchange_strong(&consumer->in_use, &expected, true))
+        {
+            consumer->name = name;
+            atomic_store(&consumer->waiter, waiter);
+            atomic_store(&consumer->overruns, 0);
+            atomic_store(&consumer->high_water, 0);
+            atomic_store(&consumer->tail, atomic_load_explicit(&bus->head, memory_order_acquire));
+            return consumer;
+        }
+    }
+
+    return NULL;
+}
+
+/// @brief Release consumer slot
+// The producer might still be notifying the old waiter, wait for BUS_Notifying before the waiter goes away
+/// @param bus pointer to bus
+/// @param consumer consumer returned by BUS_Subscribe
+void BUS_Unsubscribe(BUS_t *bus, BUS_Consumer_t *consumer)
+{
+    if (consumer == NULL)
+        return;
+
+    atomic_store(&consumer->waiter, NULL);
+    atomic_store_explicit(&consumer->in_use, false, memory_order_release);
+}
+
+/// @brief Get next block for the consumer without copying it
+// If the consumer fell behind, lost blocks are skipped and counted as overruns
+/// @param bus pointer to bus
+/// @param consumer consumer returned by BUS_Subscribe
+/// @return pointer to the block or NULL if there is no new block
+const BUS_Block_t *BUS_Peek(BUS_t *bus, BUS_Consumer_t *consumer)
+{
+    uint32_t head = atomic_load_explicit(&bus->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&consumer->tail, memory_order_relaxed);
+
+    if (head == tail)
+    {
+        return NULL;
+    }
+
+    // Only the consumer updates it, relaxed access is enough
+    if (head - tail > atomic_load_explicit(&consumer->high_water, memory_order_relaxed))
+    {
+        atomic_store_explicit(&consumer->high_water, head - tail, memory_order_relaxed);
+    }
+
+    if (head - tail > BUS_READABLE_BLOCKS)
+    {
+        atomic_fetch_add_explicit(&consumer->overruns, head - tail - BUS_READABLE_BLOCKS, memory_order_relaxed);
+        tail = head - BUS_READABLE_BLOCKS;
+        atomic_store_explicit(&consumer->tail, tail, memory_order_relaxed);
+    }
+
+    return &bus->blocks[tail & (BUS_BLOCK_COUNT - 1)];
+}
+
+/// @brief Mark block returned by BUS_Peek as consumed
+/// @param bus pointer to bus
+/// @param consumer consumer returned by BUS_Subscribe
+/// @return false if the producer overwrote the block while it was being read
+bool BUS_Release(BUS_t *bus, BUS_Consumer_t *consumer)
+{
+    // Make sure block reads complete before checking whether producer lapped us
+    atomic_thread_fence(memory_order_acquire);
+
+    uint32_t head = atomic_load_explicit(&bus->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&consumer->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&consumer->tail, tail + 1, memory_order_relaxed);
+
+    if (head - tail > BUS_READABLE_BLOCKS)
+    {
+        atomic_fetch_add_explicit(&consumer->overruns, 1, memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+/// @brief Get amount of blocks waiting to be read by the consumer
+/// @param bus pointer to bus
+/// @param consumer consumer returned by BUS_Subscribe
+/// @return amount of pending blocks
+uint32_t BUS_Pending(BUS_t *bus, BUS_Consumer_t *consumer)
+{
+    uint32_t head = atomic_load_explicit(&bus->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&consumer->tail, memory_order_relaxed);
+
+    return head - tail;
+}
+
+/// @brief Check whether the producer is waking up consumers, the waiters it loaded are still in use until it is done
+/// @param bus pointer to bus
+/// @return true while BUS_Publish is notifying
+bool BUS_Notifying(BUS_t *bus)
+{
+    return atomic_load(&bus->notifying) > 0;
+}
@@ -0,0 +1,70 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_BUS_H
+#define DSP_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Define max amount of samples in a single block
+#define BUS_BLOCK_SIZE 512
+// Define amount of blocks kept in the ring (must be power of 2)
+#define BUS_BLOCK_COUNT 16
+// Define max amount of consumers reading the bus at the same time
+#define BUS_MAX_CONSUMERS 6
+
+// Single block of samples
+typedef struct
+{
+    uint16_t len;                    // amount of valid samples
+    int16_t samples[BUS_BLOCK_SIZE]; // samples
+} BUS_Block_t;
+
+// Consumer of the bus, each one has its own read cursor
+typedef struct
+{
+    atomic_bool in_use;     // set when the slot is claimed by a consumer
+    const char *name;       // consumer name used for diagnostics
+    void *_Atomic waiter;   // passed to the notify callback when new block is published
+    atomic_uint tail;       // sequence of the next block to be read
+    atomic_uint overruns;   // blocks lost because the consumer fell behind
+    atomic_uint high_water; // most blocks that were waiting to be read at once
+} BUS_Consumer_t;
+
+// Single producer multiple consumer ring of sample blocks
+// Producer never waits for consumers, slow consumers lose the oldest blocks
+typedef struct
+{
+    BUS_Block_t blocks[BUS_BLOCK_COUNT];
+    atomic_uint head; // sequence of the block being written
+    atomic_uint notifying; // nonzero while the producer is waking up consumers
+    BUS_Consumer_t consumers[BUS_MAX_CONSUMERS];
+    void (*notify)(void *waiter); // called for each consumer after block is published
+} BUS_t;
+
+void BUS_Init(BUS_t *bus, void (*notify)(void *waiter));
+BUS_Block_t *BUS_WriteBlock(BUS_t *bus);
+void BUS_Publish(BUS_t *bus);
+BUS_Consumer_t *BUS_Subscribe(BUS_t *bus, const char *name, void *waiter);
+void BUS_Unsubscribe(BUS_t *bus, BUS_Consumer_t *consumer);
+const BUS_Block_t *BUS_Peek(BUS_t *bus, BUS_Consumer_t *consumer);
+bool BUS_Release(BUS_t *bus, BUS_Consumer_t *consumer);
+uint32_t BUS_Pending(BUS_t *bus, BUS_Consumer_t *consumer);
+bool BUS_Notifying(BUS_t *bus);
+
+#endif
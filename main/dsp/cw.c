@@ -0,0 +1,301 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "cw.h"
+#include "helper/misc.h"
+
+// Define smoothing of the bin levels used for the tone search, per block
+#define CW_LEVEL_ALPHA 0.02f
+// Define how much stronger another bin has to be to move the decoder to it
+#define CW_BIN_SWITCH_RATIO 2.0f
+// Define smoothing of the signal and noise trackers, per block
+#define CW_TRACK_ATTACK 0.5f
+#define CW_TRACK_AVERAGE 0.05f
+#define CW_TRACK_DECAY 0.002f
+// Define key down and key up thresholds as a fraction of the way from noise to signal
+#define CW_KEY_DOWN_THRESHOLD 0.6f
+#define CW_KEY_UP_THRESHOLD 0.4f
+// Define smoothing of the dot estimate, per element
+#define CW_DOT_ALPHA 0.25f
+
+// Dot length in blocks at the speed
+static float CW_DotBlocks(float wpm)
+{
+    return 60000.0f / (MORSE_PARIS_DOTS * wpm * CW_BLOCK_MS);
+}
+
+/// @brief Initialize decoder
+/// @param cw pointer to decoder
+/// @param sample_rate input sample rate in Hz
+/// @param callback called with each decoded character
+/// @param arg passed to the callback
+/// @return false if the search range does not fit the sample rate
+bool CW_Init(CW_t *cw, uint32_t sample_rate, CW_Callback_t callback, void *arg)
+{
+    if (CW_MIN_FREQ + CW_FREQ_STEP * CW_BIN_COUNT >= sample_rate / 2)
+        return false;
+
+    memset(cw, 0, sizeof(CW_t));
+
+    cw->block_size = sample_rate * CW_BLOCK_MS / 1000;
+
+    for (uint8_t k = 0; k < CW_BIN_COUNT; k++)
+    {
+        cw->coeffs[k] = 2.0f * cosf(2.0f * CONST_PI * (CW_MIN_FREQ + k * CW_FREQ_STEP) / sample_rate);
+    }
+
+    cw->dot = CW_DotBlocks(CW_INITIAL_WPM);
+    cw->callback = callback;
+    cw->arg = arg;
+
+    return true;
+}
+
+// Median of the bin levels, the noise floor even with the tone leaking into the neighbouring bins
+static float CW_Median(const float *levels)
+{
+    float sorted[CW_BIN_COUNT];
+
+    for (uint8_t i = 0; i < CW_BIN_COUNT; i++)
+    {
+        uint8_t j = i;
+
+        for (; j > 0 && sorted[j - 1] > levels[i]; j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+
+        sorted[j] = levels[i];
+    }
+
+    return (sorted[CW_BIN_COUNT / 2 - 1] + sorted[CW_BIN_COUNT / 2]) / 2;
+}
+
+// Report the character received so far, its marks are classified with the dot length adapted to all of them
+static void CW_Character(CW_t *cw)
+{
+    char code[MORSE_MAX_CODE_LEN + 1];
+    char c = '\0';
+
+    if (cw->mark_count == 0)
+        return;
+
+    if (cw->mark_count <= MORSE_MAX_CODE_LEN)
+    {
+        for (uint8_t i = 0; i < cw->mark_count; i++)
+        {
+            code[i] = (cw->marks[i] >= cw->dot * 2) ? '-' : '.';
+        }
+
+        code[cw->mark_count] = '\0';
+        c = MORSE_Decode(code);
+    }
+
+    cw->callback(c ? c : '*', cw->arg);
+    cw->mark_count = 0;
+    cw->spaced = false;
+    cw->received = true;
+}
+
+// Adapt the dot length to key down of the length and keep it for the character
+static void CW_Mark(CW_t *cw, uint32_t duration)
+{
+    // Too short for a dot at this speed, most likely noise
+    if (duration < cw->dot / 3)
+        return;
+
+    // Way too long for a dash, i.e. a carrier, nothing to decode
+    if (duration > cw->dot * 10 && duration > CW_DotBlocks(CW_MIN_WPM) * 5)
+    {
+        cw->mark_count = 0;
+        return;
+    }
+
+    if (duration >= cw->dot * 2)
+    {
+        // Much longer dashes mean the sender is slower than we thought, jump straight to the new speed
+        cw->dot = (duration > cw->dot * 6) ? duration / 3.0f : cw->dot + (duration / 3.0f - cw->dot) * CW_DOT_ALPHA;
+    }
+    else
+    {
+        // Same for much shorter dots and a faster sender
+        cw->dot = (duration < cw->dot * 0.6f) ? duration : cw->dot + (duration - cw->dot) * CW_DOT_ALPHA;
+    }
+
+    cw->dot = MIN(MAX(cw->dot, CW_DotBlocks(CW_MAX_WPM)), CW_DotBlocks(CW_MIN_WPM));
+
+    if (cw->mark_count < MORSE_MAX_CODE_LEN)
+    {
+        cw->marks[cw->mark_count] = duration;
+    }
+
+    // Counting past the max makes the character unknown
+    if (cw->mark_count <= MORSE_MAX_CODE_LEN)
+    {
+        cw->mark_count++;
+    }
+}
+
+// Gap between elements is 1 dot, between characters 3 dots and between words 7 dots, split them half way
+static void CW_Space(CW_t *cw, uint32_t duration)
+{
+    if (duration >= cw->dot * 2)
+    {
+        CW_Character(cw);
+    }
+
+    if (duration >= cw->dot * 5 && cw->received && !cw->spaced)
+    {
+        cw->callback(' ', cw->arg);
+        cw->spaced = true;
+    }
+}
+
+// Process power of the bins at the end of a block
+static void CW_Block(CW_t *cw)
+{
+    float powers[CW_BIN_COUNT];
+    uint8_t best = cw->bin;
+
+    for (uint8_t k = 0; k < CW_BIN_COUNT; k++)
+    {
+        powers[k] = cw->s1[k] * cw->s1[k] + cw->s2[k] * cw->s2[k] - cw->coeffs[k] * cw->s1[k] * cw->s2[k];
+        cw->levels[k] += (powers[k] - cw->levels[k]) * CW_LEVEL_ALPHA;
+        cw->s1[k] = 0;
+        cw->s2[k] = 0;
+
+        if (cw->levels[k] > cw->levels[best])
+        {
+            best = k;
+        }
+    }
+
+    // Follow the strongest tone, hysteresis keeps noise from moving the decoder around
+    if (best != cw->bin && cw->levels[best] > cw->levels[cw->bin] * CW_BIN_SWITCH_RATIO)
+    {
+        cw->bin = best;
+        cw->signal = 0;
+    }
+
+    // Averaging two blocks keeps noise from breaking marks and spaces up
+    const float magnitude = sqrtf(MAX(powers[cw->bin], 0.0f));
+    const float level = (magnitude + cw->previous) / 2;
+
+    cw->previous = magnitude;
+
+    // Signal follows key down and noise key up levels, peaks and valleys are taken right away
+    if (level > cw->signal)
+    {
+        cw->signal += (level - cw->signal) * CW_TRACK_ATTACK;
+    }
+    else
+    {
+        cw->signal += (level - cw->signal) * (cw->key ? CW_TRACK_AVERAGE : CW_TRACK_DECAY);
+    }
+
+    if (level < cw->noise)
+    {
+        cw->noise += (level - cw->noise) * CW_TRACK_ATTACK;
+    }
+    else if (!cw->key)
+    {
+        cw->noise += (level - cw->noise) * CW_TRACK_AVERAGE;
+    }
+
+    bool key;
+
+    if (cw->levels[cw->bin] < CW_Median(cw->levels) * CW_MIN_SNR)
+    {
+        // No tone stands out of the noise
+        key = false;
+    }
+    else if (cw->key)
+    {
+        key = level > cw->noise + (cw->signal - cw->noise) * CW_KEY_UP_THRESHOLD;
+    }
+    else
+    {
+        key = level > cw->noise + (cw->signal - cw->noise) * CW_KEY_DOWN_THRESHOLD;
+    }
+
+    cw->duration++;
+
+    if (key != cw->key)
+    {
+        if (key)
+        {
+            CW_Space(cw, cw->duration);
+        }
+        else
+        {
+            CW_Mark(cw, cw->duration);
+        }
+
+        cw->key = key;
+        cw->duration = 0;
+    }
+    else if (!key)
+    {
+        // Report the last character and word without waiting for the next key down
+        CW_Space(cw, cw->duration);
+    }
+}
+
+/// @brief Decode samples, callback is called from here
+/// @param cw pointer to decoder
+/// @param samples input samples
+/// @param len amount of samples
+void CW_Process(CW_t *cw, const int16_t *samples, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        const float x = samples[i];
+
+        for (uint8_t k = 0; k < CW_BIN_COUNT; k++)
+        {
+            const float s0 = x + cw->coeffs[k] * cw->s1[k] - cw->s2[k];
+
+            cw->s2[k] = cw->s1[k];
+            cw->s1[k] = s0;
+        }
+
+        if (++cw->count == cw->block_size)
+        {
+            cw->count = 0;
+            CW_Block(cw);
+        }
+    }
+}
+
+/// @brief Frequency of the tone being decoded
+/// @param cw pointer to decoder
+/// @return frequency in Hz
+uint16_t CW_Frequency(const CW_t *cw)
+{
+    return CW_MIN_FREQ + cw->bin * CW_FREQ_STEP;
+}
+
+/// @brief Speed of the sender
+/// @param cw pointer to decoder
+/// @return words per minute
+uint8_t CW_Wpm(const CW_t *cw)
+{
+    return 60000.0f / (MORSE_PARIS_DOTS * cw->dot * CW_BLOCK_MS) + 0.5f;
+}
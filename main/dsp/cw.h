@@ -0,0 +1,74 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef DSP_CW_H
+#define DSP_CW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "morse.h"
+
+// Define length of a detector block in ms, sets the timing resolution
+#define CW_BLOCK_MS 6
+// Define tone search range, one Goertzel bin per step
+#define CW_MIN_FREQ 400
+#define CW_FREQ_STEP 50
+#define CW_BIN_COUNT 16
+// Define speed range the dot estimate is kept in
+#define CW_MIN_WPM 5
+#define CW_MAX_WPM 50
+// Define speed assumed before the first characters
+#define CW_INITIAL_WPM 20
+// Define min ratio of the tone bin and the median bin level, weaker tones are not decoded
+#define CW_MIN_SNR 2.0f
+
+// Called with each decoded character, words are separated by a space and unknown codes are reported as '*'
+typedef void (*CW_Callback_t)(char c, void *arg);
+
+// CW decoder. A bank of Goertzel filters finds the tone, its level is compared to a threshold between
+// the tracked key up and key down levels, and key down/up lengths are classified by an adaptive dot length.
+typedef struct
+{
+    uint16_t block_size;             // samples in a detector block
+    uint16_t count;                  // samples in the current block
+    float coeffs[CW_BIN_COUNT];      // Goertzel coefficients, 2cos(w)
+    float s1[CW_BIN_COUNT];          // Goertzel state
+    float s2[CW_BIN_COUNT];          // Goertzel state
+    float levels[CW_BIN_COUNT];      // smoothed power of the bins, the strongest one holds the tone
+    uint8_t bin;                     // bin the tone is decoded from
+    float signal;                    // key down level, follows peaks
+    float noise;                     // key up level, follows valleys
+    bool key;                        // key is down
+    uint32_t duration;               // blocks since the last key change
+    float dot;                       // estimated dot length in blocks
+    float previous;                  // tone level of the previous block
+    uint16_t marks[MORSE_MAX_CODE_LEN]; // key down lengths of the character being received
+    uint8_t mark_count;              // amount of marks, above MORSE_MAX_CODE_LEN the character is unknown
+    bool spaced;                     // word space was reported since the last character
+    bool received;                   // a character was reported, words are not spaced before the first one
+    CW_Callback_t callback;          // character callback
+    void *arg;                       // passed to the callback
+} CW_t;
+
+bool CW_Init(CW_t *cw, uint32_t sample_rate, CW_Callback_t callback, void *arg);
+void CW_Process(CW_t *cw, const int16_t *samples, size_t len);
+uint16_t CW_Frequency(const CW_t *cw);
+uint8_t CW_Wpm(const CW_t *cw);
+
+#endif
@@ -0,0 +1,82 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "dc.h"
+
+/// @brief Initialize DC tracker, it locks onto the first block unless seeded
+/// @param dc pointer to DC tracker
+/// @param shift time constant as a power of 2 of blocks, i.e. 8 tracks over 256 blocks
+void DC_Init(DC_t *dc, uint8_t shift)
+{
+    dc->mean = 0;
+    dc->shift = shift;
+    dc->primed = false;
+}
+
+/// @brief Start tracking from known DC value, i.e. the one saved in settings
+/// @param dc pointer to DC tracker
+/// @param value DC value
+void DC_Seed(DC_t *dc, int16_t value)
+{
+    dc->mean = (int32_t)value << 16;
+    dc->primed = true;
+}
+
+/// @brief Get current DC estimate
+/// @param dc pointer to DC tracker
+/// @return DC value rounded to the nearest integer
+int16_t DC_Value(const DC_t *dc)
+{
+    return (int16_t)((dc->mean + (1 << 15)) >> 16);
+}
+
+/// @brief Remove DC from the block in place and update the estimate with the block mean
+/// @param dc pointer to DC tracker
+/// @param samples samples to process
+/// @param len amount of samples
+/// @param gated whether the block should barely move the estimate, i.e. while a signal is received
+void DC_Process(DC_t *dc, int16_t *samples, size_t len, bool gated)
+{
+    int32_t sum = 0;
+
+    if (len == 0)
+        return;
+
+    // Lock onto the first block so the output is centered right away
+    if (!dc->primed)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            sum += samples[i];
+        }
+        dc->mean = (int32_t)(((int64_t)sum << 16) / (int32_t)len);
+        dc->primed = true;
+        sum = 0;
+    }
+
+    const int16_t value = DC_Value(dc);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        sum += samples[i];
+        samples[i] -= value;
+    }
+
+    const int32_t block_mean = (int32_t)(((int64_t)sum << 16) / (int32_t)len);
+
+    // One-pole lowpass over block means, gated blocks still pull a wrong estimate back eventually
+    dc->mean += (block_mean - dc->mean) >> (gated ? dc->shift + DC_GATED_EXTRA_SHIFT : dc->shift);
+}
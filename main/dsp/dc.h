@@ -0,0 +1,40 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_DC_H
+#define DSP_DC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Define how much slower the estimate follows gated blocks, as a power of 2, i.e. 4 is 16 times slower
+#define DC_GATED_EXTRA_SHIFT 4
+
+// Gated running mean of the input, removes DC bias and follows its slow drift
+typedef struct
+{
+    int32_t mean;  // DC estimate in Q16
+    uint8_t shift; // time constant as a power of 2 of blocks
+    bool primed;   // whether the estimate is based on any input yet
+} DC_t;
+
+void DC_Init(DC_t *dc, uint8_t shift);
+void DC_Seed(DC_t *dc, int16_t value);
+int16_t DC_Value(const DC_t *dc);
+void DC_Process(DC_t *dc, int16_t *samples, size_t len, bool gated);
+
+#endif
@@ -0,0 +1,163 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "decimator.h"
+#include "helper/misc.h"
+
+// Coefficient tables are Kaiser windowed sinc lowpass filters (beta 5.65) in Q15 with unity DC gain.
+// Output rate is 32 kHz: passband 0-8 kHz (+-0.01 dB), stopband from 24 kHz (-59 dB),
+// so nothing folds back into the 0-8 kHz band, which is where the radio audio is.
+
+// 64 kHz -> 32 kHz
+static const int16_t decimator_coeffs_2[] = {
+    -20, -98, 270, 596, -1170, -2202, 4432, 14576,
+    14576, 4432, -2202, -1170, 596, 270, -98, -20};
+
+// 128 kHz -> 32 kHz
+static const int16_t decimator_coeffs_4[] = {
+    -5, -31, -60, -42, 67, 243, 351, 205,
+    -282, -927, -1257, -712, 999, 3604, 6270, 7961,
+    7961, 6270, 3604, 999, -712, -1257, -927, -282,
+    205, 351, 243, 67, -42, -60, -31, -5};
+
+// Voice tables take 32 kHz input and keep as much of the band as the output rate allows (same window, -59 dB stopband).
+// Transition band is narrow and aliases only into itself, so the passband stays clean.
+
+// 32 kHz -> 16 kHz: passband 0-6 kHz, stopband from 10 kHz
+static const int16_t decimator_voice_coeffs_2[] = {
+    -10, 27, 53, -92, -148, 226, 332, -473, -661, 916,
+    1273, -1811, -2732, 4783, 14701, 14701, 4783, -2732, -1811, 1273,
+    916, -661, -473, 332, 226, -148, -92, 53, 27, -10};
+
+// 32 kHz -> 8 kHz: passband 0-3.2 kHz (-0.4 dB at 3.5 kHz), stopband from 4.8 kHz
+static const int16_t decimator_voice_coeffs_4[] = {
+    -2, -7, -10, -6, 7, 23, 29, 15, -18, -51,
+    -61, -30, 35, 99, 115, 55, -63, -174, -198, -93,
+    106, 288, 325, 152, -171, -466, -525, -246, 278, 764,
+    873, 417, -485, -1383, -1667, -858, 1118, 3816, 6402, 7981,
+    7981, 6402, 3816, 1118, -858, -1667, -1383, -485, 417, 873,
+    764, 278, -246, -525, -466, -171, 152, 325, 288, 106,
+    -93, -198, -174, -63, 55, 115, 99, 35, -30, -61,
+    -51, -18, 15, 29, 23, 7, -6, -10, -7, -2};
+
+_Static_assert(ARRAY_SIZE(decimator_voice_coeffs_4) <= DECIMATOR_MAX_TAPS, "Decimator coefficient table does not fit the delay line");
+
+// Reset decimator to use the coefficient table
+static void DECIMATOR_Setup(DECIMATOR_t *decimator, uint8_t factor, const int16_t *coeffs, uint8_t taps)
+{
+    decimator->coeffs = coeffs;
+    decimator->taps = taps;
+    decimator->factor = factor;
+    decimator->phase = 0;
+    decimator->pos = 0;
+    decimator->primed = false;
+    memset(decimator->delay, 0, sizeof(decimator->delay));
+}
+
+/// @brief Initialize decimator for given decimation factor
+/// @param decimator pointer to decimator
+/// @param factor decimation factor, 2 or 4
+/// @return false if there is no coefficient table for the factor
+bool DECIMATOR_Init(DECIMATOR_t *decimator, uint8_t factor)
+{
+    switch (factor)
+    {
+    case 2:
+        DECIMATOR_Setup(decimator, factor, decimator_coeffs_2, ARRAY_SIZE(decimator_coeffs_2));
+        return true;
+    case 4:
+        DECIMATOR_Setup(decimator, factor, decimator_coeffs_4, ARRAY_SIZE(decimator_coeffs_4));
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Initialize decimator for the 32 kHz voice path, i.e. lower rate recordings
+/// @param decimator pointer to decimator
+/// @param factor decimation factor, 2 (16 kHz output) or 4 (8 kHz output)
+/// @return false if there is no coefficient table for the factor
+bool DECIMATOR_InitVoice(DECIMATOR_t *decimator, uint8_t factor)
+{
+    switch (factor)
+    {
+    case 2:
+        DECIMATOR_Setup(decimator, factor, decimator_voice_coeffs_2, ARRAY_SIZE(decimator_voice_coeffs_2));
+        return true;
+    case 4:
+        DECIMATOR_Setup(decimator, factor, decimator_voice_coeffs_4, ARRAY_SIZE(decimator_voice_coeffs_4));
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// @brief Filter and decimate block of samples
+// Only every factor-th output is computed, so the cost is taps MACs per output sample
+/// @param decimator pointer to decimator
+/// @param input input samples
+/// @param len amount of input samples
+/// @param output output buffer, must fit len / factor + 1 samples, can be the same as input
+/// @return amount of output samples
+size_t DECIMATOR_Process(DECIMATOR_t *decimator, const int16_t *input, size_t len, int16_t *output)
+{
+    size_t out = 0;
+
+    // Start from the first sample instead of zeros, ADC input is not centered and the step would look like a signal
+    if (!decimator->primed && len > 0)
+    {
+        for (uint8_t k = 0; k < decimator->taps * 2; k++)
+        {
+            decimator->delay[k] = input[0];
+        }
+        decimator->primed = true;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        decimator->delay[decimator->pos] = input[i];
+        decimator->delay[decimator->pos + decimator->taps] = input[i];
+
+        if (++decimator->pos == decimator->taps)
+        {
+            decimator->pos = 0;
+        }
+
+        if (++decimator->phase < decimator->factor)
+        {
+            continue;
+        }
+
+        decimator->phase = 0;
+
+        // Window of the last taps samples, coefficients are symmetric so direction does not matter
+        const int16_t *window = &decimator->delay[decimator->pos];
+        int32_t acc = 1 << 14;
+
+        for (uint8_t k = 0; k < decimator->taps; k++)
+        {
+            acc += (int32_t)decimator->coeffs[k] * window[k];
+        }
+
+        acc >>= 15;
+
+        output[out++] = (int16_t)MIN(MAX(acc, INT16_MIN), INT16_MAX);
+    }
+
+    return out;
+}
@@ -0,0 +1,43 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_DECIMATOR_H
+#define DSP_DECIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Define max amount of FIR taps among the coefficient tables
+#define DECIMATOR_MAX_TAPS 80
+
+// Integer polyphase FIR decimator
+typedef struct
+{
+    uint8_t factor;        // decimation factor
+    uint8_t phase;         // input samples since last output sample
+    uint8_t taps;          // amount of FIR taps
+    uint8_t pos;           // position of the next sample in the delay line
+    bool primed;           // whether the delay line holds any input yet
+    const int16_t *coeffs; // Q15 FIR coefficients
+    int16_t delay[DECIMATOR_MAX_TAPS * 2]; // delay line stored twice so the FIR window is always contiguous
+} DECIMATOR_t;
+
+bool DECIMATOR_Init(DECIMATOR_t *decimator, uint8_t factor);
+bool DECIMATOR_InitVoice(DECIMATOR_t *decimator, uint8_t factor);
+size_t DECIMATOR_Process(DECIMATOR_t *decimator, const int16_t *input, size_t len, int16_t *output);
+
+#endif
@@ -0,0 +1,115 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <string.h>
+
+#include "demod.h"
+
+// Define phase offset of the cosine
+#define DEMOD_QUARTER_CYCLE 0x40000000u
+
+/// @brief Initialize demodulator
+/// @param demod pointer to demodulator
+/// @param sample_rate input sample rate in Hz
+/// @param baud bits per second
+/// @param mark_freq frequency of the mark ("1") tone in Hz
+/// @param space_freq frequency of the space ("0") tone in Hz
+/// @param callback called with each decoded frame
+/// @param arg passed to the callback
+/// @return false if a bit does not fit the window
+bool DEMOD_Init(DEMOD_t *demod, uint32_t sample_rate, uint16_t baud, uint16_t mark_freq, uint16_t space_freq, DEMOD_Callback_t callback, void *arg)
+{
+    const uint32_t window = (sample_rate + baud / 2) / baud;
+
+    if (baud == 0 || window == 0 || window > DEMOD_MAX_WINDOW)
+        return false;
+
+    memset(demod, 0, sizeof(DEMOD_t));
+
+    NCO_SetFreq(&demod->mark, mark_freq, sample_rate);
+    NCO_SetFreq(&demod->space, space_freq, sample_rate);
+    demod->window = window;
+    demod->pll_step = ((uint64_t)baud << 32) / sample_rate;
+    demod->callback = callback;
+    demod->arg = arg;
+
+    HDLC_DecoderInit(&demod->hdlc);
+
+    return true;
+}
+
+/// @brief Demodulate samples, callback is called from here
+/// @param demod pointer to demodulator
+/// @param samples input samples
+/// @param len amount of samples
+void DEMOD_Process(DEMOD_t *demod, const int16_t *samples, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        const int32_t x = samples[i];
+        int32_t lo[DEMOD_PRODUCT_LAST];
+
+        lo[DEMOD_MARK_I] = NCO_Sine(demod->mark.phase + DEMOD_QUARTER_CYCLE);
+        lo[DEMOD_MARK_Q] = NCO_Sine(demod->mark.phase);
+        lo[DEMOD_SPACE_I] = NCO_Sine(demod->space.phase + DEMOD_QUARTER_CYCLE);
+        lo[DEMOD_SPACE_Q] = NCO_Sine(demod->space.phase);
+
+        demod->mark.phase += demod->mark.step;
+        demod->space.phase += demod->space.step;
+
+        // Sliding sums over a bit are the tone amplitudes no matter the phase of the oscillators
+        for (uint8_t k = 0; k < DEMOD_PRODUCT_LAST; k++)
+        {
+            const int16_t product = (x * lo[k]) >> 15;
+
+            demod->sums[k] += product - demod->products[k][demod->pos];
+            demod->products[k][demod->pos] = product;
+        }
+
+        if (++demod->pos == demod->window)
+        {
+            demod->pos = 0;
+        }
+
+        const int64_t mark = (int64_t)demod->sums[DEMOD_MARK_I] * demod->sums[DEMOD_MARK_I] + (int64_t)demod->sums[DEMOD_MARK_Q] * demod->sums[DEMOD_MARK_Q];
+        const int64_t space = (int64_t)demod->sums[DEMOD_SPACE_I] * demod->sums[DEMOD_SPACE_I] + (int64_t)demod->sums[DEMOD_SPACE_Q] * demod->sums[DEMOD_SPACE_Q];
+        const bool level = mark > space;
+
+        // Pull the clock towards the transition, harder while searching for a frame
+        if (level != demod->level)
+        {
+            demod->pll -= demod->hdlc.in_frame ? demod->pll / 4 : demod->pll / 2;
+            demod->level = level;
+        }
+
+        const int32_t previous = demod->pll;
+
+        demod->pll = (int32_t)((uint32_t)demod->pll + demod->pll_step);
+
+        // Middle of the bit
+        if (previous > 0 && demod->pll < 0)
+        {
+            const size_t frame_len = HDLC_DecodeBit(&demod->hdlc, level);
+
+            if (frame_len > 0)
+            {
+                demod->frames++;
+                demod->callback(demod->hdlc.frame, frame_len, demod->arg);
+            }
+        }
+    }
+}
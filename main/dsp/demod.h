@@ -0,0 +1,66 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef DSP_DEMOD_H
+#define DSP_DEMOD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "nco.h"
+#include "hdlc.h"
+
+// Define max length of the correlation window in samples, a bit at 48 kHz and 1200 baud fits
+#define DEMOD_MAX_WINDOW 48
+
+// Called with each frame that passed the FCS check, FCS is not included
+typedef void (*DEMOD_Callback_t)(const uint8_t *frame, size_t len, void *arg);
+
+// Mixer outputs kept for the sliding window
+typedef enum
+{
+    DEMOD_MARK_I,
+    DEMOD_MARK_Q,
+    DEMOD_SPACE_I,
+    DEMOD_SPACE_Q,
+    DEMOD_PRODUCT_LAST
+} DEMOD_Product_t;
+
+// AFSK demodulator, mixes the input with both tones and compares their energy over the last bit.
+// Bit clock is recovered by a PLL nudged by level transitions, bits go straight into the HDLC decoder.
+typedef struct
+{
+    NCO_t mark;                                            // mark tone oscillator
+    NCO_t space;                                           // space tone oscillator
+    int16_t products[DEMOD_PRODUCT_LAST][DEMOD_MAX_WINDOW]; // mixer outputs of the last window
+    int32_t sums[DEMOD_PRODUCT_LAST];                      // sums of the products over the window
+    uint8_t window;                                        // window length in samples, one bit
+    uint8_t pos;                                           // position of the oldest product
+    bool level;                                            // current line level, true is mark
+    int32_t pll;                                           // bit clock phase, transitions are expected at 0 and bits are sampled when it wraps
+    uint32_t pll_step;                                     // bit clock phase increment per sample
+    HDLC_Decoder_t hdlc;                                   // frame decoder
+    DEMOD_Callback_t callback;                             // frame callback
+    void *arg;                                             // passed to the callback
+    uint32_t frames;                                       // amount of decoded frames
+} DEMOD_t;
+
+bool DEMOD_Init(DEMOD_t *demod, uint32_t sample_rate, uint16_t baud, uint16_t mark_freq, uint16_t space_freq, DEMOD_Callback_t callback, void *arg);
+void DEMOD_Process(DEMOD_t *demod, const int16_t *samples, size_t len);
+
+#endif
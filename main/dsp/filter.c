@@ -57,4 +57,16 @@ float FILTER_Update(FILTER_BiquadFilter_t *filter, float newInput) {
     filter->outputHistory[1] = filter->outputHistory[0];
     filter->outputHistory[0] = newOutput;
     return newOutput;
-}
\ No newline at end of file
+}
+
+/// @brief Filter block of samples in place
+/// @param filter pointer to filter
+/// @param samples samples to be filtered
+/// @param len amount of samples
+void FILTER_Process(FILTER_BiquadFilter_t *filter, int16_t *samples, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        float output = FILTER_Update(filter, samples[i]);
+        // Saturate, resonance can push the output over the input range
+        samples[i] = (int16_t)MAX(MIN(output, (float)INT16_MAX), (float)INT16_MIN);
+    }
+}
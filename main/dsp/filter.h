@@ -17,6 +17,9 @@
 #ifndef DSP_FILTER_H
 #define DSP_FILTER_H
 
+#include <stdint.h>
+#include <stddef.h>
+
 typedef enum {
     FILTER_LOWPASS,
     FILTER_HIGHPASS
@@ -30,5 +33,6 @@ typedef struct {
 
 void FILTER_Init(FILTER_BiquadFilter_t *filter, float frequency, int sampleRate, FILTER_PassType_t passType, float resonance);
 float FILTER_Update(FILTER_BiquadFilter_t *filter, float newInput);
+void FILTER_Process(FILTER_BiquadFilter_t *filter, int16_t *samples, size_t len);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,255 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include "hdlc.h"
+
+// CRC-16/X.25 (reflected polynomial 0x8408) of every byte value
+static const uint16_t HDLC_CRC_TABLE[256] = {
+    0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+    0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+    0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+    0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+    0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+    0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+    0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+    0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+    0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+    0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+    0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+    0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+    0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+    0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+    0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+    0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+    0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+    0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+    0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+    0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+    0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+    0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+    0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+    0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+    0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+    0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+    0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+    0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+    0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+    0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+    0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+    0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
+};
+
+/// @brief Update CRC-16/X.25 with data, start with 0xffff and invert the result to get the FCS
+/// @param crc current CRC
+/// @param data bytes to add
+/// @param len amount of bytes
+/// @return updated CRC
+uint16_t HDLC_Crc(uint16_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = (crc >> 8) ^ HDLC_CRC_TABLE[(crc ^ data[i]) & 0xff];
+    }
+
+    return crc;
+}
+
+/// @brief Initialize encoder
+/// @param encoder pointer to encoder
+/// @param output buffer for the line bits
+/// @param size size of output in bytes
+void HDLC_EncoderInit(HDLC_Encoder_t *encoder, uint8_t *output, size_t size)
+{
+    encoder->output = output;
+    encoder->size = size;
+    encoder->bits = 0;
+    encoder->ones = 0;
+    encoder->level = true;
+}
+
+// NRZI encode a bit, zero toggles the line and one keeps it
+static bool HDLC_PutBit(HDLC_Encoder_t *encoder, bool bit)
+{
+    const size_t byte = encoder->bits / 8;
+    const uint8_t mask = 1 << (encoder->bits % 8);
+
+    if (byte >= encoder->size)
+        return false;
+
+    if (!bit)
+    {
+        encoder->level = !encoder->level;
+    }
+
+    if (encoder->level)
+    {
+        encoder->output[byte] |= mask;
+    }
+    else
+    {
+        encoder->output[byte] &= ~mask;
+    }
+
+    encoder->bits++;
+
+    return true;
+}
+
+// Encode a byte LSB first, stuffing a zero after five ones in a row
+static bool HDLC_PutByte(HDLC_Encoder_t *encoder, uint8_t byte)
+{
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        const bool bit = (byte >> i) & 1;
+
+        if (!HDLC_PutBit(encoder, bit))
+            return false;
+
+        encoder->ones = bit ? encoder->ones + 1 : 0;
+
+        if (encoder->ones == 5)
+        {
+            if (!HDLC_PutBit(encoder, false))
+                return false;
+
+            encoder->ones = 0;
+        }
+    }
+
+    return true;
+}
+
+/// @brief Encode flags, used as preamble and between or after frames
+/// @param encoder pointer to encoder
+/// @param count amount of flags
+/// @return false if the output is full
+bool HDLC_EncodeFlags(HDLC_Encoder_t *encoder, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            if (!HDLC_PutBit(encoder, (HDLC_FLAG >> bit) & 1))
+                return false;
+        }
+    }
+
+    encoder->ones = 0;
+
+    return true;
+}
+
+/// @brief Encode frame followed by its FCS, flags around it are up to the caller
+/// @param encoder pointer to encoder
+/// @param frame frame bytes without FCS
+/// @param len amount of bytes
+/// @return false if the output is full
+bool HDLC_EncodeFrame(HDLC_Encoder_t *encoder, const uint8_t *frame, size_t len)
+{
+    const uint16_t fcs = ~HDLC_Crc(0xffff, frame, len);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (!HDLC_PutByte(encoder, frame[i]))
+            return false;
+    }
+
+    // FCS goes low byte first
+    return HDLC_PutByte(encoder, fcs & 0xff) && HDLC_PutByte(encoder, fcs >> 8);
+}
+
+/// @brief Initialize decoder
+/// @param decoder pointer to decoder
+void HDLC_DecoderInit(HDLC_Decoder_t *decoder)
+{
+    decoder->len = 0;
+    decoder->byte = 0;
+    decoder->bit_count = 0;
+    decoder->pattern = 0;
+    decoder->ones = 0;
+    decoder->level = false;
+    decoder->in_frame = false;
+}
+
+/// @brief Decode a single line bit
+/// @param decoder pointer to decoder
+/// @param level line level, NRZI is decoded here
+/// @return length of the received frame without FCS once the closing flag of a frame with a good FCS arrives, otherwise 0
+size_t HDLC_DecodeBit(HDLC_Decoder_t *decoder, bool level)
+{
+    const bool bit = level == decoder->level;
+    size_t len = 0;
+
+    decoder->level = level;
+    decoder->pattern = (decoder->pattern >> 1) | (bit ? 0x80 : 0);
+
+    if (decoder->pattern == HDLC_FLAG)
+    {
+        // 7 bits of the flag made it into the byte, the frame ends on a byte boundary only if no other bits did
+        if (decoder->in_frame && decoder->bit_count == 7 && decoder->len >= HDLC_MIN_FRAME_SIZE &&
+            HDLC_Crc(0xffff, decoder->frame, decoder->len) == HDLC_CRC_GOOD)
+        {
+            len = decoder->len - HDLC_FCS_SIZE;
+        }
+
+        decoder->in_frame = true;
+        decoder->len = 0;
+        decoder->byte = 0;
+        decoder->bit_count = 0;
+        decoder->ones = 0;
+
+        return len;
+    }
+
+    if (bit)
+    {
+        // Abort or idle line
+        if (++decoder->ones > 6)
+        {
+            decoder->in_frame = false;
+            return 0;
+        }
+    }
+    else
+    {
+        const bool stuffed = decoder->ones == 5;
+
+        decoder->ones = 0;
+
+        if (stuffed)
+            return 0;
+    }
+
+    if (!decoder->in_frame)
+        return 0;
+
+    decoder->byte = (decoder->byte >> 1) | (bit ? 0x80 : 0);
+
+    if (++decoder->bit_count == 8)
+    {
+        if (decoder->len == HDLC_MAX_FRAME_SIZE)
+        {
+            decoder->in_frame = false;
+            return 0;
+        }
+
+        decoder->frame[decoder->len++] = decoder->byte;
+        decoder->bit_count = 0;
+    }
+
+    return 0;
+}
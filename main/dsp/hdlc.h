@@ -0,0 +1,68 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef DSP_HDLC_H
+#define DSP_HDLC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Define HDLC flag byte delimiting frames
+#define HDLC_FLAG 0x7e
+// Define size of the frame check sequence in bytes
+#define HDLC_FCS_SIZE 2
+// Define residue of the CRC run over a frame with its FCS
+#define HDLC_CRC_GOOD 0xf0b8
+// Define max size of a received frame with FCS, fits the largest AX.25 frame
+#define HDLC_MAX_FRAME_SIZE 330
+// Define min size of a received frame with FCS, shorter ones are noise
+#define HDLC_MIN_FRAME_SIZE 4
+// Define amount of bytes needed for the line bits of a frame of len bytes surrounded by flags, worst case stuffing adds a bit every 5
+#define HDLC_ENCODED_SIZE(len, flags) (((((len) + HDLC_FCS_SIZE) * 8 * 6 + 4) / 5 + (flags) * 8 + 7) / 8)
+
+// HDLC encoder, writes NRZI line bits LSB first into a byte buffer
+typedef struct
+{
+    uint8_t *output; // line bits
+    size_t size;     // size of output in bytes
+    size_t bits;     // amount of bits written
+    uint8_t ones;    // consecutive ones of the current frame, a zero is stuffed after 5
+    bool level;      // current line level
+} HDLC_Encoder_t;
+
+// HDLC decoder, takes NRZI line bits and collects frames between flags
+typedef struct
+{
+    uint8_t frame[HDLC_MAX_FRAME_SIZE]; // received bytes, FCS included
+    size_t len;                         // amount of bytes in frame
+    uint8_t byte;                       // byte being received, LSB first
+    uint8_t bit_count;                  // amount of bits in byte
+    uint8_t pattern;                    // last 8 received bits, used to spot flags
+    uint8_t ones;                       // consecutive ones, a zero after 5 is stuffing and 7 abort the frame
+    bool level;                         // previous line level
+    bool in_frame;                      // flag was seen and no abort since
+} HDLC_Decoder_t;
+
+uint16_t HDLC_Crc(uint16_t crc, const uint8_t *data, size_t len);
+void HDLC_EncoderInit(HDLC_Encoder_t *encoder, uint8_t *output, size_t size);
+bool HDLC_EncodeFlags(HDLC_Encoder_t *encoder, size_t count);
+bool HDLC_EncodeFrame(HDLC_Encoder_t *encoder, const uint8_t *frame, size_t len);
+void HDLC_DecoderInit(HDLC_Decoder_t *decoder);
+size_t HDLC_DecodeBit(HDLC_Decoder_t *decoder, bool level);
+
+#endif
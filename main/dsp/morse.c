@@ -0,0 +1,269 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <ctype.h>
+#include <string.h>
+
+#include "morse.h"
+#include "helper/misc.h"
+
+// Define first character of the table
+#define MORSE_TABLE_FIRST ' '
+// Define last character of the table, lowercase is converted to uppercase
+#define MORSE_TABLE_LAST '_'
+
+// ITU codes of the characters, ones missing from the table are skipped
+static const char *const MORSE_TABLE[MORSE_TABLE_LAST - MORSE_TABLE_FIRST + 1] = {
+    ['A' - MORSE_TABLE_FIRST] = ".-",
+    ['B' - MORSE_TABLE_FIRST] = "-...",
+    ['C' - MORSE_TABLE_FIRST] = "-.-.",
+    ['D' - MORSE_TABLE_FIRST] = "-..",
+    ['E' - MORSE_TABLE_FIRST] = ".",
+    ['F' - MORSE_TABLE_FIRST] = "..-.",
+    ['G' - MORSE_TABLE_FIRST] = "--.",
+    ['H' - MORSE_TABLE_FIRST] = "....",
+    ['I' - MORSE_TABLE_FIRST] = "..",
+    ['J' - MORSE_TABLE_FIRST] = ".---",
+    ['K' - MORSE_TABLE_FIRST] = "-.-",
+    ['L' - MORSE_TABLE_FIRST] = ".-..",
+    ['M' - MORSE_TABLE_FIRST] = "--",
+    ['N' - MORSE_TABLE_FIRST] = "-.",
+    ['O' - MORSE_TABLE_FIRST] = "---",
+    ['P' - MORSE_TABLE_FIRST] = ".--.",
+    ['Q' - MORSE_TABLE_FIRST] = "--.-",
+    ['R' - MORSE_TABLE_FIRST] = ".-.",
+    ['S' - MORSE_TABLE_FIRST] = "...",
+    ['T' - MORSE_TABLE_FIRST] = "-",
+    ['U' - MORSE_TABLE_FIRST] = "..-",
+    ['V' - MORSE_TABLE_FIRST] = "...-",
+    ['W' - MORSE_TABLE_FIRST] = ".--",
+    ['X' - MORSE_TABLE_FIRST] = "-..-",
+    ['Y' - MORSE_TABLE_FIRST] = "-.--",
+    ['Z' - MORSE_TABLE_FIRST] = "--..",
+    ['0' - MORSE_TABLE_FIRST] = "-----",
+    ['1' - MORSE_TABLE_FIRST] = ".----",
+    ['2' - MORSE_TABLE_FIRST] = "..---",
+    ['3' - MORSE_TABLE_FIRST] = "...--",
+    ['4' - MORSE_TABLE_FIRST] = "....-",
+    ['5' - MORSE_TABLE_FIRST] = ".....",
+    ['6' - MORSE_TABLE_FIRST] = "-....",
+    ['7' - MORSE_TABLE_FIRST] = "--...",
+    ['8' - MORSE_TABLE_FIRST] = "---..",
+    ['9' - MORSE_TABLE_FIRST] = "----.",
+    ['.' - MORSE_TABLE_FIRST] = ".-.-.-",
+    [',' - MORSE_TABLE_FIRST] = "--..--",
+    ['?' - MORSE_TABLE_FIRST] = "..--..",
+    ['\'' - MORSE_TABLE_FIRST] = ".----.",
+    ['!' - MORSE_TABLE_FIRST] = "-.-.--",
+    ['/' - MORSE_TABLE_FIRST] = "-..-.",
+    ['(' - MORSE_TABLE_FIRST] = "-.--.",
+    [')' - MORSE_TABLE_FIRST] = "-.--.-",
+    ['&' - MORSE_TABLE_FIRST] = ".-...",
+    [':' - MORSE_TABLE_FIRST] = "---...",
+    [';' - MORSE_TABLE_FIRST] = "-.-.-.",
+    ['=' - MORSE_TABLE_FIRST] = "-...-",
+    ['+' - MORSE_TABLE_FIRST] = ".-.-.",
+    ['-' - MORSE_TABLE_FIRST] = "-....-",
+    ['_' - MORSE_TABLE_FIRST] = "..--.-",
+    ['"' - MORSE_TABLE_FIRST] = ".-..-.",
+    ['$' - MORSE_TABLE_FIRST] = "...-..-",
+    ['@' - MORSE_TABLE_FIRST] = ".--.-.",
+};
+
+// Encoder state, gaps are merged so the longest one pending wins
+typedef struct
+{
+    const MORSE_Timing_t *timing;
+    MORSE_Element_t *elements;
+    size_t max;
+    size_t count;
+    uint16_t gap_ms; // gap waiting for the next keyed element
+} MORSE_Encoder_t;
+
+/// @brief Derive element durations from the speed
+/// @param timing element durations
+/// @param wpm character speed in words per minute
+/// @param farnsworth_wpm overall speed, gaps are stretched to reach it while the characters keep wpm; 0 or >= wpm disables
+void MORSE_Timing(MORSE_Timing_t *timing, uint8_t wpm, uint8_t farnsworth_wpm)
+{
+    wpm = wpm > 0 ? wpm : 1;
+
+    const uint32_t dot_ms = 60000 / (MORSE_PARIS_DOTS * wpm);
+
+    timing->dot_ms = dot_ms;
+    timing->dash_ms = dot_ms * 3;
+    timing->letter_gap_ms = dot_ms * MORSE_LETTER_GAP_DOTS;
+    timing->word_gap_ms = dot_ms * MORSE_WORD_GAP_DOTS;
+
+    if (farnsworth_wpm == 0 || farnsworth_wpm >= wpm)
+        return;
+
+    // "PARIS " takes 31 dots of characters and 19 dots of letter and word gaps,
+    // the gaps take whatever is left of a word at the overall speed
+    const uint32_t word_ms = 60000 / farnsworth_wpm;
+    const uint32_t gaps_ms = word_ms - 31 * dot_ms;
+
+    timing->letter_gap_ms = gaps_ms * MORSE_LETTER_GAP_DOTS / 19;
+    timing->word_gap_ms = gaps_ms * MORSE_WORD_GAP_DOTS / 19;
+}
+
+static void MORSE_Gap(MORSE_Encoder_t *encoder, uint16_t duration_ms)
+{
+    if (duration_ms > encoder->gap_ms)
+    {
+        encoder->gap_ms = duration_ms;
+    }
+}
+
+static void MORSE_Key(MORSE_Encoder_t *encoder, uint16_t duration_ms)
+{
+    // Message never starts with a gap
+    if (encoder->gap_ms > 0 && encoder->count > 0 && encoder->count < encoder->max)
+    {
+        encoder->elements[encoder->count++] = (MORSE_Element_t){.key = false, .duration_ms = encoder->gap_ms};
+    }
+
+    if (encoder->count < encoder->max)
+    {
+        encoder->elements[encoder->count++] = (MORSE_Element_t){.key = true, .duration_ms = duration_ms};
+    }
+
+    encoder->gap_ms = encoder->timing->dot_ms * MORSE_ELEMENT_GAP_DOTS;
+}
+
+// Encode string of dots and dashes, other characters are ignored
+static void MORSE_Code(MORSE_Encoder_t *encoder, const char *code)
+{
+    for (; *code != '\0'; code++)
+    {
+        if (*code == '.')
+        {
+            MORSE_Key(encoder, encoder->timing->dot_ms);
+        }
+        else if (*code == '-')
+        {
+            MORSE_Key(encoder, encoder->timing->dash_ms);
+        }
+    }
+}
+
+// Text made of dots, dashes, spaces and slashes only is sent as it is, that is how beacon text used to be written
+static bool MORSE_IsLiteral(const char *text, size_t len)
+{
+    bool elements = false;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        switch (text[i])
+        {
+        case '.':
+        case '-':
+            elements = true;
+            break;
+        case ' ':
+        case '/':
+            break;
+        default:
+            return false;
+        }
+    }
+
+    return elements;
+}
+
+/// @brief Convert text into keyed elements and gaps.
+/// Characters inside angle brackets are sent without letter gaps as a prosign, e.g. <SK>.
+/// Text made of dots, dashes, spaces (letter gap) and slashes (word gap) only is sent literally.
+/// @param text text to encode, lowercase is converted to uppercase and unknown characters are skipped
+/// @param len length of text
+/// @param timing element durations
+/// @param elements output elements, alternating keyed and gap
+/// @param max size of elements, MORSE_MAX_ELEMENTS(len) always fits
+/// @return amount of elements
+size_t MORSE_Encode(const char *text, size_t len, const MORSE_Timing_t *timing, MORSE_Element_t *elements, size_t max)
+{
+    MORSE_Encoder_t encoder = {.timing = timing, .elements = elements, .max = max, .count = 0, .gap_ms = 0};
+    const bool literal = MORSE_IsLiteral(text, len);
+    bool prosign = false;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        const char c = toupper((unsigned char)text[i]);
+
+        if (literal)
+        {
+            const char code[2] = {c, '\0'};
+
+            if (c == ' ')
+            {
+                MORSE_Gap(&encoder, timing->letter_gap_ms);
+            }
+            else if (c == '/')
+            {
+                MORSE_Gap(&encoder, timing->word_gap_ms);
+            }
+
+            MORSE_Code(&encoder, code);
+            continue;
+        }
+
+        if (c == '<')
+        {
+            prosign = true;
+        }
+        else if (c == '>')
+        {
+            prosign = false;
+            MORSE_Gap(&encoder, timing->letter_gap_ms);
+        }
+        else if (c == ' ')
+        {
+            MORSE_Gap(&encoder, timing->word_gap_ms);
+        }
+        else if (c >= MORSE_TABLE_FIRST && c <= MORSE_TABLE_LAST && MORSE_TABLE[c - MORSE_TABLE_FIRST] != NULL)
+        {
+            MORSE_Code(&encoder, MORSE_TABLE[c - MORSE_TABLE_FIRST]);
+
+            if (!prosign)
+            {
+                MORSE_Gap(&encoder, timing->letter_gap_ms);
+            }
+        }
+    }
+
+    // Trailing gap keeps repeated messages apart
+    if (encoder.count > 0 && encoder.count < encoder.max)
+    {
+        elements[encoder.count++] = (MORSE_Element_t){.key = false, .duration_ms = timing->word_gap_ms};
+    }
+
+    return encoder.count;
+}
+
+/// @brief Look up character of the code
+/// @param code string of dots and dashes
+/// @return character or 0 if the code is unknown
+char MORSE_Decode(const char *code)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(MORSE_TABLE); i++)
+    {
+        if (MORSE_TABLE[i] != NULL && strcmp(MORSE_TABLE[i], code) == 0)
+            return MORSE_TABLE_FIRST + i;
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef DSP_MORSE_H
+#define DSP_MORSE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Define length of the standard word "PARIS " in dots, sets the dot length for a given speed
+#define MORSE_PARIS_DOTS 50
+// Define gaps in dots
+#define MORSE_ELEMENT_GAP_DOTS 1
+#define MORSE_LETTER_GAP_DOTS 3
+#define MORSE_WORD_GAP_DOTS 7
+// Define most elements a character has ("$" is ...-..-)
+#define MORSE_MAX_CODE_LEN 7
+// Define amount of elements (keyed and gaps) enough for any text of len characters
+#define MORSE_MAX_ELEMENTS(len) ((len) * 2 * MORSE_MAX_CODE_LEN)
+
+// Element durations derived from the speed
+typedef struct
+{
+    uint16_t dot_ms;        // dot and gap between elements
+    uint16_t dash_ms;       // dash
+    uint16_t letter_gap_ms; // gap between characters
+    uint16_t word_gap_ms;   // gap between words
+} MORSE_Timing_t;
+
+// Keyed or silent part of the message
+typedef struct
+{
+    bool key;             // tone on
+    uint16_t duration_ms; // length of the element
+} MORSE_Element_t;
+
+void MORSE_Timing(MORSE_Timing_t *timing, uint8_t wpm, uint8_t farnsworth_wpm);
+size_t MORSE_Encode(const char *text, size_t len, const MORSE_Timing_t *timing, MORSE_Element_t *elements, size_t max);
+char MORSE_Decode(const char *code);
+
+#endif
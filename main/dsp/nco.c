@@ -0,0 +1,99 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "nco.h"
+
+// Q15 sine over a full cycle, last entry repeats the first one so interpolation never wraps
+static const int16_t nco_sine_q15[NCO_LUT_SIZE + 1] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739,
+    9512, 10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+    25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521,
+    32609, 32678, 32728, 32757, 32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+    32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571, 30273, 29956, 29621, 29268,
+    28898, 28510, 28105, 27683, 27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151,
+    15446, 14732, 14010, 13279, 12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+    6393, 5602, 4808, 4011, 3212, 2410, 1608, 804, 0, -804, -1608, -2410,
+    -3212, -4011, -4808, -5602, -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+    -20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+    -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580,
+    -31356, -31113, -30852, -30571, -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403,
+    -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278, -9512, -8739, -7962, -7179, -6393, -5602, -4808, -4011,
+    -3212, -2410, -1608, -804, 0};
+
+/// @brief Initialize oscillator at zero phase and frequency
+/// @param nco pointer to oscillator
+void NCO_Init(NCO_t *nco)
+{
+    nco->phase = 0;
+    nco->step = 0;
+}
+
+/// @brief Phase increment of the frequency
+/// @param freq frequency in Hz, has to be under half of the sample rate
+/// @param sample_rate sample rate in Hz
+/// @return phase increment per sample
+uint32_t NCO_Step(uint32_t freq, uint32_t sample_rate)
+{
+    return ((uint64_t)freq << 32) / sample_rate;
+}
+
+/// @brief Change frequency, phase continues from where it is, so there are no clicks
+/// @param nco pointer to oscillator
+/// @param freq frequency in Hz
+/// @param sample_rate sample rate in Hz
+void NCO_SetFreq(NCO_t *nco, uint32_t freq, uint32_t sample_rate)
+{
+    nco->step = NCO_Step(freq, sample_rate);
+}
+
+/// @brief Sine of the phase, linear interpolation keeps the error around -90 dB
+/// @param phase phase, 2^32 is a full cycle
+/// @return Q15 sine value
+int16_t NCO_Sine(uint32_t phase)
+{
+    const uint32_t index = phase >> (32 - NCO_LUT_BITS);
+    const int32_t frac = (phase >> (32 - NCO_LUT_BITS - 15)) & 0x7FFF;
+    const int32_t a = nco_sine_q15[index];
+    const int32_t b = nco_sine_q15[index + 1];
+
+    return a + (((b - a) * frac) >> 15);
+}
+
+/// @brief Render sine samples and advance the phase
+/// @param nco pointer to oscillator
+/// @param output rendered samples
+/// @param len amount of samples
+/// @param amplitude peak sample value
+void NCO_Render(NCO_t *nco, int16_t *output, size_t len, int16_t amplitude)
+{
+    uint32_t phase = nco->phase;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        output[i] = (NCO_Sine(phase) * amplitude) >> 15;
+        phase += nco->step;
+    }
+
+    nco->phase = phase;
+}
@@ -0,0 +1,40 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_NCO_H
+#define DSP_NCO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Define size of the sine table as a power of 2, the upper phase bits index it
+#define NCO_LUT_BITS 8
+#define NCO_LUT_SIZE (1 << NCO_LUT_BITS)
+
+// Numerically controlled oscillator, 32-bit phase accumulator wraps once per cycle
+typedef struct
+{
+    uint32_t phase; // current phase, 2^32 is a full cycle
+    uint32_t step;  // phase increment per sample
+} NCO_t;
+
+void NCO_Init(NCO_t *nco);
+uint32_t NCO_Step(uint32_t freq, uint32_t sample_rate);
+void NCO_SetFreq(NCO_t *nco, uint32_t freq, uint32_t sample_rate);
+int16_t NCO_Sine(uint32_t phase);
+void NCO_Render(NCO_t *nco, int16_t *output, size_t len, int16_t amplitude);
+
+#endif
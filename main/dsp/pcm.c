@@ -0,0 +1,68 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include "pcm.h"
+
+/// @brief Check whether the sample format can be converted
+/// @param bits bits per sample, 8 (unsigned), 16, 24 or 32 (signed)
+/// @param channels amount of interleaved channels
+/// @return true if PCM_ToMono16 handles the format
+bool PCM_Supported(uint16_t bits, uint16_t channels)
+{
+    return (bits == 8 || bits == 16 || bits == 24 || bits == 32) && channels >= 1 && channels <= PCM_MAX_CHANNELS;
+}
+
+// Read little endian sample as 16-bit, wider samples keep their upper bits
+static int32_t PCM_Sample(const uint8_t *data, uint16_t bits)
+{
+    switch (bits)
+    {
+    case 8:
+        // 8-bit wav samples are unsigned
+        return ((int32_t)data[0] - 128) << 8;
+    case 16:
+        return (int16_t)(data[0] | data[1] << 8);
+    case 24:
+        return (int16_t)(data[1] | data[2] << 8);
+    default:
+        return (int16_t)(data[2] | data[3] << 8);
+    }
+}
+
+/// @brief Convert interleaved little endian PCM frames to 16-bit mono, channels are averaged
+/// @param data interleaved frames as stored in wav files
+/// @param frames amount of frames
+/// @param bits bits per sample, see PCM_Supported
+/// @param channels amount of channels
+/// @param output output buffer, fits frames samples, can be the same as data for 16-bit or wider samples
+void PCM_ToMono16(const uint8_t *data, size_t frames, uint16_t bits, uint16_t channels, int16_t *output)
+{
+    const size_t width = bits / 8;
+
+    for (size_t i = 0; i < frames; i++)
+    {
+        int32_t sum = 0;
+
+        for (uint16_t c = 0; c < channels; c++)
+        {
+            sum += PCM_Sample(data, bits);
+            data += width;
+        }
+
+        output[i] = sum / channels;
+    }
+}
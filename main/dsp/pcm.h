@@ -0,0 +1,31 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef DSP_PCM_H
+#define DSP_PCM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Define max amount of channels of interleaved PCM data
+#define PCM_MAX_CHANNELS 8
+
+bool PCM_Supported(uint16_t bits, uint16_t channels);
+void PCM_ToMono16(const uint8_t *data, size_t frames, uint16_t bits, uint16_t channels, int16_t *output);
+
+#endif
@@ -0,0 +1,95 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "peaks.h"
+#include "helper/misc.h"
+
+// Store the current peak and start the next one
+static void PEAKS_Push(PEAKS_t *peaks)
+{
+    peaks->data[peaks->len++] = peaks->min >> 8;
+    peaks->data[peaks->len++] = peaks->max >> 8;
+    peaks->count = 0;
+    peaks->min = INT16_MAX;
+    peaks->max = INT16_MIN;
+}
+
+/// @brief Initialize peaks
+/// @param peaks pointer to peaks
+/// @param per_peak amount of samples covered by a single peak
+void PEAKS_Init(PEAKS_t *peaks, uint16_t per_peak)
+{
+    peaks->per_peak = MAX(per_peak, 1);
+    peaks->count = 0;
+    peaks->min = INT16_MAX;
+    peaks->max = INT16_MIN;
+    peaks->len = 0;
+}
+
+/// @brief Track samples, stops once the buffer is full
+/// @param peaks pointer to peaks
+/// @param samples samples to track
+/// @param len amount of samples
+/// @return amount of samples consumed, less than len if the buffer has to be cleared first
+size_t PEAKS_Process(PEAKS_t *peaks, const int16_t *samples, size_t len)
+{
+    size_t i = 0;
+
+    while (i < len && !PEAKS_Full(peaks))
+    {
+        const size_t end = i + MIN(len - i, (size_t)(peaks->per_peak - peaks->count));
+
+        peaks->count += end - i;
+
+        for (; i < end; i++)
+        {
+            peaks->min = MIN(peaks->min, samples[i]);
+            peaks->max = MAX(peaks->max, samples[i]);
+        }
+
+        if (peaks->count == peaks->per_peak)
+        {
+            PEAKS_Push(peaks);
+        }
+    }
+
+    return i;
+}
+
+/// @brief Store the unfinished peak, i.e. at the end of the recording
+/// @param peaks pointer to peaks, the buffer must not be full
+void PEAKS_Finish(PEAKS_t *peaks)
+{
+    if (peaks->count > 0 && !PEAKS_Full(peaks))
+    {
+        PEAKS_Push(peaks);
+    }
+}
+
+/// @brief Check if the buffer has to be cleared before tracking further samples
+/// @param peaks pointer to peaks
+/// @return true if the buffer is full
+bool PEAKS_Full(const PEAKS_t *peaks)
+{
+    return peaks->len + 2 > PEAKS_BUFFER_SIZE;
+}
+
+/// @brief Drop the finished peaks once they are saved
+/// @param peaks pointer to peaks
+void PEAKS_Clear(PEAKS_t *peaks)
+{
+    peaks->len = 0;
+}
@@ -0,0 +1,45 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_PEAKS_H
+#define DSP_PEAKS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Define size of the peaks buffer in bytes, each peak takes a min and a max byte
+#define PEAKS_BUFFER_SIZE 64
+
+// Min/max envelope of the audio, a peak covers a fixed amount of samples.
+// Values keep the upper byte of the sample, that is plenty to draw a waveform.
+typedef struct
+{
+    uint16_t per_peak;               // samples covered by a single peak
+    uint16_t count;                  // samples in the current peak
+    int16_t min;                     // lowest sample of the current peak
+    int16_t max;                     // highest sample of the current peak
+    int8_t data[PEAKS_BUFFER_SIZE];  // finished peaks as min, max pairs
+    size_t len;                      // amount of bytes in data
+} PEAKS_t;
+
+void PEAKS_Init(PEAKS_t *peaks, uint16_t per_peak);
+size_t PEAKS_Process(PEAKS_t *peaks, const int16_t *samples, size_t len);
+void PEAKS_Finish(PEAKS_t *peaks);
+bool PEAKS_Full(const PEAKS_t *peaks);
+void PEAKS_Clear(PEAKS_t *peaks);
+
+#endif
@@ -0,0 +1,72 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "pipeline.h"
+
+/// @brief Initialize empty pipeline
+/// @param pipeline pointer to pipeline
+/// @param clock free running counter used to measure stage cost
+void PIPELINE_Init(PIPELINE_t *pipeline, uint32_t (*clock)(void))
+{
+    pipeline->len = 0;
+    pipeline->clock = clock;
+}
+
+/// @brief Append stage to the end of the pipeline
+/// @param pipeline pointer to pipeline
+/// @param name stage name used for diagnostics
+/// @param process block processing function
+/// @param state preallocated stage state passed to the process function
+/// @return false if the pipeline is full
+bool PIPELINE_Add(PIPELINE_t *pipeline, const char *name, PIPELINE_Process_t process, void *state)
+{
+    if (pipeline->len >= PIPELINE_MAX_STAGES)
+        return false;
+
+    PIPELINE_Stage_t *stage = &pipeline->stages[pipeline->len];
+
+    stage->name = name;
+    stage->process = process;
+    stage->state = state;
+    stage->blocks = 0;
+    stage->cycles = 0;
+
+    pipeline->len++;
+
+    return true;
+}
+
+/// @brief Run block of samples through all the stages in order, in place
+/// @param pipeline pointer to pipeline
+/// @param samples samples to process
+/// @param len amount of samples
+void PIPELINE_Process(PIPELINE_t *pipeline, int16_t *samples, size_t len)
+{
+    uint32_t start = pipeline->clock();
+
+    for (uint8_t i = 0; i < pipeline->len; i++)
+    {
+        PIPELINE_Stage_t *stage = &pipeline->stages[i];
+
+        stage->process(stage->state, samples, len);
+
+        const uint32_t end = pipeline->clock();
+
+        stage->blocks++;
+        stage->cycles += end - start;
+        start = end;
+    }
+}
@@ -0,0 +1,52 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_PIPELINE_H
+#define DSP_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Define max amount of stages in a single pipeline
+#define PIPELINE_MAX_STAGES 8
+
+// Processes block of samples in place
+typedef void (*PIPELINE_Process_t)(void *state, int16_t *samples, size_t len);
+
+// Single processing stage with its cost
+typedef struct
+{
+    const char *name;           // stage name used for diagnostics
+    PIPELINE_Process_t process; // block processing function
+    void *state;                // preallocated stage state passed to the process function
+    uint32_t blocks;            // amount of blocks processed
+    uint64_t cycles;            // clock ticks spent processing
+} PIPELINE_Stage_t;
+
+// Ordered list of block processing stages
+typedef struct
+{
+    PIPELINE_Stage_t stages[PIPELINE_MAX_STAGES];
+    uint8_t len;             // amount of stages
+    uint32_t (*clock)(void); // free running counter used to measure stage cost, i.e. CPU cycle counter
+} PIPELINE_t;
+
+void PIPELINE_Init(PIPELINE_t *pipeline, uint32_t (*clock)(void));
+bool PIPELINE_Add(PIPELINE_t *pipeline, const char *name, PIPELINE_Process_t process, void *state);
+void PIPELINE_Process(PIPELINE_t *pipeline, int16_t *samples, size_t len);
+
+#endif
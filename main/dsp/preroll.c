@@ -0,0 +1,92 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "preroll.h"
+#include "helper/misc.h"
+
+// Reverse samples in place
+static void reverse(int16_t *samples, size_t len)
+{
+    for (size_t i = 0, j = len - 1; i < j; i++, j--)
+    {
+        SWAP(samples[i], samples[j]);
+    }
+}
+
+/// @brief Initialize pre-roll store
+/// @param preroll pointer to pre-roll
+/// @param samples storage, i.e. allocated in PSRAM
+/// @param capacity storage size in samples
+void PREROLL_Init(PREROLL_t *preroll, int16_t *samples, size_t capacity)
+{
+    preroll->samples = samples;
+    preroll->capacity = capacity;
+    PREROLL_Reset(preroll);
+}
+
+/// @brief Drop all the stored samples
+/// @param preroll pointer to pre-roll
+void PREROLL_Reset(PREROLL_t *preroll)
+{
+    preroll->pos = 0;
+    preroll->len = 0;
+}
+
+/// @brief Store samples, overwriting the oldest ones once full
+/// @param preroll pointer to pre-roll
+/// @param samples samples to store
+/// @param len amount of samples
+void PREROLL_Push(PREROLL_t *preroll, const int16_t *samples, size_t len)
+{
+    if (preroll->capacity == 0)
+        return;
+
+    // Only the most recent samples fit
+    if (len > preroll->capacity)
+    {
+        samples += len - preroll->capacity;
+        len = preroll->capacity;
+    }
+
+    size_t first = MIN(len, preroll->capacity - preroll->pos);
+
+    memcpy(&preroll->samples[preroll->pos], samples, first * sizeof(int16_t));
+    memcpy(preroll->samples, &samples[first], (len - first) * sizeof(int16_t));
+
+    preroll->pos = (preroll->pos + len) % preroll->capacity;
+    preroll->len = MIN(preroll->len + len, preroll->capacity);
+}
+
+/// @brief Rotate stored samples in place so they start at the beginning of the storage, oldest first
+// It allows to write the whole pre-roll in one go without extra buffer
+/// @param preroll pointer to pre-roll
+/// @return amount of samples stored from preroll->samples
+size_t PREROLL_Linearize(PREROLL_t *preroll)
+{
+    // Storage is only wrapped once it is full
+    if (preroll->len == preroll->capacity && preroll->pos != 0)
+    {
+        reverse(preroll->samples, preroll->pos);
+        reverse(&preroll->samples[preroll->pos], preroll->capacity - preroll->pos);
+        reverse(preroll->samples, preroll->capacity);
+    }
+
+    preroll->pos = preroll->len % preroll->capacity;
+
+    return preroll->len;
+}
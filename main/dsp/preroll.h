@@ -0,0 +1,37 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_PREROLL_H
+#define DSP_PREROLL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Circular store of the most recent samples
+typedef struct
+{
+    int16_t *samples; // storage provided by the caller
+    size_t capacity;  // storage size in samples
+    size_t pos;       // position of the next sample
+    size_t len;       // amount of stored samples
+} PREROLL_t;
+
+void PREROLL_Init(PREROLL_t *preroll, int16_t *samples, size_t capacity);
+void PREROLL_Reset(PREROLL_t *preroll);
+void PREROLL_Push(PREROLL_t *preroll, const int16_t *samples, size_t len);
+size_t PREROLL_Linearize(PREROLL_t *preroll);
+
+#endif
@@ -0,0 +1,244 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "resampler.h"
+#include "helper/misc.h"
+
+// Define Kaiser window shape of both filters, about 70 dB of stopband rejection, see sim/resample.c
+#define RESAMPLER_KAISER_BETA 7.0f
+// Define cutoff as a fraction of the lower Nyquist frequency, the rest is the transition band
+#define RESAMPLER_CUTOFF 0.9f
+// Define center tap of the half-band filter
+#define RESAMPLER_HALFBAND_CENTER (RESAMPLER_HALFBAND_TAPS / 2)
+
+// Greatest common divisor
+static uint32_t RESAMPLER_Gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0)
+    {
+        const uint32_t t = a % b;
+
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+// Modified Bessel function of the first kind, order 0, for the Kaiser window
+static float RESAMPLER_BesselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+
+    for (uint8_t k = 1; k < 20; k++)
+    {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+// Kaiser windowed sinc half-band lowpass, only the odd distance taps of one side are kept, the center one is 0.5
+static void RESAMPLER_HalfbandInit(RESAMPLER_t *resampler)
+{
+    const float window_norm = RESAMPLER_BesselI0(RESAMPLER_KAISER_BETA);
+    float sum = 0;
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(resampler->halfband_coeffs); i++)
+    {
+        const float k = 2 * i + 1;
+        const float r = k / RESAMPLER_HALFBAND_CENTER;
+        const float window = RESAMPLER_BesselI0(RESAMPLER_KAISER_BETA * sqrtf(1.0f - r * r)) / window_norm;
+
+        resampler->halfband_coeffs[i] = sinf(CONST_PI * k / 2) / (CONST_PI * k) * window;
+        sum += resampler->halfband_coeffs[i];
+    }
+
+    // Unity DC gain, both sides add up to the other half
+    for (uint8_t i = 0; i < ARRAY_SIZE(resampler->halfband_coeffs); i++)
+    {
+        resampler->halfband_coeffs[i] *= 0.25f / sum;
+    }
+
+    memset(resampler->halfband, 0, sizeof(resampler->halfband));
+}
+
+// Run sample through the half-band stages
+// Returns false if it was absorbed by a stage, otherwise the sample is replaced by the decimated one
+static bool RESAMPLER_Decimate(RESAMPLER_t *resampler, float *sample)
+{
+    for (uint8_t s = 0; s < resampler->stages; s++)
+    {
+        RESAMPLER_Halfband_t *stage = &resampler->halfband[s];
+
+        stage->head = (stage->head + 1) % RESAMPLER_HALFBAND_TAPS;
+        stage->history[stage->head] = *sample;
+        stage->history[stage->head + RESAMPLER_HALFBAND_TAPS] = *sample;
+        stage->odd = !stage->odd;
+
+        // Every other sample makes an output
+        if (stage->odd)
+            return false;
+
+        // Newest sample first, the center one lies RESAMPLER_HALFBAND_CENTER samples back
+        const float *center = &stage->history[stage->head + RESAMPLER_HALFBAND_TAPS - RESAMPLER_HALFBAND_CENTER];
+        float sum = 0.5f * center[0];
+
+        for (uint8_t i = 0; i < ARRAY_SIZE(resampler->halfband_coeffs); i++)
+        {
+            sum += resampler->halfband_coeffs[i] * (center[-(2 * i + 1)] + center[2 * i + 1]);
+        }
+
+        *sample = sum;
+    }
+
+    return true;
+}
+
+/// @brief Initialize resampler and compute its filter bank
+/// @param resampler pointer to resampler
+/// @param input_rate input sample rate in Hz
+/// @param output_rate output sample rate in Hz
+/// @return false if a rate is out of the supported range
+bool RESAMPLER_Init(RESAMPLER_t *resampler, uint32_t input_rate, uint32_t output_rate)
+{
+    if (input_rate < RESAMPLER_MIN_RATE || input_rate > RESAMPLER_MAX_RATE ||
+        output_rate < RESAMPLER_MIN_RATE || output_rate > RESAMPLER_MAX_RATE)
+        return false;
+
+    // Halve the input until the polyphase filter has at most 2:1 to reject
+    resampler->stages = 0;
+
+    while (resampler->stages < RESAMPLER_MAX_STAGES && input_rate > (output_rate << (resampler->stages + 1)))
+    {
+        resampler->stages++;
+    }
+
+    RESAMPLER_HalfbandInit(resampler);
+
+    // Ratio of the halved input stays exact for odd rates, the output rate is doubled instead
+    const uint32_t scaled_output_rate = output_rate << resampler->stages;
+    const uint32_t gcd = RESAMPLER_Gcd(input_rate, scaled_output_rate);
+    // Cutoff in cycles per polyphase input sample, below the Nyquist frequency of the lower rate
+    const float cutoff = 0.5f * RESAMPLER_CUTOFF * MIN(input_rate, scaled_output_rate) / input_rate;
+    const float center = RESAMPLER_TAPS / 2;
+    const float window_norm = RESAMPLER_BesselI0(RESAMPLER_KAISER_BETA);
+
+    resampler->up = scaled_output_rate / gcd;
+    resampler->down = input_rate / gcd;
+    resampler->position = 0;
+    resampler->head = 0;
+    memset(resampler->history, 0, sizeof(resampler->history));
+
+    for (uint16_t p = 0; p <= RESAMPLER_PHASES; p++)
+    {
+        const float frac = (float)p / RESAMPLER_PHASES;
+        float sum = 0;
+
+        // Tap j weighs the input j samples older than the newest one, the output lies center - frac samples back
+        for (uint8_t j = 0; j < RESAMPLER_TAPS; j++)
+        {
+            const float t = j - center + frac;
+            const float x = 2.0f * cutoff * t;
+            const float sinc = (fabsf(x) < 1e-6f) ? 1.0f : sinf(CONST_PI * x) / (CONST_PI * x);
+            const float r = t / center;
+            const float window = (fabsf(r) < 1.0f) ? RESAMPLER_BesselI0(RESAMPLER_KAISER_BETA * sqrtf(1.0f - r * r)) / window_norm : 0.0f;
+
+            resampler->coeffs[p][j] = sinc * window;
+            sum += resampler->coeffs[p][j];
+        }
+
+        // Unity DC gain at every phase, so there is no ripple at the rate difference
+        for (uint8_t j = 0; j < RESAMPLER_TAPS; j++)
+        {
+            resampler->coeffs[p][j] /= sum;
+        }
+    }
+
+    return true;
+}
+
+/// @brief Resample block of samples, stops when the output is full or the input is used up
+/// @param resampler pointer to resampler
+/// @param input input samples
+/// @param len amount of input samples
+/// @param consumed set to the amount of input samples used, call again with the rest
+/// @param output output buffer
+/// @param max size of the output buffer
+/// @return amount of output samples
+size_t RESAMPLER_Process(RESAMPLER_t *resampler, const int16_t *input, size_t len, size_t *consumed, int16_t *output, size_t max)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    // Same rates, nothing to filter
+    if (resampler->up == resampler->down)
+    {
+        out = MIN(len, max);
+        memmove(output, input, out * sizeof(int16_t));
+        *consumed = out;
+        return out;
+    }
+
+    while (out < max)
+    {
+        // Move the window until the output lies within the newest input sample interval
+        while (resampler->position >= resampler->up)
+        {
+            if (in == len)
+                goto Done;
+
+            float sample = input[in++];
+
+            if (!RESAMPLER_Decimate(resampler, &sample))
+                continue;
+
+            resampler->head = (resampler->head + 1) % RESAMPLER_TAPS;
+            resampler->history[resampler->head] = sample;
+            resampler->history[resampler->head + RESAMPLER_TAPS] = sample;
+            resampler->position -= resampler->up;
+        }
+
+        // Interpolate the coefficients between the two nearest phases
+        const float phase = (float)resampler->position * RESAMPLER_PHASES / resampler->up;
+        const uint16_t p = (uint16_t)phase;
+        const float frac = phase - p;
+        const float *a = resampler->coeffs[p];
+        const float *b = resampler->coeffs[p + 1];
+        // Newest sample first
+        const float *window = &resampler->history[resampler->head + RESAMPLER_TAPS];
+        float sum = 0;
+
+        for (uint8_t j = 0; j < RESAMPLER_TAPS; j++)
+        {
+            sum += window[-j] * (a[j] + (b[j] - a[j]) * frac);
+        }
+
+        output[out++] = (int16_t)MIN(MAX(sum, INT16_MIN), INT16_MAX);
+        resampler->position += resampler->down;
+    }
+
+Done:
+    *consumed = in;
+
+    return out;
+}
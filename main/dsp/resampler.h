@@ -0,0 +1,64 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef DSP_RESAMPLER_H
+#define DSP_RESAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Define FIR taps per phase, the lowpass spans this many input samples
+#define RESAMPLER_TAPS 32
+// Define amount of precomputed filter phases, coefficients in between are interpolated
+#define RESAMPLER_PHASES 64
+// Define supported input and output rates
+#define RESAMPLER_MIN_RATE 4000
+#define RESAMPLER_MAX_RATE 192000
+// Define half-band FIR length, must be 4n - 1 so every other tap but the center one is zero
+#define RESAMPLER_HALFBAND_TAPS 31
+// Define max amount of half-band decimate by 2 stages, enough for RESAMPLER_MAX_RATE down to RESAMPLER_MIN_RATE
+#define RESAMPLER_MAX_STAGES 5
+
+// Decimate by 2 stage in front of the polyphase filter, its taps cannot reject much at large rate ratios
+typedef struct
+{
+    float history[RESAMPLER_HALFBAND_TAPS * 2]; // input history stored twice so the FIR window is always contiguous
+    uint8_t head;                               // position of the newest sample in the history
+    bool odd;                                   // whether the newest sample is the first one of the pair
+} RESAMPLER_Halfband_t;
+
+// Rational resampler, output rate / input rate = up / down
+// Output time advances by down / up input samples exactly, the polyphase lowpass is picked by the fractional position.
+// Inputs above twice the output rate are halved by the half-band stages first.
+typedef struct
+{
+    uint32_t up;          // output rate divided by the common divisor of the rates
+    uint32_t down;        // input rate after the half-band stages divided by the common divisor of the rates
+    uint8_t stages;       // amount of half-band stages in use
+    RESAMPLER_Halfband_t halfband[RESAMPLER_MAX_STAGES];
+    float halfband_coeffs[(RESAMPLER_HALFBAND_TAPS + 1) / 4]; // nonzero taps of one side, nearest to the center first
+    uint32_t position;    // position of the next output past the newest input, in 1/up input samples
+    uint8_t head;         // position of the newest sample in the history
+    float coeffs[RESAMPLER_PHASES + 1][RESAMPLER_TAPS]; // windowed sinc lowpass per phase, the extra one is for interpolation
+    float history[RESAMPLER_TAPS * 2]; // input history stored twice so the FIR window is always contiguous
+} RESAMPLER_t;
+
+bool RESAMPLER_Init(RESAMPLER_t *resampler, uint32_t input_rate, uint32_t output_rate);
+size_t RESAMPLER_Process(RESAMPLER_t *resampler, const int16_t *input, size_t len, size_t *consumed, int16_t *output, size_t max);
+
+#endif
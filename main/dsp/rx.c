@@ -0,0 +1,148 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "rx.h"
+#include "helper/misc.h"
+#include "helper/telemetry.h"
+
+/// @brief Unpack ADC results of single chunk into samples, in place
+/// @param chunk ADC results, aligned to int16_t
+/// @param chunk_bytes size of the chunk in bytes
+/// @param channel_num amount of channels of the ADC unit, results of other channels are invalid
+/// @return amount of valid samples from the beginning of the chunk
+size_t RX_Unpack(uint8_t *chunk, size_t chunk_bytes, uint32_t channel_num)
+{
+    adc_digi_output_data_t *p;
+    int16_t *samples = (int16_t *)chunk;
+    size_t count = 0;
+
+    for (size_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= chunk_bytes; i += SOC_ADC_DIGI_RESULT_BYTES)
+    {
+        p = (adc_digi_output_data_t *)&chunk[i];
+
+        // Check the channel number validation, the data is invalid if the channel num exceed the maximum channel
+        if (RX_ADC_GET_CHANNEL(p) < channel_num)
+        {
+            // Sample never lands after the result being read, so it is safe to write in place
+            samples[count++] = (int16_t)RX_ADC_GET_DATA(p);
+        }
+        else
+        {
+            TELEMETRY_Count(TELEMETRY_COUNTER_ADC_INVALID_SAMPLES, 1);
+        }
+    }
+
+    return count;
+}
+
+/// @brief Initialize ingest, decimator is initialized separately as it depends on ADC configuration
+/// @param ingest pointer to ingest
+/// @param dc_shift DC tracker time constant as a power of 2 of blocks
+/// @param attack_blocks consecutive blocks over threshold needed to open the squelch
+/// @param hang_samples samples under threshold needed to close the squelch
+/// @param clock free running counter used to measure stage cost
+void RX_IngestInit(RX_Ingest_t *ingest, uint8_t dc_shift, uint8_t attack_blocks, uint32_t hang_samples, uint32_t (*clock)(void))
+{
+    DC_Init(&ingest->dc, dc_shift);
+    SQUELCH_Init(&ingest->squelch, attack_blocks, hang_samples);
+    ingest->clock = clock;
+}
+
+/// @brief Decimate unpacked ADC samples, remove DC bias and update the squelch
+/// @param ingest pointer to ingest
+/// @param input unpacked ADC samples
+/// @param len amount of input samples
+/// @param output centered samples, can point to the input
+/// @param output_len amount of output samples
+/// @param squelch_level squelch threshold as percentage of the silent input value
+/// @return squelch transition caused by the block
+SQUELCH_Event_t RX_IngestProcess(RX_Ingest_t *ingest, const int16_t *input, size_t len, int16_t *output, size_t *output_len, uint8_t squelch_level)
+{
+    const uint32_t cycles_start = ingest->clock();
+
+    *output_len = DECIMATOR_Process(&ingest->decimator, input, len, output);
+
+    const uint32_t cycles_decimate = ingest->clock();
+
+    // Track DC mostly while the squelch is closed, so received signal does not pull the estimate,
+    // the slow tracking while open recovers from an offset that keeps the squelch open
+    DC_Process(&ingest->dc, output, *output_len, ingest->squelch.open);
+
+    const uint32_t cycles_dc = ingest->clock();
+
+    // Samples are already centered
+    const int16_t threshold = (DC_Value(&ingest->dc) * squelch_level) / 100;
+    SQUELCH_Event_t event = SQUELCH_Update(&ingest->squelch, output, *output_len, 0, threshold);
+
+    const uint32_t cycles_squelch = ingest->clock();
+
+    TELEMETRY_Record(TELEMETRY_STAGE_DECIMATE, cycles_decimate - cycles_start);
+    TELEMETRY_Record(TELEMETRY_STAGE_DC, cycles_dc - cycles_decimate);
+    TELEMETRY_Record(TELEMETRY_STAGE_SQUELCH, cycles_squelch - cycles_dc);
+
+    return event;
+}
+
+// Pipeline stages, adapt DSP blocks to PIPELINE_Process_t
+static void RX_StageAgc(void *state, int16_t *samples, size_t len)
+{
+    AGC_Process((AGC_t *)state, samples, len);
+}
+
+static void RX_StageFilter(void *state, int16_t *samples, size_t len)
+{
+    FILTER_Process((FILTER_BiquadFilter_t *)state, samples, len);
+}
+
+// Amplify a bit between filtering to prevent filtering distortions
+static void RX_StageDouble(void *state, int16_t *samples, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        samples[i] = MAX(MIN(samples[i] * 2, INT16_MAX), INT16_MIN);
+    }
+}
+
+/// @brief Build recorder processing chain
+/// @param pipeline pointer to pipeline
+/// @param clock free running counter used to measure stage cost
+/// @param agc AGC state, NULL leaves the AGC out
+/// @param filters filter state, NULL leaves the filters out
+/// @param sample_rate sample rate in Hz
+void RX_PipelineBuild(PIPELINE_t *pipeline, uint32_t (*clock)(void), AGC_t *agc, RX_Filters_t *filters, uint32_t sample_rate)
+{
+    PIPELINE_Init(pipeline, clock);
+
+    if (agc != NULL)
+    {
+        // Amplify signal using AGC (clipping prevention built-in)
+        PIPELINE_Add(pipeline, "agc", RX_StageAgc, agc);
+    }
+
+    if (filters != NULL)
+    {
+        FILTER_Init(&filters->hp_filter, RX_FILTER_HPF_FREQ, sample_rate, FILTER_HIGHPASS, 0.6);
+        FILTER_Init(&filters->lp_filter_1, RX_FILTER_LPF_1_FREQ, sample_rate, FILTER_LOWPASS, 0.25);
+        FILTER_Init(&filters->lp_filter_2, RX_FILTER_LPF_2_FREQ, sample_rate, FILTER_LOWPASS, 0.40);
+        FILTER_Init(&filters->lp_filter_3, RX_FILTER_LPF_3_FREQ, sample_rate, FILTER_LOWPASS, 0.40);
+
+        PIPELINE_Add(pipeline, "hpf", RX_StageFilter, &filters->hp_filter);
+        PIPELINE_Add(pipeline, "lpf_1", RX_StageFilter, &filters->lp_filter_1);
+        PIPELINE_Add(pipeline, "lpf_2", RX_StageFilter, &filters->lp_filter_2);
+        PIPELINE_Add(pipeline, "double", RX_StageDouble, NULL);
+        PIPELINE_Add(pipeline, "lpf_3", RX_StageFilter, &filters->lp_filter_3);
+    }
+}
@@ -0,0 +1,76 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_RX_H
+#define DSP_RX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sdkconfig.h>
+#include <hal/adc_types.h>
+#include <soc/soc_caps.h>
+
+#include "decimator.h"
+#include "dc.h"
+#include "squelch.h"
+#include "agc.h"
+#include "filter.h"
+#include "pipeline.h"
+
+// Receive path shared by the firmware and the host simulator
+
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define RX_ADC_GET_CHANNEL(p_data)     ((p_data)->type1.channel)
+#define RX_ADC_GET_DATA(p_data)        ((p_data)->type1.data)
+#else
+#define RX_ADC_GET_CHANNEL(p_data)     ((p_data)->type2.channel)
+#define RX_ADC_GET_DATA(p_data)        ((p_data)->type2.data)
+#endif
+
+// Define 1st order lowpass filter cutoff frequency
+#define RX_FILTER_LPF_1_FREQ 4600
+// Define 2nd order lowpass filter cutoff frequency
+#define RX_FILTER_LPF_2_FREQ 2300
+// Define 3rd order lowpass filter cutoff frequency
+#define RX_FILTER_LPF_3_FREQ 2000
+// Define highpass filter cutoff frequency
+#define RX_FILTER_HPF_FREQ 300
+
+// Ingest of ADC chunks into centered blocks of samples with squelch decision
+typedef struct
+{
+    DECIMATOR_t decimator;   // filters oversampled ADC input down to the audio sample rate
+    DC_t dc;                 // removes DC bias from the input
+    SQUELCH_t squelch;       // driven by the energy of the blocks
+    uint32_t (*clock)(void); // free running counter used to measure stage cost, i.e. CPU cycle counter
+} RX_Ingest_t;
+
+// Recorder filter state, preallocated so the pipeline can be rebuilt at runtime
+typedef struct
+{
+    FILTER_BiquadFilter_t hp_filter;
+    FILTER_BiquadFilter_t lp_filter_1;
+    FILTER_BiquadFilter_t lp_filter_2;
+    FILTER_BiquadFilter_t lp_filter_3;
+} RX_Filters_t;
+
+size_t RX_Unpack(uint8_t *chunk, size_t chunk_bytes, uint32_t channel_num);
+void RX_IngestInit(RX_Ingest_t *ingest, uint8_t dc_shift, uint8_t attack_blocks, uint32_t hang_samples, uint32_t (*clock)(void));
+SQUELCH_Event_t RX_IngestProcess(RX_Ingest_t *ingest, const int16_t *input, size_t len, int16_t *output, size_t *output_len, uint8_t squelch_level);
+void RX_PipelineBuild(PIPELINE_t *pipeline, uint32_t (*clock)(void), AGC_t *agc, RX_Filters_t *filters, uint32_t sample_rate);
+
+#endif
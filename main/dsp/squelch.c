@@ -0,0 +1,135 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include "squelch.h"
+
+// Integer square root
+static uint32_t isqrt(uint32_t value)
+{
+    uint32_t result = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return result;
+}
+
+/// @brief Initialize squelch
+/// @param squelch pointer to squelch
+/// @param attack_blocks consecutive blocks over threshold needed to open the squelch
+/// @param hang_samples samples under threshold needed to close the squelch
+void SQUELCH_Init(SQUELCH_t *squelch, uint8_t attack_blocks, uint32_t hang_samples)
+{
+    squelch->attack_blocks = attack_blocks;
+    squelch->hang_samples = hang_samples;
+    SQUELCH_Reset(squelch);
+}
+
+/// @brief Close the squelch without reporting the event, i.e. when the input stops
+/// @param squelch pointer to squelch
+void SQUELCH_Reset(SQUELCH_t *squelch)
+{
+    squelch->open = false;
+    squelch->over_blocks = 0;
+    squelch->under_samples = 0;
+    squelch->peak = 0;
+    squelch->rms = 0;
+}
+
+/// @brief Measure peak and RMS level of the block and update squelch state
+// Peak level is compared against the threshold, so single sample over the threshold counts as in the old squelch
+/// @param squelch pointer to squelch
+/// @param samples block of samples
+/// @param len amount of samples
+/// @param center value of the silent input (DC offset)
+/// @param threshold deviation from the center needed to open the squelch
+/// @return squelch state transition caused by the block
+SQUELCH_Event_t SQUELCH_Update(SQUELCH_t *squelch, const int16_t *samples, size_t len, int16_t center, int16_t threshold)
+{
+    int32_t peak = 0;
+    uint64_t sum_squares = 0;
+
+    if (len == 0)
+        return SQUELCH_EVENT_NONE;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        int32_t deviation = abs((int32_t)samples[i] - center);
+
+        if (deviation > peak)
+            peak = deviation;
+
+        sum_squares += (uint32_t)(deviation * deviation);
+    }
+
+    squelch->peak = (int16_t)(peak > INT16_MAX ? INT16_MAX : peak);
+    squelch->rms = (int16_t)isqrt((uint32_t)(sum_squares / len));
+
+    if (!squelch->open)
+    {
+        if (squelch->peak > threshold)
+        {
+            if (++squelch->over_blocks >= squelch->attack_blocks)
+            {
+                squelch->open = true;
+                squelch->over_blocks = 0;
+                squelch->under_samples = 0;
+                return SQUELCH_EVENT_OPEN;
+            }
+        }
+        else
+        {
+            squelch->over_blocks = 0;
+        }
+    }
+    else
+    {
+        if (squelch->peak > (threshold * SQUELCH_CLOSE_THRESHOLD_PERCENT) / 100)
+        {
+            squelch->under_samples = 0;
+        }
+        else
+        {
+            squelch->under_samples += len;
+
+            if (squelch->under_samples >= squelch->hang_samples)
+            {
+                squelch->open = false;
+                squelch->under_samples = 0;
+                return SQUELCH_EVENT_CLOSE;
+            }
+        }
+    }
+
+    return SQUELCH_EVENT_NONE;
+}
@@ -0,0 +1,50 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_SQUELCH_H
+#define DSP_SQUELCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Determine close threshold as percentage of the open threshold (hysteresis)
+#define SQUELCH_CLOSE_THRESHOLD_PERCENT 75
+
+typedef enum
+{
+    SQUELCH_EVENT_NONE,
+    SQUELCH_EVENT_OPEN,
+    SQUELCH_EVENT_CLOSE
+} SQUELCH_Event_t;
+
+// Block based squelch with attack and hang time
+typedef struct
+{
+    bool open;              // current squelch state
+    uint8_t attack_blocks;  // consecutive blocks over threshold needed to open
+    uint32_t hang_samples;  // samples under threshold needed to close
+    uint8_t over_blocks;    // consecutive blocks over threshold
+    uint32_t under_samples; // samples under threshold since last block over threshold
+    int16_t peak;           // peak deviation from center of the last block
+    int16_t rms;            // RMS deviation from center of the last block
+} SQUELCH_t;
+
+void SQUELCH_Init(SQUELCH_t *squelch, uint8_t attack_blocks, uint32_t hang_samples);
+void SQUELCH_Reset(SQUELCH_t *squelch);
+SQUELCH_Event_t SQUELCH_Update(SQUELCH_t *squelch, const int16_t *samples, size_t len, int16_t center, int16_t threshold);
+
+#endif
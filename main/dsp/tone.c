@@ -0,0 +1,122 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "tone.h"
+#include "helper/misc.h"
+
+/// @brief Start rendering a tone
+/// @param tone pointer to tone
+/// @param freq1 frequency in Hz, 0 for silence
+/// @param freq2 second frequency in Hz mixed at the same level, 0 if not used
+/// @param sample_rate sample rate in Hz
+/// @param len tone length in samples, TONE_ENDLESS never decays
+/// @param ramp length of the attack and decay ramps in samples, shortened to fit the tone
+/// @param amplitude peak sample value
+void TONE_Start(TONE_t *tone, uint16_t freq1, uint16_t freq2, uint32_t sample_rate, uint32_t len, uint32_t ramp, int16_t amplitude)
+{
+    const uint16_t freqs[2] = {freq1, freq2};
+
+    tone->count = 0;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (freqs[i] > 0)
+        {
+            NCO_Init(&tone->nco[tone->count]);
+            NCO_SetFreq(&tone->nco[tone->count], freqs[i], sample_rate);
+            tone->count++;
+        }
+    }
+
+    tone->amplitude = amplitude;
+    tone->len = len;
+    tone->ramp = (len == TONE_ENDLESS) ? ramp : MIN(ramp, len / 2);
+    tone->ramp_step = (tone->ramp > 0) ? (1UL << 30) / tone->ramp : 0;
+    tone->pos = 0;
+}
+
+// Raised cosine envelope of the sample, sin^2 over a quarter cycle rises from 0 to 1
+static int32_t TONE_Envelope(const TONE_t *tone, uint32_t pos)
+{
+    uint32_t distance;
+
+    if (pos < tone->ramp)
+    {
+        distance = pos;
+    }
+    else if (tone->len != TONE_ENDLESS && tone->len - pos <= tone->ramp)
+    {
+        distance = tone->len - pos - 1;
+    }
+    else
+    {
+        return INT16_MAX;
+    }
+
+    const int32_t sine = NCO_Sine(distance * tone->ramp_step);
+
+    return (sine * sine) >> 15;
+}
+
+/// @brief Render the next part of the tone
+/// @param tone pointer to tone
+/// @param output rendered samples
+/// @param len max amount of samples
+/// @return amount of samples rendered, less than len once the tone ends
+size_t TONE_Render(TONE_t *tone, int16_t *output, size_t len)
+{
+    if (tone->len != TONE_ENDLESS)
+    {
+        len = MIN(len, (size_t)(tone->len - tone->pos));
+    }
+
+    if (tone->count == 0)
+    {
+        memset(output, 0, len * sizeof(int16_t));
+        tone->pos += len;
+        return len;
+    }
+
+    for (size_t i = 0; i < len; i++)
+    {
+        int32_t sample = 0;
+
+        for (uint8_t j = 0; j < tone->count; j++)
+        {
+            sample += NCO_Sine(tone->nco[j].phase);
+            tone->nco[j].phase += tone->nco[j].step;
+        }
+
+        // Two frequencies share the amplitude
+        sample = (sample * tone->amplitude) >> (14 + tone->count);
+        output[i] = (sample * TONE_Envelope(tone, tone->pos + i)) >> 15;
+    }
+
+    // Endless tone keeps the envelope flat once the attack is over
+    tone->pos = (tone->len == TONE_ENDLESS) ? MIN(tone->pos + len, tone->ramp) : tone->pos + len;
+
+    return len;
+}
+
+/// @brief Check if the whole tone was rendered
+/// @param tone pointer to tone
+/// @return true once the tone ended
+bool TONE_Done(const TONE_t *tone)
+{
+    return tone->len != TONE_ENDLESS && tone->pos >= tone->len;
+}
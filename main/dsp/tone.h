@@ -0,0 +1,46 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef DSP_TONE_H
+#define DSP_TONE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "nco.h"
+
+// Define tone length which never ends, i.e. CTCSS
+#define TONE_ENDLESS UINT32_MAX
+
+// Tone of one or two frequencies (i.e. DTMF) shaped by raised cosine attack and decay ramps,
+// zero frequencies render silence
+typedef struct
+{
+    NCO_t nco[2];       // oscillator of each frequency
+    uint8_t count;      // amount of frequencies in use
+    int16_t amplitude;  // peak sample value
+    uint32_t len;       // tone length in samples
+    uint32_t ramp;      // length of the attack and decay ramps in samples
+    uint32_t ramp_step; // envelope phase increment, a quarter cycle per ramp
+    uint32_t pos;       // samples rendered so far
+} TONE_t;
+
+void TONE_Start(TONE_t *tone, uint16_t freq1, uint16_t freq2, uint32_t sample_rate, uint32_t len, uint32_t ramp, int16_t amplitude);
+size_t TONE_Render(TONE_t *tone, int16_t *output, size_t len);
+bool TONE_Done(const TONE_t *tone);
+
+#endif
@@ -16,18 +16,25 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <ctype.h>
 #include <math.h>
 #include <unistd.h>
+#include <stdlib.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <dirent.h>
+#include <stdatomic.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
 #include <pwm_audio.h>
 #include <esp_adc/adc_continuous.h>
 #include <esp_spiffs.h>
-#include <freertos/ringbuf.h>
 #include <driver/gpio.h>
 #include <esp_check.h>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
 #include <esp_log.h>
 
 #include "audio.h"
@@ -38,34 +45,55 @@
 #include "hardware/sd.h"
 #include "web/handlers/websocket.h"
 #include "helper/filesystem.h"
+#include "helper/telemetry.h"
 #include <dsp/agc.h>
-#ifdef AUDIO_RECORDER_FILTER_ENABLED
-#include "dsp/filter.h"
+#include "dsp/rx.h"
+#include "dsp/preroll.h"
+#include "dsp/adpcm.h"
+#include "dsp/decimator.h"
+#include "dsp/peaks.h"
+#include "dsp/afsk.h"
+#include "dsp/tone.h"
+#include "dsp/pcm.h"
+#include "dsp/resampler.h"
+#include "app/writer.h"
+#include "app/waveform.h"
+#if CONFIG_AUDIO_RECORDER_CODEC2
+#include <codec2.h>
 #endif
 
 static const char *TAG = "HW/AUDIO";
 
+static const char *audioRecordConsumerName = "recorder";
+
 static TaskHandle_t audioListenTaskHandle;
 
 EventGroupHandle_t audioEventGroup;
 
-// ADC ring buffer handle
-RingbufHandle_t adcRingBufferHandle;
+// Receive path processing chain applied by the recorder
+PIPELINE_t gAudioPipeline;
+
+// Audio input bus
+BUS_t gAudioBus;
 
 adc_unit_t audioAdcUnit;
 // ADC dropped frames count due to slow processing
 volatile u_int16_t adcDroppedFrames = 0;
 
-// Counts samples over squelch
-uint16_t samplesOverSquelch;
+// Decimates the input, removes DC bias so the audio bus carries centered samples and drives the squelch
+static RX_Ingest_t ingest;
+
+// Decoded blocks are written directly into the audio bus
+_Static_assert(AUDIO_INPUT_BLOCK_SIZE <= BUS_BLOCK_SIZE, "Audio input block does not fit into the audio bus block");
+_Static_assert(AUDIO_BUS_NOTIFY_INDEX < configTASK_NOTIFICATION_ARRAY_ENTRIES, "Audio bus notification index is not available");
 
 AudioState_t gAudioState;
 
 SemaphoreHandle_t gAudioStateSemaphore;
 // Guards audio output shared resource
 SemaphoreHandle_t transmitSemaphore;
-// Guards audio input shared resource
-SemaphoreHandle_t receiveSemaphore;
+// Set to make the playback in progress stop at the next block
+static atomic_bool playCancelled;
 // Auto Gain Control handle
 AGC_t agc;
 
@@ -80,131 +108,1055 @@ static void pwm_audio_apply_settings(void)
     pwm_audio_set_volume(adjusted_volume);
 }
 
-// Calibrate ADC by calculating mean value of the samples
-void AUDIO_AdcCalibrate(void *pvParameters)
+// Wake up audio bus consumer task, using its own notification so it does not mix with other ones the task gets
+static void AUDIO_BusNotify(void *waiter)
+{
+    xTaskNotifyGiveIndexed((TaskHandle_t)waiter, AUDIO_BUS_NOTIFY_INDEX);
+}
+
+/// @brief Subscribe calling task to the audio input bus
+/// @param name consumer name
+/// @return consumer or NULL if there are too many consumers
+BUS_Consumer_t *AUDIO_Subscribe(const char *name)
+{
+    BUS_Consumer_t *consumer = BUS_Subscribe(&gAudioBus, name, xTaskGetCurrentTaskHandle());
+
+    if (consumer == NULL)
+    {
+        ESP_LOGE(TAG, "Too many audio bus consumers, %s not subscribed.", name);
+    }
+
+    return consumer;
+}
+
+/// @brief Unsubscribe from the audio input bus
+/// @param consumer consumer returned by AUDIO_Subscribe
+void AUDIO_Unsubscribe(BUS_Consumer_t *consumer)
+{
+    if (consumer != NULL)
+    {
+        ESP_LOGI(TAG, "Consumer %s unsubscribed, overruns: %u", consumer->name, atomic_load(&consumer->overruns));
+    }
+
+    BUS_Unsubscribe(&gAudioBus, consumer);
+
+    // Calling task may be deleted right after, make sure the producer no longer holds its handle
+    while (BUS_Notifying(&gAudioBus))
+    {
+        vTaskDelay(1);
+    }
+}
+
+/// @brief Block until there is a new block for the consumer, call BUS_Release once done with it
+/// @param consumer consumer returned by AUDIO_Subscribe
+/// @param timeout_ms max time to wait for the block
+/// @return block or NULL on timeout
+const BUS_Block_t *AUDIO_WaitBlock(BUS_Consumer_t *consumer, uint32_t timeout_ms)
+{
+    const BUS_Block_t *block;
+
+    while ((block = BUS_Peek(&gAudioBus, consumer)) == NULL)
+    {
+        // Producer notifies every consumer after publishing a block
+        if (ulTaskNotifyTakeIndexed(AUDIO_BUS_NOTIFY_INDEX, pdTRUE, pdMS_TO_TICKS(timeout_ms)) == 0)
+        {
+            return BUS_Peek(&gAudioBus, consumer);
+        }
+    }
+
+    return block;
+}
+
+// Recorder filters, state is preallocated so the pipeline can be rebuilt at runtime
+static RX_Filters_t recorderFilters;
+
+// CPU cycle counter used to measure cost of the audio stages
+static uint32_t AUDIO_CycleCount(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+// Build receive path processing chain from settings, DC bias is already removed by the listen task
+static void AUDIO_PipelineBuild(void)
+{
+    RX_PipelineBuild(&gAudioPipeline,
+                     AUDIO_CycleCount,
+                     gSettings.audio.in.agc == SETTINGS_TRUE ? &agc : NULL,
+                     gSettings.audio.in.filter == SETTINGS_TRUE ? &recorderFilters : NULL,
+                     AUDIO_INPUT_SAMPLE_FREQ);
+}
+
+// Recording found in the directory of the recorder
+typedef struct
 {
-    // ADC sample
-    AUDIO_ADC_DATA_TYPE *data;
-    size_t received_data_size;
-    uint32_t calibration_value = 0;
+    uint32_t index;              // segment number, 0 for the logger files
+    char name[48];               // file name within the directory
+} AUDIO_RecorderFile_t;
 
-    // If ADC ring buffer is being used by some other task wait indefinitely
-    while (xSemaphoreTake(receiveSemaphore, 1000 / portTICK_PERIOD_MS) == pdFALSE)
+// Directory of the recordings and how the files in it are named
+typedef struct
+{
+    char dirpath[64];            // directory holding the recordings
+    char base[48];               // segments are named base_<number><ext>, empty for the logger files
+    char ext[16];                // extension of the recordings including the dot
+    bool logger;                 // files are named by their timestamp
+} AUDIO_RecorderDir_t;
+
+// Storage cleanup queued by the recorder, heap allocated and freed by the cleanup
+typedef struct
+{
+    AUDIO_RecorderDir_t dir;     // where the recordings are
+    AUDIO_RecorderFile_t current; // file being opened, it and the newer ones are kept
+    uint64_t min_free_bytes;     // free space to reach
+    AUDIO_RecorderFile_t oldest[AUDIO_RECORDER_CLEANUP_BATCH]; // oldest files collected by the last scan
+} AUDIO_RecorderCleanup_t;
+
+// Recorder state, only accessed by the record task
+typedef struct
+{
+    WRITER_Buffer_t *buffer;     // writer buffer being filled, NULL until one is acquired
+    size_t buffer_limit;         // amount of bytes the current writer buffer is filled up to
+    char filepath[64];           // file currently recorded
+    char stem[64];               // requested filepath without extension, segments are named stem_00001.ext
+    char ext[16];                // requested filepath extension including the dot
+    bool segmented;              // recording is split into numbered segments
+    bool logger;                 // each transmission is recorded to its own timestamped file
+    bool open;                   // file is open
+    char index_path[64];         // logger index file
+    uint32_t index;              // number of the current segment
+    AUDIO_RecordFormat_t format; // wav encoding
+    uint32_t sample_rate;        // sample rate of the recording in Hz
+    DECIMATOR_t decimator;       // anti-alias filter for the lower sample rates
+    ADPCM_Encoder_t encoder;     // IMA ADPCM block encoder
+#if CONFIG_AUDIO_RECORDER_CODEC2
+    struct CODEC2 *codec2;       // Codec2 encoder, NULL for the other formats
+    int16_t frame[AUDIO_CODEC2_MAX_FRAME_SAMPLES]; // samples waiting for the Codec2 frame to fill
+    size_t frame_len;            // amount of samples in the frame
+#endif
+    size_t frame_samples;        // samples per Codec2 frame
+    size_t frame_bytes;          // bytes per Codec2 frame
+    size_t missing;              // bytes of the block cut short when the writer fell behind
+    size_t file_samples;         // samples stored in the current file
+    size_t file_bytes;           // data bytes written to the current file
+    size_t file_limit;           // samples after which the current file is full
+    size_t header_len;           // size of the current file header
+    int64_t start_ms;            // wall clock time of the first sample in the current file
+    uint16_t peak;               // peak absolute sample value in the current file
+    char peaks_path[64];         // peaks sidecar of the current file, empty if the name does not fit
+    PEAKS_t peaks;               // waveform peaks waiting to be appended to the sidecar
+    uint64_t min_free_bytes;     // free space kept by deleting the oldest segments or logger files
+} AUDIO_Recorder_t;
+
+static AUDIO_Recorder_t recorder;
+
+_Static_assert(sizeof(wav_ima_adpcm_header_t) <= WRITER_HEADER_MAX_SIZE, "Wav header does not fit into the writer header");
+_Static_assert(sizeof(AUDIO_LoggerEntry_t) == 64, "Logger index record layout changed");
+_Static_assert(sizeof(c2_header_t) == 7, "Codec2 header layout changed");
+_Static_assert(PEAKS_BUFFER_SIZE <= WRITER_HEADER_MAX_SIZE && sizeof(WAVEFORM_Header_t) <= WRITER_HEADER_MAX_SIZE, "Peaks do not fit into the writer jobs");
+#if CONFIG_AUDIO_RECORDER_CODEC2
+_Static_assert(AUDIO_C2_MODE_3200 == CODEC2_MODE_3200 && AUDIO_C2_MODE_1600 == CODEC2_MODE_1600, "Codec2 mode numbers changed");
+#endif
+
+// Codec2 formats are raw frames preceded by c2_header_t instead of wav
+static bool AUDIO_RecorderIsCodec2(AUDIO_RecordFormat_t format)
+{
+    return format == AUDIO_RECORD_FORMAT_CODEC2_3200 || format == AUDIO_RECORD_FORMAT_CODEC2_1600;
+}
+
+// Process recorded samples in place and decimate them to the recorder sample rate
+// Returns amount of samples left
+static size_t AUDIO_RecorderProcess(int16_t *samples, size_t len)
+{
+    const uint32_t cycles_start = esp_cpu_get_cycle_count();
+
+    PIPELINE_Process(&gAudioPipeline, samples, len);
+
+    if (recorder.sample_rate != AUDIO_INPUT_SAMPLE_FREQ)
     {
-        ESP_LOGW(TAG, "Calibration waiting for ADC ring buffer to be released..");
+        len = DECIMATOR_Process(&recorder.decimator, samples, len, samples);
     }
 
-    for (u_int i = 0; i < AUDIO_ADC_CALIBRATION_SAMPLES; i++)
+    TELEMETRY_Record(TELEMETRY_STAGE_PIPELINE, esp_cpu_get_cycle_count() - cycles_start);
+
+    return len;
+}
+
+// Amount of data bytes taken by the samples in the recorder format
+static uint64_t AUDIO_RecorderBytes(uint64_t samples)
+{
+    if (recorder.format == AUDIO_RECORD_FORMAT_IMA_ADPCM)
     {
-        // Get ADC data from the ADC ring buffer
-        data = (AUDIO_ADC_DATA_TYPE *)xRingbufferReceive(adcRingBufferHandle, &received_data_size, pdMS_TO_TICKS(1000));
-        // Check received data
+        return (samples + ADPCM_SAMPLES_PER_BLOCK - 1) / ADPCM_SAMPLES_PER_BLOCK * ADPCM_BLOCK_SIZE;
+    }
+
+    if (AUDIO_RecorderIsCodec2(recorder.format))
+    {
+        return (samples + recorder.frame_samples - 1) / recorder.frame_samples * recorder.frame_bytes;
+    }
+
+    return samples * sizeof(AUDIO_ADC_DATA_TYPE);
+}
+
+// Amount of samples fitting into the data bytes in the recorder format
+static uint64_t AUDIO_RecorderSamples(uint64_t bytes)
+{
+    if (recorder.format == AUDIO_RECORD_FORMAT_IMA_ADPCM)
+    {
+        return bytes / ADPCM_BLOCK_SIZE * ADPCM_SAMPLES_PER_BLOCK;
+    }
+
+    if (AUDIO_RecorderIsCodec2(recorder.format))
+    {
+        return bytes / recorder.frame_bytes * recorder.frame_samples;
+    }
+
+    return bytes / sizeof(AUDIO_ADC_DATA_TYPE);
+}
+
+// Fill file header describing the samples stored in data_bytes
+// Returns size of the header
+static size_t AUDIO_RecorderHeader(uint8_t *header, uint32_t samples, uint32_t data_bytes)
+{
+    // Codec2 header has no sizes, length of the file is given by the amount of frames
+    if (AUDIO_RecorderIsCodec2(recorder.format))
+    {
+        const c2_header_t c2_header = {
+            .magic = AUDIO_C2_MAGIC,
+            .version_major = AUDIO_C2_VERSION_MAJOR,
+            .version_minor = AUDIO_C2_VERSION_MINOR,
+            .mode = (recorder.format == AUDIO_RECORD_FORMAT_CODEC2_1600) ? AUDIO_C2_MODE_1600 : AUDIO_C2_MODE_3200,
+            .flags = 0};
+
+        memcpy(header, &c2_header, sizeof(c2_header_t));
+
+        return sizeof(c2_header_t);
+    }
+
+    if (recorder.format == AUDIO_RECORD_FORMAT_IMA_ADPCM)
+    {
+        const wav_ima_adpcm_header_t adpcm_header = {
+            .ChunkID = "RIFF",
+            .ChunkSize = sizeof(wav_ima_adpcm_header_t) - 8 + data_bytes,
+            .Format = "WAVE",
+            .Subchunk1ID = "fmt ",
+            .Subchunk1Size = 20,
+            .AudioFormat = AUDIO_WAV_FORMAT_IMA_ADPCM,
+            .NumChannels = 1,
+            .SampleRate = recorder.sample_rate,
+            .ByteRate = recorder.sample_rate * ADPCM_BLOCK_SIZE / ADPCM_SAMPLES_PER_BLOCK,
+            .BlockAlign = ADPCM_BLOCK_SIZE,
+            .BitsPerSample = 4,
+            .ExtraSize = 2,
+            .SamplesPerBlock = ADPCM_SAMPLES_PER_BLOCK,
+            .FactID = "fact",
+            .FactSize = 4,
+            .SampleLength = samples,
+            .Subchunk2ID = "data",
+            .Subchunk2Size = data_bytes};
+
+        memcpy(header, &adpcm_header, sizeof(wav_ima_adpcm_header_t));
+
+        return sizeof(wav_ima_adpcm_header_t);
+    }
+
+    const wav_header_t pcm_header = {
+        .ChunkID = "RIFF",
+        .ChunkSize = sizeof(wav_header_t) - 8 + data_bytes,
+        .Format = "WAVE",
+        .Subchunk1ID = "fmt ",
+        .Subchunk1Size = 16,
+        .AudioFormat = AUDIO_WAV_FORMAT_PCM,
+        .NumChannels = 1,
+        .SampleRate = recorder.sample_rate,
+        .ByteRate = recorder.sample_rate * sizeof(AUDIO_ADC_DATA_TYPE),
+        .BlockAlign = sizeof(AUDIO_ADC_DATA_TYPE),
+        .BitsPerSample = 16,
+        .Subchunk2ID = "data",
+        .Subchunk2Size = data_bytes};
+
+    memcpy(header, &pcm_header, sizeof(wav_header_t));
+
+    return sizeof(wav_header_t);
+}
+
+// Hand the current buffer over to the writer task
+static void AUDIO_RecorderFlush(void)
+{
+    if (recorder.buffer != NULL)
+    {
+        WRITER_Write(recorder.buffer);
+        recorder.buffer = NULL;
+    }
+
+    recorder.buffer_limit = WRITER_BufferSize();
+}
+
+// Copy bytes into the writer buffers, zeros are written if data is NULL
+// Returns amount of bytes accepted, the rest is dropped if the writer falls behind
+static size_t AUDIO_RecorderWriteBytes(const uint8_t *data, size_t len)
+{
+    size_t written = 0;
+
+    while (written < len)
+    {
+        if (recorder.buffer == NULL)
+        {
+            recorder.buffer = WRITER_Acquire();
+
+            // Never wait for the storage, it would back-pressure the audio bus
+            if (recorder.buffer == NULL)
+                break;
+        }
+
+        const size_t count = MIN(len - written, recorder.buffer_limit - recorder.buffer->len);
+
         if (data != NULL)
         {
-            // ESP_LOGI(TAG, "VAL:%d", *data);
-            // Calculate mean value
-            calibration_value += *data;
-            if (i > 0)
+            memcpy(&recorder.buffer->data[recorder.buffer->len], &data[written], count);
+        }
+        else
+        {
+            memset(&recorder.buffer->data[recorder.buffer->len], 0, count);
+        }
+
+        recorder.buffer->len += count;
+        recorder.file_bytes += count;
+        written += count;
+
+        if (recorder.buffer->len >= recorder.buffer_limit)
+        {
+            AUDIO_RecorderFlush();
+        }
+    }
+
+    return written;
+}
+
+// Write the complete ADPCM block or Codec2 frame holding the amount of samples
+static void AUDIO_RecorderWriteBlock(const uint8_t *block, size_t len, size_t samples)
+{
+    // Finish the block cut short before, so the following blocks stay aligned
+    recorder.missing -= AUDIO_RecorderWriteBytes(NULL, recorder.missing);
+
+    const size_t written = (recorder.missing == 0) ? AUDIO_RecorderWriteBytes(block, len) : 0;
+
+    if (written < len)
+    {
+        recorder.missing += (written > 0) ? len - written : 0;
+        TELEMETRY_Count(TELEMETRY_COUNTER_RECORDER_DROPPED_SAMPLES, samples);
+    }
+}
+
+#if CONFIG_AUDIO_RECORDER_CODEC2
+// Encode the full Codec2 frame
+static void AUDIO_RecorderWriteFrame(void)
+{
+    uint8_t bits[AUDIO_CODEC2_MAX_FRAME_BYTES];
+
+    codec2_encode(recorder.codec2, bits, recorder.frame);
+    AUDIO_RecorderWriteBlock(bits, recorder.frame_bytes, recorder.frame_samples);
+    recorder.frame_len = 0;
+}
+#endif
+
+// Encode samples into the writer buffers, the file is written by the writer task
+static void AUDIO_RecorderWrite(const int16_t *samples, size_t len)
+{
+    if (recorder.format == AUDIO_RECORD_FORMAT_IMA_ADPCM)
+    {
+        size_t encoded = 0;
+
+        while (encoded < len)
+        {
+            encoded += ADPCM_Encode(&recorder.encoder, &samples[encoded], len - encoded);
+
+            if (ADPCM_EncoderFull(&recorder.encoder))
             {
-                calibration_value /= 2;
+                AUDIO_RecorderWriteBlock(recorder.encoder.block, ADPCM_BLOCK_SIZE, ADPCM_SAMPLES_PER_BLOCK);
             }
-
-            // Return item so it gets removed from the ring buffer
-            vRingbufferReturnItem(adcRingBufferHandle, (void *)data);
         }
-        else
+        return;
+    }
+
+#if CONFIG_AUDIO_RECORDER_CODEC2
+    if (AUDIO_RecorderIsCodec2(recorder.format))
+    {
+        size_t copied = 0;
+
+        while (copied < len)
         {
-            // Likely the buffer is empty
-            ESP_LOGI(TAG, "Calibration failed. ADC ring buffer empty.");
-            goto Done;
+            const size_t count = MIN(len - copied, recorder.frame_samples - recorder.frame_len);
+
+            memcpy(&recorder.frame[recorder.frame_len], &samples[copied], count * sizeof(int16_t));
+            recorder.frame_len += count;
+            copied += count;
+
+            if (recorder.frame_len == recorder.frame_samples)
+            {
+                AUDIO_RecorderWriteFrame();
+            }
         }
+        return;
     }
+#endif
+
+    const size_t written = AUDIO_RecorderWriteBytes((const uint8_t *)samples, len * sizeof(AUDIO_ADC_DATA_TYPE)) / sizeof(AUDIO_ADC_DATA_TYPE);
 
-    gSettings.calibration.adc.value = (u_int16_t)calibration_value;
-    gSettings.calibration.adc.is_valid = SETTINGS_TRUE;
+    if (written < len)
+    {
+        TELEMETRY_Count(TELEMETRY_COUNTER_RECORDER_DROPPED_SAMPLES, len - written);
+    }
+}
 
-    ESP_ERROR_CHECK_WITHOUT_ABORT(SETTINGS_Save());
+// Build filepath of the segment
+// Returns false if it does not fit
+static bool AUDIO_RecorderSegmentPath(char *filepath, size_t size, uint32_t index)
+{
+    const int len = snprintf(filepath, size, "%s_%05" PRIu32 "%s", recorder.stem, index, recorder.ext);
 
-    ESP_LOGI(TAG, "ADC calibrated to: %d. Used %d samples for calibration.", gSettings.calibration.adc.value, AUDIO_ADC_CALIBRATION_SAMPLES);
-Done:
-    // Release semaphore so others can use the resource
-    xSemaphoreGive(receiveSemaphore);
-    // Delete self
-    vTaskDelete(NULL);
+    return len > 0 && (size_t)len < size;
 }
 
-// Low priority task that will consume ADC samples from the ADC ring buffer if no other tasks need them
-// to prevent ADC ring buffer overflow
-void AUDIO_EmptyAdcRingBuffer(void *pvParameters)
+// Snapshot of the directory the recorder writes to, so the cleanup does not depend on the recorder state
+static bool AUDIO_RecorderDirInit(AUDIO_RecorderDir_t *dir)
 {
-    // ADC sample
-    AUDIO_ADC_DATA_TYPE *data;
-    size_t received_data_size;
+    memset(dir, 0, sizeof(AUDIO_RecorderDir_t));
+    dir->logger = recorder.logger;
+    strlcpy(dir->ext, recorder.ext, sizeof(dir->ext));
 
-    while (1)
+    if (recorder.logger)
+    {
+        return strlcpy(dir->dirpath, recorder.stem, sizeof(dir->dirpath)) < sizeof(dir->dirpath);
+    }
+
+    const char *base = strrchr(recorder.stem, '/');
+
+    if (base == NULL || (size_t)(base - recorder.stem) >= sizeof(dir->dirpath))
+    {
+        return false;
+    }
+
+    strlcpy(dir->dirpath, recorder.stem, (size_t)(base - recorder.stem) + 1);
+
+    return strlcpy(dir->base, base + 1, sizeof(dir->base)) < sizeof(dir->base);
+}
+
+// Name written by AUDIO_RecorderOpen in logger mode, YYYYmmdd_HHMMSS_mmm<ext>
+static bool AUDIO_RecorderIsLoggerName(const char *name, const char *ext)
+{
+    for (size_t i = 0; i < AUDIO_LOGGER_NAME_LEN; i++)
     {
-        // Check if we can discard samples
-        if (xSemaphoreTake(receiveSemaphore, 2000 / portTICK_PERIOD_MS) == pdFALSE)
+        const bool separator = (i == 8 || i == 15);
+
+        if (separator ? name[i] != '_' : !isdigit((unsigned char)name[i]))
         {
-            ESP_LOGI(TAG, "ADC ring buffer is being accessed by some task.");
+            return false;
+        }
+    }
+
+    return strcmp(&name[AUDIO_LOGGER_NAME_LEN], ext) == 0;
+}
+
+// Older of the recordings, segments go by their number, logger files by their timestamped name
+static bool AUDIO_RecorderOlder(const AUDIO_RecorderDir_t *dir, const AUDIO_RecorderFile_t *a, const AUDIO_RecorderFile_t *b)
+{
+    return dir->logger ? strcmp(a->name, b->name) < 0 : a->index < b->index;
+}
+
+// Find the files of the recorder, segments base_<number><ext> or logger files YYYYmmdd_HHMMSS_mmm<ext>
+// Collects up to size oldest ones older than current in order, current is NULL to collect all of them
+// Returns amount of files found, highest is the highest segment number
+static size_t AUDIO_RecorderScan(const AUDIO_RecorderDir_t *dir, const AUDIO_RecorderFile_t *current,
+                                 AUDIO_RecorderFile_t *oldest, size_t size, size_t *collected, uint32_t *highest)
+{
+    const size_t base_len = strlen(dir->base);
+    size_t found = 0;
+
+    *collected = 0;
+    *highest = 0;
+
+    DIR *handle = opendir(dir->dirpath);
+
+    if (handle == NULL)
+    {
+        return 0;
+    }
+
+    struct dirent *entry;
+    AUDIO_RecorderFile_t file;
+
+    while ((entry = readdir(handle)) != NULL)
+    {
+        file.index = 0;
+
+        if (dir->logger)
+        {
+            // Logger directory may be shared with other files, only the names the logger writes are its own
+            if (!AUDIO_RecorderIsLoggerName(entry->d_name, dir->ext))
+                continue;
         }
         else
         {
-            data = (AUDIO_ADC_DATA_TYPE *)xRingbufferReceive(adcRingBufferHandle, &received_data_size, pdMS_TO_TICKS(1000));
-            // Check received data
-            if (data != NULL)
+            // Segment name is base_<number><ext>
+            if (strncmp(entry->d_name, dir->base, base_len) != 0 || entry->d_name[base_len] != '_')
+                continue;
+
+            const char *number = &entry->d_name[base_len + 1];
+            char *end;
+
+            file.index = strtoul(number, &end, 10);
+
+            if (end == number || strcmp(end, dir->ext) != 0)
+                continue;
+        }
+
+        if (strlcpy(file.name, entry->d_name, sizeof(file.name)) >= sizeof(file.name))
+            continue;
+
+        *highest = (found == 0) ? file.index : MAX(*highest, file.index);
+        found++;
+
+        // File being opened and the newer ones belong to the running recording
+        if (current != NULL && !AUDIO_RecorderOlder(dir, &file, current))
+            continue;
+
+        // Insertion keeps the collected files ordered from the oldest, the newest falls out once it is full
+        size_t pos = *collected;
+
+        while (pos > 0 && AUDIO_RecorderOlder(dir, &file, &oldest[pos - 1]))
+        {
+            pos--;
+        }
+
+        if (pos < size)
+        {
+            memmove(&oldest[pos + 1], &oldest[pos], (MIN(*collected, size - 1) - pos) * sizeof(AUDIO_RecorderFile_t));
+            oldest[pos] = file;
+            *collected = MIN(*collected + 1, size);
+        }
+    }
+
+    closedir(handle);
+
+    return found;
+}
+
+// Delete the oldest recordings until there is enough free space, run by the writer task
+// so the capture is not delayed by the directory scan. Logger index keeps the records of the deleted files.
+// Works from its own copy of the recorder state, as the next recording may start before it runs.
+// Writes of the recording wait behind it, so it is bound to one scan and a batch of deletions per opened file.
+static void AUDIO_RecorderCleanup(void *arg)
+{
+    AUDIO_RecorderCleanup_t *cleanup = (AUDIO_RecorderCleanup_t *)arg;
+    char filepath[sizeof(recorder.filepath)];
+    char sidecar[sizeof(recorder.filepath)];
+    uint64_t free_bytes;
+    uint32_t highest;
+    size_t collected = 0;
+    size_t next = 0;
+
+    while (get_free_space(cleanup->dir.dirpath, &free_bytes) == ESP_OK && free_bytes < cleanup->min_free_bytes)
+    {
+        if (next == 0)
+        {
+            AUDIO_RecorderScan(&cleanup->dir, &cleanup->current, cleanup->oldest, ARRAY_SIZE(cleanup->oldest), &collected, &highest);
+
+            if (collected == 0)
             {
-                // Return item so it gets removed from the ring buffer
-                vRingbufferReturnItem(adcRingBufferHandle, (void *)data);
+                ESP_LOGW(TAG, "Storage is running low, no old recordings left to delete");
+                break;
             }
-            else
+        }
+        // Rest is left to the cleanup of the next file
+        else if (next == collected)
+        {
+            break;
+        }
+
+        const int len = snprintf(filepath, sizeof(filepath), "%s/%s", cleanup->dir.dirpath, cleanup->oldest[next++].name);
+
+        if (len < 0 || (size_t)len >= sizeof(filepath))
+        {
+            continue;
+        }
+
+        ESP_LOGI(TAG, "Deleting oldest recording %s", filepath);
+
+        if (delete_file(filepath) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to delete %s", filepath);
+            break;
+        }
+
+        if (WAVEFORM_Path(sidecar, sizeof(sidecar), filepath))
+        {
+            delete_file(sidecar);
+        }
+    }
+
+    free(cleanup);
+}
+
+// Queue the storage cleanup, the scan skips the current file and the newer ones
+static void AUDIO_RecorderQueueCleanup(void)
+{
+    AUDIO_RecorderCleanup_t *cleanup = malloc(sizeof(AUDIO_RecorderCleanup_t));
+
+    if (cleanup == NULL)
+    {
+        ESP_LOGE(TAG, "Cleanup malloc failed");
+        return;
+    }
+
+    cleanup->min_free_bytes = recorder.min_free_bytes;
+    cleanup->current.index = recorder.index;
+    strlcpy(cleanup->current.name, strrchr(recorder.filepath, '/') + 1, sizeof(cleanup->current.name));
+
+    if (!AUDIO_RecorderDirInit(&cleanup->dir))
+    {
+        free(cleanup);
+        return;
+    }
+
+    // Dropped while the storage is behind, the next file queues it again
+    if (!WRITER_Call(AUDIO_RecorderCleanup, cleanup))
+    {
+        free(cleanup);
+    }
+}
+
+// Wall clock time in ms, counts from boot unless the clock was set
+static int64_t AUDIO_RecorderTimeMs(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+// Queue opening of the next file, its header is patched once the file is closed
+// Returns ESP_ERR_TIMEOUT if the storage is too far behind to take another file, opening can be retried later
+static esp_err_t AUDIO_RecorderOpen(void)
+{
+    uint8_t header[WRITER_HEADER_MAX_SIZE];
+    uint32_t index = recorder.index;
+
+    recorder.start_ms = AUDIO_RecorderTimeMs();
+
+    if (recorder.logger)
+    {
+        const time_t seconds = recorder.start_ms / 1000;
+        struct tm tm;
+        char timestamp[20];
+
+        gmtime_r(&seconds, &tm);
+        strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", &tm);
+
+        // Milliseconds keep the names unique, squelch cannot reopen within the same one
+        const int len = snprintf(recorder.filepath, sizeof(recorder.filepath), "%s/%s_%03d%s", recorder.stem, timestamp, (int)(recorder.start_ms % 1000), recorder.ext);
+
+        if (len < 0 || (size_t)len >= sizeof(recorder.filepath))
+        {
+            ESP_LOGE(TAG, "Logger filepath is too long");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    else if (recorder.segmented)
+    {
+        index++;
+
+        if (!AUDIO_RecorderSegmentPath(recorder.filepath, sizeof(recorder.filepath), index))
+        {
+            ESP_LOGE(TAG, "Segment filepath is too long");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    // Claim the largest size until the header is patched, so a file cut by power loss still plays to its end
+    recorder.header_len = AUDIO_RecorderHeader(header, recorder.file_limit, AUDIO_RecorderBytes(recorder.file_limit));
+
+    if (!WRITER_Open(recorder.filepath, header, recorder.header_len))
+    {
+        ESP_LOGW(TAG, "Storage is behind, %s not opened yet", recorder.filepath);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    ESP_LOGI(TAG, "Opening file: %s", recorder.filepath);
+    recorder.index = index;
+
+    if ((recorder.logger || recorder.segmented) && recorder.min_free_bytes > 0)
+    {
+        AUDIO_RecorderQueueCleanup();
+    }
+
+    // Peaks sidecar grows along the recording, so the waveform can be previewed without the audio
+    if (WAVEFORM_Path(recorder.peaks_path, sizeof(recorder.peaks_path), recorder.filepath))
+    {
+        WAVEFORM_Header_t peaks_header;
+
+        WAVEFORM_HeaderInit(&peaks_header, recorder.sample_rate);
+        PEAKS_Init(&recorder.peaks, peaks_header.per_peak);
+
+        if (!WRITER_OpenSidecar(recorder.peaks_path, &peaks_header, sizeof(WAVEFORM_Header_t)))
+        {
+            recorder.peaks_path[0] = '\0';
+        }
+    }
+    else
+    {
+        recorder.peaks_path[0] = '\0';
+    }
+
+    // First buffer shares the cluster with the header, the following ones start on cluster boundaries
+    recorder.buffer = NULL;
+    recorder.buffer_limit = WRITER_BufferSize() - recorder.header_len;
+    recorder.open = true;
+    recorder.peak = 0;
+    recorder.missing = 0;
+    recorder.file_samples = 0;
+    recorder.file_bytes = 0;
+    ADPCM_EncoderInit(&recorder.encoder);
+#if CONFIG_AUDIO_RECORDER_CODEC2
+    recorder.frame_len = 0;
+#endif
+
+    return ESP_OK;
+}
+
+// Queue the tracked peaks to the sidecar
+// Peaks after a dropped write would land at the wrong time, so the sidecar ends at the gap
+static void AUDIO_RecorderWritePeaks(void)
+{
+    if (!WRITER_WriteSidecar(recorder.peaks.data, recorder.peaks.len))
+    {
+        ESP_LOGW(TAG, "Storage is behind, peaks of %s end early", recorder.filepath);
+        recorder.peaks_path[0] = '\0';
+    }
+}
+
+// Queue closing of the current file with the header describing what was actually written
+static void AUDIO_RecorderClose(void)
+{
+    uint8_t header[WRITER_HEADER_MAX_SIZE];
+
+    // Last ADPCM block is padded, the header tells the real amount of samples
+    if (recorder.format == AUDIO_RECORD_FORMAT_IMA_ADPCM && recorder.encoder.len > 0 && !ADPCM_EncoderFull(&recorder.encoder))
+    {
+        ADPCM_EncoderPad(&recorder.encoder);
+        AUDIO_RecorderWriteBlock(recorder.encoder.block, ADPCM_BLOCK_SIZE, ADPCM_SAMPLES_PER_BLOCK);
+    }
+
+#if CONFIG_AUDIO_RECORDER_CODEC2
+    // Last Codec2 frame is padded with silence
+    if (recorder.codec2 != NULL && recorder.frame_len > 0)
+    {
+        memset(&recorder.frame[recorder.frame_len], 0, (recorder.frame_samples - recorder.frame_len) * sizeof(int16_t));
+        AUDIO_RecorderWriteFrame();
+    }
+#endif
+
+    // Samples which did not fill the whole buffer
+    AUDIO_RecorderFlush();
+
+    // Sidecar is closed along the file
+    if (recorder.peaks_path[0] != '\0')
+    {
+        PEAKS_Finish(&recorder.peaks);
+
+        if (recorder.peaks.len > 0)
+        {
+            AUDIO_RecorderWritePeaks();
+        }
+    }
+
+    const size_t samples = MIN((uint64_t)recorder.file_samples, AUDIO_RecorderSamples(recorder.file_bytes));
+    const size_t header_len = AUDIO_RecorderHeader(header, samples, recorder.file_bytes);
+
+    // Codec2 header stays as it was written
+    WRITER_Close(AUDIO_RecorderIsCodec2(recorder.format) ? NULL : header, header_len);
+    recorder.open = false;
+
+    ESP_LOGI(TAG, "Written recording to %s", recorder.filepath);
+
+    if (recorder.logger)
+    {
+        AUDIO_LoggerEntry_t entry = {
+            .start_ms = recorder.start_ms,
+            .duration_ms = (uint64_t)recorder.file_samples * 1000 / recorder.sample_rate,
+            .offset = recorder.header_len,
+            .peak = recorder.peak,
+            .format = recorder.format};
+
+        strlcpy(entry.filename, strrchr(recorder.filepath, '/') + 1, sizeof(entry.filename));
+
+        // Appended once the file is closed, so the index never points to an unfinished recording
+        if (!WRITER_Append(recorder.index_path, &entry, sizeof(AUDIO_LoggerEntry_t)))
+        {
+            ESP_LOGE(TAG, "Storage is behind, %s is missing from the index", entry.filename);
+        }
+    }
+}
+
+// Track waveform peaks, full peak buffers are written to the sidecar
+static void AUDIO_RecorderPeaks(const int16_t *samples, size_t len)
+{
+    size_t tracked = 0;
+
+    if (recorder.peaks_path[0] == '\0')
+        return;
+
+    while (tracked < len)
+    {
+        tracked += PEAKS_Process(&recorder.peaks, &samples[tracked], len - tracked);
+
+        if (PEAKS_Full(&recorder.peaks))
+        {
+            AUDIO_RecorderWritePeaks();
+            PEAKS_Clear(&recorder.peaks);
+        }
+    }
+}
+
+// Store samples, rolls over to the next segment once the current file is full
+// Returns amount of samples consumed, less than len if the file is full and recording is not segmented
+static size_t AUDIO_RecorderStore(const int16_t *samples, size_t len)
+{
+    size_t stored = 0;
+
+    while (stored < len)
+    {
+        if (recorder.open && recorder.file_samples >= recorder.file_limit)
+        {
+            if (!recorder.segmented && !recorder.logger)
+                break;
+
+            AUDIO_RecorderClose();
+        }
+
+        if (!recorder.open)
+        {
+            const esp_err_t ret = AUDIO_RecorderOpen();
+
+            // Storage is behind, samples are dropped until the next file can be opened
+            if (ret == ESP_ERR_TIMEOUT)
             {
-                // Likely the buffer is empty
-                ESP_LOGI(TAG, "ADC ring buffer empty");
+                TELEMETRY_Count(TELEMETRY_COUNTER_RECORDER_DROPPED_SAMPLES, len - stored);
+                return len;
             }
 
-            // Give semaphore so other tasks can access ADC ring buffer
-            xSemaphoreGive(receiveSemaphore);
+            if (ret != ESP_OK)
+                break;
+        }
+
+        const size_t count = MIN(len - stored, recorder.file_limit - recorder.file_samples);
+
+        for (size_t i = stored; i < stored + count; i++)
+        {
+            const uint16_t level = (samples[i] < 0) ? -(int32_t)samples[i] : samples[i];
+
+            recorder.peak = MAX(recorder.peak, level);
         }
+
+        AUDIO_RecorderPeaks(&samples[stored], count);
+        AUDIO_RecorderWrite(&samples[stored], count);
+        recorder.file_samples += count;
+        stored += count;
     }
+
+    return stored;
 }
 
-// Audio record task
-void AUDIO_Record(void *pvParameters)
+// Prepare recorder state from the task params
+static void AUDIO_RecorderSetup(const AUDIO_RecordParam_t *param)
 {
-#ifdef AUDIO_RECORDER_FILTER_ENABLED
-    // Define filters
-    FILTER_BiquadFilter_t hp_filter;
-    FILTER_BiquadFilter_t lp_filter_1;
-    FILTER_BiquadFilter_t lp_filter_2;
-    FILTER_BiquadFilter_t lp_filter_3;
-    // Init filters
-    FILTER_Init(&hp_filter, AUDIO_INPUT_HPF_FREQ, AUDIO_INPUT_SAMPLE_FREQ, FILTER_HIGHPASS, 0.6);
-    FILTER_Init(&lp_filter_1, AUDIO_INPUT_LPF_1_FREQ, AUDIO_INPUT_SAMPLE_FREQ, FILTER_LOWPASS, 0.25);
-    FILTER_Init(&lp_filter_2, AUDIO_INPUT_LPF_2_FREQ, AUDIO_INPUT_SAMPLE_FREQ, FILTER_LOWPASS, 0.40);
-    FILTER_Init(&lp_filter_3, AUDIO_INPUT_LPF_3_FREQ, AUDIO_INPUT_SAMPLE_FREQ, FILTER_LOWPASS, 0.40);
+    const char *ext = strrchr(param->filepath, '.');
+
+    // Dot belongs to the extension only if it is in the filename
+    if (ext == NULL || strchr(ext, '/') != NULL)
+    {
+        ext = param->filepath + strlen(param->filepath);
+    }
+
+    strlcpy(recorder.filepath, param->filepath, sizeof(recorder.filepath));
+    strlcpy(recorder.stem, param->filepath, MIN(sizeof(recorder.stem), (size_t)(ext - param->filepath) + 1));
+    strlcpy(recorder.ext, ext, sizeof(recorder.ext));
+
+    recorder.logger = param->logger == SETTINGS_TRUE;
+    recorder.open = false;
+    recorder.format = (param->format < AUDIO_RECORD_FORMAT_LAST) ? param->format : AUDIO_RECORD_FORMAT_PCM;
+
+#if CONFIG_AUDIO_RECORDER_CODEC2
+    // 3200bps mode takes 20ms frames, 1600bps mode 40ms frames
+    recorder.frame_samples = (recorder.format == AUDIO_RECORD_FORMAT_CODEC2_1600) ? 320 : 160;
+    recorder.frame_bytes = 8;
+#else
+    // Keep the recording small even without the codec
+    if (AUDIO_RecorderIsCodec2(recorder.format))
+    {
+        ESP_LOGW(TAG, "Codec2 support is disabled (CONFIG_AUDIO_RECORDER_CODEC2), recording IMA ADPCM");
+        recorder.format = AUDIO_RECORD_FORMAT_IMA_ADPCM;
+    }
 #endif
 
-    // Retrieve params
+    // Extension follows the encoding, Codec2 frames do not make a wav file and players go by the extension
+    const bool codec2 = AUDIO_RecorderIsCodec2(recorder.format);
+
+    if (!recorder.logger && codec2 != (strcmp(recorder.ext, AUDIO_LOGGER_CODEC2_FILE_EXT) == 0))
+    {
+        strlcpy(recorder.ext, codec2 ? AUDIO_LOGGER_CODEC2_FILE_EXT : AUDIO_LOGGER_FILE_EXT, sizeof(recorder.ext));
+
+        // Stem gives way if the name is at its limit, so the extension is never cut
+        const size_t stem_len = MIN(strlen(recorder.stem), sizeof(recorder.filepath) - 1 - strlen(recorder.ext));
+
+        recorder.stem[stem_len] = '\0';
+        snprintf(recorder.filepath, sizeof(recorder.filepath), "%s%s", recorder.stem, recorder.ext);
+        ESP_LOGW(TAG, "Recording to %s, the extension has to match the format", recorder.filepath);
+    }
+
+    // Logger filepath is the directory holding the recordings and the index
+    if (recorder.logger)
+    {
+        strlcpy(recorder.stem, param->filepath, sizeof(recorder.stem));
+
+        const size_t len = strlen(recorder.stem);
+
+        if (len > 0 && recorder.stem[len - 1] == '/')
+        {
+            recorder.stem[len - 1] = '\0';
+        }
+
+        strlcpy(recorder.ext, codec2 ? AUDIO_LOGGER_CODEC2_FILE_EXT : AUDIO_LOGGER_FILE_EXT, sizeof(recorder.ext));
+        snprintf(recorder.index_path, sizeof(recorder.index_path), "%s/" AUDIO_LOGGER_INDEX_FILENAME, recorder.stem);
+    }
+
+    recorder.sample_rate = AUDIO_INPUT_SAMPLE_FREQ;
+
+    // Codec2 works at 8kHz only
+    const uint16_t sample_rate = AUDIO_RecorderIsCodec2(recorder.format) ? AUDIO_CODEC2_SAMPLE_FREQ : param->sample_rate;
+
+    // Lower rates keep the voice band, the decimator removes everything that would alias into it
+    if (sample_rate > 0 && sample_rate < AUDIO_INPUT_SAMPLE_FREQ &&
+        AUDIO_INPUT_SAMPLE_FREQ % sample_rate == 0 &&
+        DECIMATOR_InitVoice(&recorder.decimator, AUDIO_INPUT_SAMPLE_FREQ / sample_rate))
+    {
+        recorder.sample_rate = sample_rate;
+    }
+    else if (sample_rate != AUDIO_INPUT_SAMPLE_FREQ)
+    {
+        ESP_LOGW(TAG, "Unsupported recorder sample rate %d Hz, using %d Hz", sample_rate, AUDIO_INPUT_SAMPLE_FREQ);
+    }
+    // Logger files are split by transmissions
+    recorder.segmented = !recorder.logger && (param->segment_sec > 0 || param->segment_mb > 0);
+    recorder.min_free_bytes = (uint64_t)param->min_free_mb * 1024 * 1024;
+    recorder.file_limit = AUDIO_RecorderSamples(AUDIO_RECORDER_MAX_FILE_SIZE - WRITER_HEADER_MAX_SIZE);
+
+    if (param->segment_sec > 0)
+    {
+        recorder.file_limit = MIN(recorder.file_limit, (size_t)param->segment_sec * recorder.sample_rate);
+    }
+
+    if (param->segment_mb > 0)
+    {
+        recorder.file_limit = MIN((uint64_t)recorder.file_limit, AUDIO_RecorderSamples((uint64_t)param->segment_mb * 1024 * 1024));
+    }
+
+    // Single file is not longer than the whole recording
+    if (!recorder.segmented && !recorder.logger && param->duration_sec > 0)
+    {
+        recorder.file_limit = MIN(recorder.file_limit, (size_t)param->duration_sec * recorder.sample_rate);
+    }
+
+    // Continue numbering after the segments left by the previous recordings
+    AUDIO_RecorderDir_t dir;
+    size_t collected;
+    uint32_t highest;
+
+    recorder.index = (recorder.segmented && AUDIO_RecorderDirInit(&dir) && AUDIO_RecorderScan(&dir, NULL, NULL, 0, &collected, &highest) > 0) ? highest : 0;
+}
+
+// Allocate pre-roll store, PSRAM is preferred as it can be large
+// falls back to internal RAM and shrinks the pre-roll if there is not enough memory
+static int16_t *AUDIO_RecorderPrerollAlloc(size_t *capacity)
+{
+    int16_t *samples = heap_caps_malloc(*capacity * sizeof(AUDIO_ADC_DATA_TYPE), MALLOC_CAP_SPIRAM);
+
+    while (samples == NULL && *capacity > 0)
+    {
+        samples = heap_caps_malloc(*capacity * sizeof(AUDIO_ADC_DATA_TYPE), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+        // Pre-roll shorter than a single block is not worth it
+        if (samples == NULL)
+        {
+            *capacity = (*capacity / 2 >= BUS_BLOCK_SIZE) ? *capacity / 2 : 0;
+        }
+    }
+
+    return samples;
+}
+
+// Request the record task to finish the recording
+void AUDIO_RecordStop(void)
+{
+    xEventGroupSetBits(audioEventGroup, BIT_STOP_RECORD);
+}
+
+// Audio record task, pvParameters is a heap allocated AUDIO_RecordParam_t the task frees
+void AUDIO_Record(void *pvParameters)
+{
+    AUDIO_PipelineBuild();
+
+    // Retrieve params, the task owns them and frees them once it is done
     AUDIO_RecordParam_t *param = (AUDIO_RecordParam_t *)pvParameters;
 
-    int16_t *buffersigned = NULL;
+    BUS_Consumer_t *consumer = NULL;
+    const BUS_Block_t *block;
+    // Block copied out of the bus, so it can be processed after it is released
+    static int16_t scratch[BUS_BLOCK_SIZE];
+    bool writer_started = false;
+    // Audio from before the squelch opened
+    PREROLL_t preroll;
+    size_t preroll_capacity = MIN(gSettings.audio.in.preroll_ms, AUDIO_RECORDER_PREROLL_MAX_MS) * AUDIO_INPUT_SAMPLE_FREQ / 1000;
+    int16_t *preroll_samples = NULL;
 
-    FILE *fd = NULL;
     struct stat file_stat;
 
-    // If the file exists delete it
-    if (stat(param->filepath, &file_stat) == 0)
+    xEventGroupClearBits(audioEventGroup, BIT_STOP_RECORD);
+
+    AUDIO_RecorderSetup(param);
+
+#if CONFIG_AUDIO_RECORDER_CODEC2
+    recorder.codec2 = NULL;
+
+    if (AUDIO_RecorderIsCodec2(recorder.format))
+    {
+        recorder.codec2 = codec2_create((recorder.format == AUDIO_RECORD_FORMAT_CODEC2_1600) ? CODEC2_MODE_1600 : CODEC2_MODE_3200);
+
+        if (recorder.codec2 == NULL)
+        {
+            ESP_LOGE(TAG, "Recorder failed to create Codec2 encoder");
+            goto Done;
+        }
+    }
+#endif
+
+    if (recorder.logger)
+    {
+        // SPIFFS has no directories, it is fine if this fails
+        mkdir(recorder.stem, 0755);
+    }
+    // Segments are never overwritten, the single file is
+    else if (!recorder.segmented && stat(recorder.filepath, &file_stat) == 0)
     {
-        // Delete the file
-        delete_file(param->filepath);
+        // Delete the file, its extension may differ from the requested one
+        delete_file(recorder.filepath);
     }
 
-    if (get_path_type(param->filepath) == FILESYSTEM_PATH_FLASH)
+    if (!recorder.segmented && !recorder.logger && param->duration_sec > 0 && get_path_type(param->filepath) == FILESYSTEM_PATH_FLASH)
     {
         ESP_LOGI(TAG, "Performing garbage collection..");
         // Garbage collect to get enough free space for the file
-        esp_err_t ret = esp_spiffs_gc(NULL, (param->duration_sec * AUDIO_INPUT_SAMPLE_FREQ * sizeof(AUDIO_ADC_DATA_TYPE)));
+        esp_err_t ret = esp_spiffs_gc(NULL, AUDIO_RecorderBytes(param->duration_sec * recorder.sample_rate));
         // esp_err_t ret = esp_spiffs_gc(NULL, ((param->max_duration_ms / 1000) * AUDIO_INPUT_SAMPLE_FREQ * sizeof(AUDIO_ADC_DATA_TYPE)));
         if (ret != ESP_OK)
         {
@@ -217,120 +1169,183 @@ void AUDIO_Record(void *pvParameters)
 
     ESP_LOGI(TAG, "Preparing recording.");
 
-    ESP_LOGI(TAG, "Opening file: %s", param->filepath);
-    fd = fopen(param->filepath, "wb");
-
-    if (NULL == fd)
+    // Samples are gathered into cluster sized buffers written by the writer task
+    if (WRITER_Start() != ESP_OK)
     {
-        ESP_LOGE(TAG, "Failed to read %s", param->filepath);
+        ESP_LOGE(TAG, "Recorder failed to start the writer");
         goto Done;
     }
 
-    ESP_LOGI(TAG, "File opened");
+    writer_started = true;
 
-    // Determines how many samples we want to save
-    const size_t target_samples_written = param->duration_sec * AUDIO_INPUT_SAMPLE_FREQ;
-    size_t bytes_received = 0;
-    size_t samples_written = 0;
-
-    // write wav header
-    wav_header_t wav_header = {
-        .ChunkID = "RIFF",
-        .ChunkSize = (2 * target_samples_written) - 8,
-        .Format = "WAVE",
-        .Subchunk1ID = "fmt ",
-        .Subchunk1Size = 16,
-        .AudioFormat = 1,
-        .NumChannels = 1,
-        .SampleRate = AUDIO_INPUT_SAMPLE_FREQ,
-        .ByteRate = 64000,
-        .BlockAlign = 2,
-        .BitsPerSample = 16,
-        .Subchunk2ID = "data",
-        .Subchunk2Size = target_samples_written * 2};
+    if (preroll_capacity > 0)
+    {
+        const size_t requested = preroll_capacity;
 
-    int len = fwrite(&wav_header, 1, sizeof(wav_header_t), fd);
+        preroll_samples = AUDIO_RecorderPrerollAlloc(&preroll_capacity);
 
-    if (len <= 0)
+        if (preroll_capacity < requested)
+        {
+            ESP_LOGW(TAG, "Pre-roll shortened to %d ms due to low memory", (int)preroll_capacity * 1000 / AUDIO_INPUT_SAMPLE_FREQ);
+        }
+    }
+
+    PREROLL_Init(&preroll, preroll_samples, preroll_capacity);
+
+    // Determines how many input samples we want to record, 0 records until stopped
+    const size_t target_samples_written = param->duration_sec * AUDIO_INPUT_SAMPLE_FREQ;
+    size_t samples_written = 0;
+
+    // Logger opens a new file each time the squelch opens
+    if (!recorder.logger && AUDIO_RecorderOpen() != ESP_OK)
     {
-        ESP_LOGE(TAG, "Read wav header failed");
+        goto Done;
     }
 
     ESP_LOGI(TAG, "Waiting for squelch to open");
 
-    while (1)
+    consumer = AUDIO_Subscribe(audioRecordConsumerName);
+
+    if (consumer == NULL)
+    {
+        goto Done;
+    }
+
+    while (target_samples_written == 0 || samples_written < target_samples_written)
     {
-        // Wait until squelch opens
-        while (gAudioState != AUDIO_RECEIVING)
+        // Writer failed to open or write the file, there is no point in recording further
+        if (WRITER_Status() != ESP_OK)
         {
-            vTaskDelay(1);
+            goto Done;
         }
 
-        // If ADC ring buffer is being used by some other task wait indefinitely
-        while (xSemaphoreTake(receiveSemaphore, 1000 / portTICK_PERIOD_MS) == pdFALSE)
+        if (xEventGroupGetBits(audioEventGroup) & BIT_STOP_RECORD)
         {
-            ESP_LOGW(TAG, "Record waiting for ADC ring buffer to be released..");
+            ESP_LOGI(TAG, "Recording stopped");
+            goto Done;
         }
 
-        // Wait until the buffer has enough data, to avoid writing to filesystem in small chunks
-        while (xRingbufferGetCurFreeSize(adcRingBufferHandle) >= AUDIO_INPUT_CHUNK_SIZE)
+        block = AUDIO_WaitBlock(consumer, AUDIO_INPUT_BLOCK_TIMEOUT_MS);
+
+        if (block == NULL)
         {
-            vTaskDelay(1 / portTICK_PERIOD_MS);
+            // ADC is stopped while transmitting, keep waiting unless we already started a recording of fixed length
+            if (samples_written > 0 && target_samples_written > 0)
+            {
+                ESP_LOGI(TAG, "No ADC data");
+                goto Done;
+            }
+            continue;
         }
 
-        // Get ADC data from the ADC ring buffer
-        buffersigned = xRingbufferReceiveUpTo(adcRingBufferHandle, &bytes_received, pdMS_TO_TICKS(250), AUDIO_INPUT_CHUNK_SIZE * sizeof(AUDIO_ADC_DATA_TYPE));
+        // Keep audio in the pre-roll until squelch opens
+        if ((xEventGroupGetBits(audioEventGroup) & BIT_SQUELCH_OPEN) == 0)
+        {
+            // Transmission is over, squelch closes only after the hang time
+            if (recorder.logger && recorder.open)
+            {
+                AUDIO_RecorderClose();
+            }
 
-        ESP_LOGI(TAG, "bytes received: %d", bytes_received);
+            PREROLL_Push(&preroll, block->samples, block->len);
 
-        // Check received data
-        if (buffersigned != NULL)
-        {
-            // iterate over samples
-            for (size_t i = 0; i < bytes_received / sizeof(AUDIO_ADC_DATA_TYPE); i += 1)
+            // Pre-roll must stay continuous, drop it if the block got overwritten while we were copying it
+            if (!BUS_Release(&gAudioBus, consumer))
             {
-                // Remove DC bias (center signal)
-                buffersigned[i] = buffersigned[i] - gSettings.calibration.adc.value;
-                // Amplify signal using AGC (clipping prevention built-in)
-                buffersigned[i] = AGC_Update(&agc, buffersigned[i]);
-#ifdef AUDIO_RECORDER_FILTER_ENABLED
-                // Filter through high-pass filter
-                buffersigned[i] = FILTER_Update(&hp_filter, buffersigned[i]);
-                // Filter through 1st order low-pass filter
-                buffersigned[i] = FILTER_Update(&lp_filter_1, buffersigned[i]);
-                // Filter through 2nd order low-pass filter
-                buffersigned[i] = FILTER_Update(&lp_filter_2, buffersigned[i]);
-                // Amplify a bit between filtering to prevent filtering distortions
-                buffersigned[i] *= 2;
-                // Filter through 3rd order low-pass filter
-                buffersigned[i] = FILTER_Update(&lp_filter_3, buffersigned[i]);
-#endif
+                PREROLL_Reset(&preroll);
             }
-            // Return item so it gets removed from the ring buffer
-            vRingbufferReturnItem(adcRingBufferHandle, buffersigned);
-            // Write to file
-            samples_written += fwrite(buffersigned, 1, bytes_received, fd) / sizeof(AUDIO_ADC_DATA_TYPE);
-            // Give semaphore so other tasks can access ADC ring buffer
-            xSemaphoreGive(receiveSemaphore);
-
-            // Check if we've written enough samples
-            if (samples_written >= target_samples_written)
+            continue;
+        }
+
+        size_t remaining = (target_samples_written > 0) ? target_samples_written - samples_written : SIZE_MAX;
+        size_t stored;
+
+        // Storage being behind is not fatal, storing retries the open
+        if (recorder.logger && !recorder.open)
+        {
+            const esp_err_t ret = AUDIO_RecorderOpen();
+
+            if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT)
             {
+                BUS_Release(&gAudioBus, consumer);
                 goto Done;
             }
         }
-        else
+
+        // Squelch just opened, write the pre-roll ahead of the live stream
+        if (preroll.len > 0)
         {
-            // Likely the buffer is empty
-            ESP_LOGI(TAG, "ADC ring buffer empty");
-            goto Done;
+            const size_t preroll_len = MIN(PREROLL_Linearize(&preroll), remaining);
+            const size_t processed = AUDIO_RecorderProcess(preroll.samples, preroll_len);
+
+            stored = AUDIO_RecorderStore(preroll.samples, processed);
+            samples_written += preroll_len;
+            remaining -= preroll_len;
+            PREROLL_Reset(&preroll);
+            // Recording starts before the squelch opened
+            recorder.start_ms -= (int64_t)preroll_len * 1000 / AUDIO_INPUT_SAMPLE_FREQ;
+
+            if (stored < processed || remaining == 0)
+            {
+                BUS_Release(&gAudioBus, consumer);
+                break;
+            }
+        }
+
+        const size_t count = MIN((size_t)block->len, remaining);
+
+        memcpy(scratch, block->samples, count * sizeof(AUDIO_ADC_DATA_TYPE));
+
+        // Drop samples if the block got overwritten while we were copying it
+        if (BUS_Release(&gAudioBus, consumer))
+        {
+            const size_t processed = AUDIO_RecorderProcess(scratch, count);
+
+            stored = AUDIO_RecorderStore(scratch, processed);
+            samples_written += count;
+
+            // File limit reached and recording is not segmented
+            if (stored < processed)
+            {
+                ESP_LOGW(TAG, "Recording reached the max file size");
+                break;
+            }
         }
     }
 
 Done:
-    fclose(fd);
+    AUDIO_Unsubscribe(consumer);
+
+    for (uint8_t i = 0; i < gAudioPipeline.len; i++)
+    {
+        const PIPELINE_Stage_t *stage = &gAudioPipeline.stages[i];
+
+        if (stage->blocks > 0)
+        {
+            ESP_LOGI(TAG, "Pipeline stage %s: %" PRIu32 " blocks, %" PRIu32 " cycles/block", stage->name, stage->blocks, (uint32_t)(stage->cycles / stage->blocks));
+        }
+    }
+
+    if (recorder.open)
+    {
+        AUDIO_RecorderClose();
+    }
+
+    if (writer_started)
+    {
+        WRITER_Stop();
+    }
+
+#if CONFIG_AUDIO_RECORDER_CODEC2
+    if (recorder.codec2 != NULL)
+    {
+        codec2_destroy(recorder.codec2);
+        recorder.codec2 = NULL;
+    }
+#endif
 
-    ESP_LOGI(TAG, "Written recording to %s", param->filepath);
+    free(preroll_samples);
+    free(param);
 
     // Delete self
     vTaskDelete(NULL);
@@ -392,6 +1407,16 @@ static void AUDIO_SetAudioState(AudioState_t state)
 // Initialize ADC
 static void AUDIO_AdcInit()
 {
+    // Upsample factor is a runtime setting, each supported factor has its own decimator coefficient table
+    uint8_t upsample_factor = gSettings.audio.in.upsample_factor;
+
+    if (!DECIMATOR_Init(&ingest.decimator, upsample_factor))
+    {
+        ESP_LOGW(TAG, "Unsupported upsample factor: %d, using: %d", upsample_factor, AUDIO_INPUT_DEFAULT_UPSAMPLE_FACTOR);
+        upsample_factor = AUDIO_INPUT_DEFAULT_UPSAMPLE_FACTOR;
+        DECIMATOR_Init(&ingest.decimator, upsample_factor);
+    }
+
     adc_continuous_handle_cfg_t adc_config = {
         .max_store_buf_size = AUDIO_INPUT_MAX_BUFF_SIZE,
         .conv_frame_size = AUDIO_INPUT_CHUNK_SIZE,
@@ -400,7 +1425,7 @@ static void AUDIO_AdcInit()
     ESP_ERROR_CHECK(adc_continuous_new_handle(&adc_config, &adc_handle));
 
     adc_continuous_config_t dig_cfg = {
-        .sample_freq_hz = (AUDIO_INPUT_SAMPLE_FREQ * AUDIO_INPUT_UPSAMPLE_FACTOR * AUDIO_INPUT_SAMPLE_RATE_WORKAROUND),
+        .sample_freq_hz = (AUDIO_INPUT_SAMPLE_FREQ * upsample_factor * AUDIO_INPUT_SAMPLE_RATE_WORKAROUND),
         .conv_mode = AUDIO_ADC_CONV_MODE,
         .format = AUDIO_ADC_OUTPUT_TYPE,
     };
@@ -433,6 +1458,7 @@ static void AUDIO_AdcInit()
     ESP_LOGI(TAG, "ADC initialized");
     ESP_LOGI(TAG, "ADC attenuation: %" PRIx8, dig_cfg.adc_pattern[0].atten);
     ESP_LOGI(TAG, "ADC channel: %" PRIx8, dig_cfg.adc_pattern[0].channel);
+    ESP_LOGI(TAG, "ADC upsample factor: %d", upsample_factor);
 }
 
 // Stop ADC
@@ -442,100 +1468,144 @@ void AUDIO_AdcStop()
     adc_continuous_deinit(adc_handle);
 }
 
+// Log average cost of the ingest stages per block and reset the counters
+static void AUDIO_ReportIngestStats(void)
+{
+    // Totals at the previous report, statistics are logged per interval
+    static uint32_t last_blocks;
+    static uint64_t last_cycles[TELEMETRY_STAGE_PUBLISH + 1];
+    uint64_t cycles[TELEMETRY_STAGE_PUBLISH + 1];
+    uint64_t total_cycles = 0;
+
+    const uint32_t total_blocks = TELEMETRY_GetStage(TELEMETRY_STAGE_ADC_READ)->count;
+
+    // Telemetry got reset through the API
+    if (total_blocks < last_blocks)
+    {
+        last_blocks = 0;
+        memset(last_cycles, 0, sizeof(last_cycles));
+    }
+
+    const uint32_t blocks = total_blocks - last_blocks;
+    last_blocks = total_blocks;
+
+    for (TELEMETRY_StageId_t id = TELEMETRY_STAGE_ADC_READ; id <= TELEMETRY_STAGE_PUBLISH; id++)
+    {
+        const uint64_t stage_cycles = TELEMETRY_GetStage(id)->total_cycles;
+
+        cycles[id] = stage_cycles - last_cycles[id];
+        last_cycles[id] = stage_cycles;
+        total_cycles += cycles[id];
+    }
+
+    if (blocks == 0)
+    {
+        return;
+    }
+
+    // CPU load of the whole ingest in 0.1% units
+    uint32_t load = total_cycles / ((uint64_t)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * AUDIO_INGEST_STATS_INTERVAL_MS);
+
+    ESP_LOGI(TAG, "Ingest: %" PRIu32 " blocks, cycles/block read: %" PRIu32 " decode: %" PRIu32 " decimate: %" PRIu32 " dc: %" PRIu32 " squelch: %" PRIu32 " publish: %" PRIu32 ", load: %" PRIu32 ".%" PRIu32 "%%",
+             blocks,
+             (uint32_t)(cycles[TELEMETRY_STAGE_ADC_READ] / blocks),
+             (uint32_t)(cycles[TELEMETRY_STAGE_DECODE] / blocks),
+             (uint32_t)(cycles[TELEMETRY_STAGE_DECIMATE] / blocks),
+             (uint32_t)(cycles[TELEMETRY_STAGE_DC] / blocks),
+             (uint32_t)(cycles[TELEMETRY_STAGE_SQUELCH] / blocks),
+             (uint32_t)(cycles[TELEMETRY_STAGE_PUBLISH] / blocks),
+             load / 10,
+             load % 10);
+
+    for (size_t i = 0; i < BUS_MAX_CONSUMERS; i++)
+    {
+        BUS_Consumer_t *consumer = &gAudioBus.consumers[i];
+
+        if (atomic_load(&consumer->in_use) && atomic_load(&consumer->overruns) > 0)
+        {
+            ESP_LOGW(TAG, "Consumer %s overruns: %u", consumer->name, atomic_load(&consumer->overruns));
+        }
+    }
+}
+
 // Monitors audio state for issues
 void AUDIO_Watchdog(void *pvParameters)
 {
-    TaskHandle_t adcCalibrateTaskHandle = NULL;
     while (1)
     {
-        // Schedule ADC calibration if its value is not valid
-        if (gSettings.calibration.adc.is_valid == SETTINGS_FALSE)
+        // Keep ADC calibration in sync with the DC tracker, it gets persisted with the next settings save
+        // and used as the starting point after reboot, the estimate is only trusted while the input is silent
+        if (ingest.dc.primed && !ingest.squelch.open)
         {
-            ESP_LOGW(TAG, "ADC calibration is invalid. Please remove audio input. Scheduling calibration..");
-            // If ADC calibrate task is not already running we can start
-            if (adcCalibrateTaskHandle == NULL)
-            {
-                ESP_LOGI(TAG, "ADC calibration starting..");
-                xTaskCreate(AUDIO_AdcCalibrate, "AUDIO_AdcCalibrate", 2048, NULL, RTOS_PRIORITY_HIGH, &adcCalibrateTaskHandle);
-            }
+            gSettings.calibration.adc.value = DC_Value(&ingest.dc);
+            gSettings.calibration.adc.is_valid = SETTINGS_TRUE;
         }
         // Check if there are dropped frames
         if (adcDroppedFrames > 0)
         {
             ESP_LOGW(TAG, "Dropped frames: %d", adcDroppedFrames);
+            TELEMETRY_Count(TELEMETRY_COUNTER_ADC_DROPPED_FRAMES, adcDroppedFrames);
             adcDroppedFrames = 0;
         }
 
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
+        AUDIO_ReportIngestStats();
+
+        vTaskDelay(AUDIO_INGEST_STATS_INTERVAL_MS / portTICK_PERIOD_MS);
     }
 }
-// Monitors samples over squelch and controls the squelch
+// Applies squelch transitions reported by the listen task to gAudioState
+// Blocks on the audio event group, so it only wakes up when the squelch opens or closes
 void AUDIO_SquelchControl(void *pvParameters)
 {
-    // Last seen samples over squelch, updated every time window
-    uint16_t last_seen_samples_over_squelch = samplesOverSquelch;
-    // Counts time windows when there were samples over squelch
-    u_int16_t over_squelch_windows = 0;
-    // Counts time windows when there where samples under squelch
-    u_int16_t under_squelch_windows = 0;
+    EventBits_t audioEventGroupBits;
+
     while (1)
     {
-        // If the samplesOverSquelch has changed since last time we checked it means we are receiving audio
-        if (last_seen_samples_over_squelch != samplesOverSquelch)
-        {
-            // Reset the opposite window
-            under_squelch_windows = 0;
-            // Prevent overflow
-            samplesOverSquelch = 0;
-            if (gAudioState == AUDIO_LISTENING)
-                over_squelch_windows++;
-        }
-        // If the samplesOverSquelch remains unchanged since last time we checked it means we are not receiving audio
-        else if (last_seen_samples_over_squelch == samplesOverSquelch)
-        {
-            // Reset the opposite window
-            over_squelch_windows = 0;
-            if (gAudioState == AUDIO_RECEIVING)
-                under_squelch_windows++;
-        }
+        xEventGroupWaitBits(audioEventGroup, BIT_SQUELCH_CHANGED, pdTRUE, pdFALSE, portMAX_DELAY);
+
+        audioEventGroupBits = xEventGroupGetBits(audioEventGroup);
 
-        // Squelch on delay based on the over the squelch time window count (1*10ms = 10ms)
-        if (over_squelch_windows >= 1 && gAudioState != AUDIO_RECEIVING)
+        if ((audioEventGroupBits & BIT_SQUELCH_OPEN) != 0 && gAudioState == AUDIO_LISTENING)
         {
             ESP_LOGI(TAG, "RECEIVING");
             AUDIO_SetAudioState(AUDIO_RECEIVING);
-            over_squelch_windows = 0;
         }
-        // Squelch off delay based on the under the squelch time window count (200*10ms = 2000ms)
-        if (under_squelch_windows >= 200 && (gAudioState != AUDIO_LISTENING && gAudioState != AUDIO_TRANSMITTING))
+        else if ((audioEventGroupBits & BIT_SQUELCH_OPEN) == 0 && gAudioState == AUDIO_RECEIVING)
         {
             ESP_LOGI(TAG, "LISTENING");
             AUDIO_SetAudioState(AUDIO_LISTENING);
-            under_squelch_windows = 0;
         }
+    }
+}
 
-        // ESP_LOGI(TAG, "O:%d U:%d S:%d", over_squelch_windows, under_squelch_windows, gAudioState);
-        // ESP_LOGI(TAG, "last:%d new:%d", last_seen_samples_over_squelch, samplesOverSquelch);
-
-        // Set value for next time window
-        last_seen_samples_over_squelch = samplesOverSquelch;
-
-        // Delay of this task is the time multplier of the time windows (10ms)
-        vTaskDelay(10 / portTICK_PERIOD_MS);
+// Publish squelch transition to the subscribers
+static void AUDIO_SignalSquelch(SQUELCH_Event_t event)
+{
+    switch (event)
+    {
+    case SQUELCH_EVENT_OPEN:
+        xEventGroupSetBits(audioEventGroup, BIT_SQUELCH_OPEN | BIT_SQUELCH_CHANGED);
+        break;
+    case SQUELCH_EVENT_CLOSE:
+        xEventGroupClearBits(audioEventGroup, BIT_SQUELCH_OPEN);
+        xEventGroupSetBits(audioEventGroup, BIT_SQUELCH_CHANGED);
+        break;
+    default:
+        break;
     }
 }
 
 // Task listening to incoming audio on ADC port
-// It writes ADC samples to ADC ring buffer for further processing
+// It decodes each ADC chunk into a block of samples and publishes the whole block to the audio bus for further processing
 void AUDIO_Listen(void *pvParameters)
 {
-    // ADC sample value
-    AUDIO_ADC_DATA_TYPE data;
-    adc_digi_output_data_t *p;
-    uint32_t chan_num;
     uint32_t received_bytes = 0;
+    size_t samples, block_len;
+    BUS_Block_t *block;
     esp_err_t ret;
-    uint8_t result[AUDIO_INPUT_CHUNK_SIZE] = {0};
+    uint32_t cycles_start, cycles_read, cycles_decode, cycles_ingest;
+    // Aligned so ADC results can be unpacked into int16_t samples in place
+    uint8_t result[AUDIO_INPUT_CHUNK_SIZE] __attribute__((aligned(4))) = {0};
     memset(result, 0xcc, AUDIO_INPUT_CHUNK_SIZE);
 
     audioListenTaskHandle = xTaskGetCurrentTaskHandle();
@@ -554,6 +1624,12 @@ void AUDIO_Listen(void *pvParameters)
         { // something requested that we stop listening
             AUDIO_AdcStop();
             ESP_LOGI(TAG, "Stopped ADC.");
+            // No input while transmitting, close the squelch
+            if (ingest.squelch.open)
+            {
+                SQUELCH_Reset(&ingest.squelch);
+                AUDIO_SignalSquelch(SQUELCH_EVENT_CLOSE);
+            }
             // clear bit
             xEventGroupClearBits(audioEventGroup, BIT_STOP_LISTEN);
             // indicate that we stopped listening
@@ -577,49 +1653,41 @@ void AUDIO_Listen(void *pvParameters)
             // Block until we receive notification from the interupt that data frame is available
             ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
+            cycles_start = esp_cpu_get_cycle_count();
+
             ret = adc_continuous_read(adc_handle, result, AUDIO_INPUT_CHUNK_SIZE, &received_bytes, 0);
 
+            cycles_read = esp_cpu_get_cycle_count();
+
             if (ret == ESP_OK)
             {
-                for (int i = 0; i < received_bytes; i += SOC_ADC_DIGI_RESULT_BYTES * AUDIO_INPUT_UPSAMPLE_FACTOR)
+                samples = RX_Unpack(result, received_bytes, SOC_ADC_CHANNEL_NUM(audioAdcUnit));
+
+                if (samples < received_bytes / SOC_ADC_DIGI_RESULT_BYTES)
                 {
-                    // Calculate mean value from AUDIO_INPUT_UPSAMPLE_FACTOR samples
-                    data = 0;
-                    for (int up = 0; up < SOC_ADC_DIGI_RESULT_BYTES * AUDIO_INPUT_UPSAMPLE_FACTOR; up += SOC_ADC_DIGI_RESULT_BYTES)
-                    {
-                        p = (adc_digi_output_data_t *)&result[i + up];
-                        chan_num = AUDIO_ADC_GET_CHANNEL(p);
-                        // Get actual ADC sample value
-                        data += AUDIO_ADC_GET_DATA(p);
-
-                        if (up > 0)
-                        {
-                            data /= 2;
-                        }
-                    }
-
-                    // Check the channel number validation, the data is invalid if the channel num exceed the maximum channel
-                    if (chan_num < SOC_ADC_CHANNEL_NUM(audioAdcUnit))
-                    {
-                        // Count samples over the squelch threshold
-                        if ((data > ((gSettings.calibration.adc.value * (100 + gSettings.audio.in.squelch)) / 100)) || (data < ((gSettings.calibration.adc.value * (100 - gSettings.audio.in.squelch)) / 100)))
-                        {
-                            samplesOverSquelch++;
-                        }
-
-                        // Send ADC sample to ring buffer
-                        UBaseType_t res = xRingbufferSend(adcRingBufferHandle, &data, sizeof(AUDIO_ADC_DATA_TYPE), pdMS_TO_TICKS(1000));
-
-                        if (res != pdTRUE)
-                        {
-                            ESP_LOGE(TAG, "Failed to send ADC data to the ring buffer. The buffer is full?");
-                        }
-                    }
-                    else
-                    {
-                        ESP_LOGW(TAG, "Invalid ADC data");
-                    }
+                    ESP_LOGW(TAG, "Invalid ADC data");
                 }
+
+                cycles_decode = esp_cpu_get_cycle_count();
+
+                // Process directly into the audio bus block, it becomes visible to consumers once published
+                block = BUS_WriteBlock(&gAudioBus);
+                AUDIO_SignalSquelch(RX_IngestProcess(&ingest, (int16_t *)result, samples, block->samples, &block_len, gSettings.audio.in.squelch));
+                block->len = block_len;
+
+                cycles_ingest = esp_cpu_get_cycle_count();
+
+                // Publish whole block at once, consumers that fell behind lose the oldest blocks
+                if (block->len > 0)
+                {
+                    BUS_Publish(&gAudioBus);
+                }
+
+                // Decimate, DC and squelch stages are recorded by the ingest
+                TELEMETRY_Record(TELEMETRY_STAGE_ADC_READ, cycles_read - cycles_start);
+                TELEMETRY_Record(TELEMETRY_STAGE_DECODE, cycles_decode - cycles_read);
+                TELEMETRY_Record(TELEMETRY_STAGE_PUBLISH, esp_cpu_get_cycle_count() - cycles_ingest);
+
                 // Feed the watchdog
                 vTaskDelay(1);
             }
@@ -680,161 +1748,316 @@ esp_err_t AUDIO_TransmitStop(void)
     return ESP_OK;
 }
 
+// Write whole block of samples to the audio output
+static void AUDIO_OutputWrite(const int16_t *samples, size_t len)
+{
+    const uint8_t *data = (const uint8_t *)samples;
+    size_t total = len * sizeof(int16_t);
+    size_t written = 0;
+
+    while (total > 0)
+    {
+        if (pwm_audio_write((uint8_t *)data, total, &written, 1000 / portTICK_PERIOD_MS) != ESP_OK || written == 0)
+        {
+            ESP_LOGE(TAG, "Audio output write failed");
+            return;
+        }
+
+        data += written;
+        total -= written;
+    }
+}
+
+/// @brief Play tones back to back, the output keeps running in between
+/// so tones are rendered into 20ms blocks and written once per block
+/// @param tones tones to play, zero frequency is silence
+/// @param count amount of tones
+void AUDIO_PlayTones(const AUDIO_Tone_t *tones, size_t count)
+{
+    const int16_t amplitude = gSettings.audio.out.volume * AUDIO_VOLUME_MULTIPLIER;
+    TONE_t tone;
+    size_t block_len = 0;
+
+    int16_t *block = malloc(AUDIO_OUTPUT_BLOCK_SAMPLES * sizeof(int16_t));
+    assert(block);
+
+    pwm_audio_apply_settings();
+
+    pwm_audio_start();
+
+    for (size_t i = 0; i < count && !atomic_load(&playCancelled); i++)
+    {
+        // Raised cosine ramps keep the keying clicks out of the spectrum
+        TONE_Start(&tone, tones[i].freq, 0, AUDIO_OUTPUT_SAMPLE_FREQ, (uint32_t)tones[i].duration_ms * AUDIO_OUTPUT_SAMPLE_FREQ / 1000,
+                   AUDIO_TONE_RAMP_MS * AUDIO_OUTPUT_SAMPLE_FREQ / 1000, amplitude);
+
+        while (!TONE_Done(&tone) && !atomic_load(&playCancelled))
+        {
+            block_len += TONE_Render(&tone, &block[block_len], AUDIO_OUTPUT_BLOCK_SAMPLES - block_len);
+
+            if (block_len == AUDIO_OUTPUT_BLOCK_SAMPLES)
+            {
+                AUDIO_OutputWrite(block, block_len);
+                block_len = 0;
+            }
+        }
+    }
+
+    AUDIO_OutputWrite(block, block_len);
+
+    // Stop audio
+    pwm_audio_stop();
+
+    // Deallocate temp buffer
+    free(block);
+}
+
 /// @brief Play single tone
 /// @param freq frequency of the tone in hz
 /// @param duration_ms duration in ms
 void AUDIO_PlayTone(uint16_t freq, uint16_t duration_ms)
 {
-    size_t w_bytes = 0;
+    const AUDIO_Tone_t tone = {.freq = freq, .duration_ms = duration_ms};
 
-    // Allocate temp buffer
-    int16_t *w_buf = (int16_t *)calloc(1, AUDIO_OUTPUT_BUFFER_SIZE);
-    assert(w_buf);
+    AUDIO_PlayTones(&tone, 1);
+}
 
-    uint32_t duration_sine = (AUDIO_OUTPUT_SAMPLE_FREQ / (float)freq) + 0.5;
+// Play count bits of data with the AFSK modulator, bytes are read MSB or LSB first
+static void AUDIO_PlayAFSKBits(const uint8_t *data, size_t count, bool msb_first, uint16_t baud, uint16_t zero_freq, uint16_t one_freq)
+{
+    AFSK_t afsk;
+    size_t block_len = 0;
 
-    // Generate tone buffer for single sinewave
-    for (int i = 0; i < duration_sine; i++)
-    {
-        w_buf[i] = (int16_t)((sin(2 * (float)i * CONST_PI / duration_sine)) * (gSettings.audio.out.volume * AUDIO_VOLUME_MULTIPLIER));
-    }
+    // Sanitize inputs
+    zero_freq = MIN(MAX(zero_freq, AUDIO_AFSK_TONE_MIN_FREQ), AUDIO_AFSK_TONE_MAX_FREQ);
+    one_freq = MIN(MAX(one_freq, AUDIO_AFSK_TONE_MIN_FREQ), AUDIO_AFSK_TONE_MAX_FREQ);
+    baud = MIN(MAX(baud, AUDIO_AFSK_MIN_BAUD), AUDIO_AFSK_MAX_BAUD);
+
+    ESP_LOGI(TAG, "AFSK baud: %d, samples per bit: %.2f", baud, (float)AUDIO_OUTPUT_SAMPLE_FREQ / baud);
+    ESP_LOGI(TAG, "AFSK zero_f: %d, one_f: %d", zero_freq, one_freq);
 
-    // Multiply single sinewave to desired duration
-    uint32_t duration_total = duration_ms * AUDIO_OUTPUT_SAMPLE_FREQ / 1000;
+    AFSK_Init(&afsk, AUDIO_OUTPUT_SAMPLE_FREQ, baud, one_freq, zero_freq, gSettings.audio.out.volume * AUDIO_VOLUME_MULTIPLIER);
 
-    // Multiply duration by 2 because we point to u_int8_t and write int16_t
-    duration_total *= 2;
+    // Block fits the write size and the bit which overflows it
+    int16_t *block = malloc((AUDIO_OUTPUT_BLOCK_SAMPLES + AFSK_MaxBitSamples(&afsk)) * sizeof(int16_t));
+    assert(block);
 
     pwm_audio_apply_settings();
 
     pwm_audio_start();
 
-    for (int tot_bytes = 0; tot_bytes < duration_total; tot_bytes += w_bytes)
+    for (size_t i = 0; i < count && !atomic_load(&playCancelled); i++)
     {
-        // Play the tone
-        if (pwm_audio_write((u_int8_t *)w_buf, duration_sine * sizeof(int16_t), &w_bytes, 1000 / portTICK_PERIOD_MS) != ESP_OK)
+        const uint8_t shift = msb_first ? 7 - i % 8 : i % 8;
+
+        block_len += AFSK_RenderBit(&afsk, (data[i / 8] >> shift) & 1, &block[block_len]);
+
+        if (block_len >= AUDIO_OUTPUT_BLOCK_SAMPLES)
         {
-            printf("Write Task: i2s write failed\n");
+            AUDIO_OutputWrite(block, block_len);
+            block_len = 0;
         }
     }
 
+    AUDIO_OutputWrite(block, block_len);
+
     // Stop audio
     pwm_audio_stop();
 
     // Deallocate temp buffer
-    free(w_buf);
+    free(block);
 }
 
-// Play AFSK coded data
+// Play AFSK coded data, bits are sent MSB first
 void AUDIO_PlayAFSK(const uint8_t *data, size_t len, uint16_t baud, uint16_t zero_freq, uint16_t one_freq)
 {
-    uint16_t zero_freq_p;
-    uint16_t one_freq_p;
-    uint16_t baud_p;
+    AUDIO_PlayAFSKBits(data, len * 8, true, baud, zero_freq, one_freq);
+}
 
-    // Sanitize inputs
-    zero_freq_p = MAX(zero_freq, AUDIO_AFSK_TONE_MIN_FREQ);
-    one_freq_p = MAX(one_freq, AUDIO_AFSK_TONE_MIN_FREQ);
-    baud_p = MAX(baud, AUDIO_AFSK_MIN_BAUD);
+// Play line bits prepared by the HDLC encoder, bits are sent LSB first
+void AUDIO_PlayAFSKLine(const uint8_t *bits, size_t count, uint16_t baud, uint16_t zero_freq, uint16_t one_freq)
+{
+    AUDIO_PlayAFSKBits(bits, count, false, baud, zero_freq, one_freq);
+}
+
+/// @brief Play samples produced by the callback until it returns 0
+/// @param callback fills the block with samples at AUDIO_OUTPUT_SAMPLE_FREQ
+/// @param arg passed to the callback
+void AUDIO_PlayStream(AUDIO_StreamCallback_t callback, void *arg)
+{
+    size_t len;
 
-    zero_freq_p = MIN(zero_freq, AUDIO_AFSK_TONE_MAX_FREQ);
-    one_freq_p = MIN(one_freq, AUDIO_AFSK_TONE_MAX_FREQ);
-    baud_p = MIN(baud, AUDIO_AFSK_MAX_BAUD);
+    int16_t *block = malloc(AUDIO_OUTPUT_BLOCK_SAMPLES * sizeof(int16_t));
+    assert(block);
 
-    int duration_us = (1000001 / baud_p);
+    pwm_audio_apply_settings();
 
-    ESP_LOGI(TAG, "AFSK baud: %d, duration_us: %d", baud_p, duration_us);
-    ESP_LOGI(TAG, "AFSK zero_f: %d, one_f: %d", zero_freq_p, one_freq_p);
+    pwm_audio_start();
 
-    size_t w_bytes = 0;
+    while (!atomic_load(&playCancelled) && (len = callback(block, AUDIO_OUTPUT_BLOCK_SAMPLES, arg)) > 0)
+    {
+        AUDIO_OutputWrite(block, MIN(len, AUDIO_OUTPUT_BLOCK_SAMPLES));
+    }
 
-    // Allocate temp buffer one
-    int16_t *w_buf_one = (int16_t *)calloc(1, AUDIO_OUTPUT_BUFFER_SIZE);
-    assert(w_buf_one);
+    // Stop audio
+    pwm_audio_stop();
 
-    // Allocate temp buffer zero
-    int16_t *w_buf_zero = (int16_t *)calloc(1, AUDIO_OUTPUT_BUFFER_SIZE);
-    assert(w_buf_zero);
+    // Deallocate temp buffer
+    free(block);
+}
 
-    uint32_t duration_sine_zero = (AUDIO_OUTPUT_SAMPLE_FREQ / (float)zero_freq_p) + 0.5;
-    uint32_t duration_sine_one = (AUDIO_OUTPUT_SAMPLE_FREQ / (float)one_freq_p) + 0.5;
+// Make the playback in progress (and any started later) stop at the next block until cleared
+void AUDIO_SetPlayCancelled(bool cancelled)
+{
+    atomic_store(&playCancelled, cancelled);
+}
 
-    /* Generate the tone buffer */
-    // Single sinewave zero
+// Wav playback buffers, allocated once per file
+typedef struct
+{
+    RESAMPLER_t resampler;
+    int16_t samples[AUDIO_WAV_BLOCK_FRAMES];    // frames read from the file as 16-bit mono
+    int16_t output[AUDIO_OUTPUT_BLOCK_SAMPLES]; // resampled block for the audio output
+    size_t output_len;                          // amount of samples in the output block
+} AUDIO_WavPlayer_t;
+
+// Resample decoded samples to the output rate, the output block is written each time it fills
+// Returns amount of samples written to the output
+static size_t AUDIO_PlayResampled(AUDIO_WavPlayer_t *player, const int16_t *samples, size_t len)
+{
+    size_t offset = 0;
+    size_t played = 0;
 
-    for (int i = 0; i < duration_sine_zero; i++)
+    // Each input block may fill the output block several times when upsampling
+    while (offset < len)
     {
-        w_buf_zero[i] = (int16_t)((sin(2 * (float)i * CONST_PI / duration_sine_zero)) * (gSettings.audio.out.volume * AUDIO_VOLUME_MULTIPLIER));
-    }
+        size_t consumed;
 
-    /* Generate the tone buffer */
-    // Single sinewave one
+        player->output_len += RESAMPLER_Process(&player->resampler, &samples[offset], len - offset, &consumed,
+                                                &player->output[player->output_len], AUDIO_OUTPUT_BLOCK_SAMPLES - player->output_len);
+        offset += consumed;
 
-    for (int i = 0; i < duration_sine_one; i++)
-    {
-        w_buf_one[i] = (int16_t)((sin(2 * (float)i * CONST_PI / duration_sine_one)) * (gSettings.audio.out.volume * AUDIO_VOLUME_MULTIPLIER));
+        if (player->output_len == AUDIO_OUTPUT_BLOCK_SAMPLES)
+        {
+            AUDIO_OutputWrite(player->output, player->output_len);
+            played += player->output_len;
+            player->output_len = 0;
+        }
     }
 
-    // Multiply single sinewave to desired duration
-
-    uint32_t duration_total = duration_us * AUDIO_OUTPUT_SAMPLE_FREQ / 1000000;
+    return played;
+}
 
-    // Multiply duration by 2 because we point to u_int8_t and write int16_t
-    duration_total *= 2;
+// Write what is left in the output block
+// Returns amount of samples written to the output
+static size_t AUDIO_PlayFlush(AUDIO_WavPlayer_t *player)
+{
+    const size_t played = player->output_len;
 
-    ESP_LOGI(TAG, "AFSK duration_total: %" PRIu32 "", duration_total);
+    AUDIO_OutputWrite(player->output, player->output_len);
+    player->output_len = 0;
 
-    // for (int i = 0; i < sizeof(data)/sizeof(uint8_t); i++)
-    //     for (int bit = 7; bit >= 0; bit--)
-    //     {
-    //         if ((data[i] >> bit) & 1)
-    //         {
-    //             ESP_LOGI(TAG, "1");
-    //         }
-    //         else
-    //         {
-    //             ESP_LOGI(TAG, "0");
-    //         }
-    //     }
+    return played;
+}
 
-    pwm_audio_apply_settings();
+// Stream IMA ADPCM blocks decoding them piece by piece into the scratch buffer
+// and resampling them to the output rate
+// Returns amount of samples played
+static size_t AUDIO_PlayAdpcm(FILE *fd, uint8_t *buffer, size_t buffer_size, size_t block_align, size_t samples_left, AUDIO_WavPlayer_t *player)
+{
+    // First part of the buffer holds the codes, decoded samples (two per code byte and the header one) go after it
+    const size_t codes_size = buffer_size / 8;
+    uint8_t *codes = buffer;
+    int16_t *samples = (int16_t *)&buffer[buffer_size / 4];
+    ADPCM_State_t state;
+    size_t played = 0;
+
+    while (samples_left > 0 && !atomic_load(&playCancelled) && fread(codes, 1, ADPCM_BLOCK_HEADER_SIZE, fd) == ADPCM_BLOCK_HEADER_SIZE)
+    {
+        size_t block_left = block_align - ADPCM_BLOCK_HEADER_SIZE;
+        size_t count = 1;
 
-    pwm_audio_start();
+        samples[0] = ADPCM_DecodeHeader(&state, codes);
 
-    for (int i = 0; i < len; i++)
-        for (int bit = 7; bit >= 0; bit--)
+        while (block_left > 0 && samples_left > 0)
         {
-            if ((data[i] >> bit) & 1)
-            {
+            const size_t len = fread(codes, 1, MIN(block_left, codes_size), fd);
 
-                for (int tot_bytes = 0; tot_bytes < duration_total; tot_bytes += w_bytes)
-                {
-                    // Play the tone one
-                    if (pwm_audio_write((u_int8_t *)w_buf_one, duration_sine_one * sizeof(int16_t), &w_bytes, 1000 / portTICK_PERIOD_MS) != ESP_OK)
-                    {
-                        printf("Write Task: i2s write failed\n");
-                    }
-                }
-            }
-            else
+            if (len == 0)
             {
-                for (int tot_bytes = 0; tot_bytes < duration_total; tot_bytes += w_bytes)
-                {
-                    // Play the tone zero
-                    if (pwm_audio_write((u_int8_t *)w_buf_zero, duration_sine_zero * sizeof(int16_t), &w_bytes, 1000 / portTICK_PERIOD_MS) != ESP_OK)
-                    {
-                        printf("Write Task: i2s write failed\n");
-                    }
-                }
+                return played + AUDIO_PlayFlush(player);
             }
+
+            count = MIN(count + ADPCM_Decode(&state, codes, len, &samples[count]), samples_left);
+            played += AUDIO_PlayResampled(player, samples, count);
+
+            block_left -= len;
+            samples_left -= count;
+            count = 0;
         }
+    }
 
-    // Stop audio
-    pwm_audio_stop();
+    return played + AUDIO_PlayFlush(player);
+}
 
-    // Deallocate temp buffer
-    free(w_buf_zero);
-    free(w_buf_one);
+#if CONFIG_AUDIO_RECORDER_CODEC2
+// Decode Codec2 frames following the header into the scratch buffer
+// Returns amount of samples played
+static size_t AUDIO_PlayCodec2(FILE *fd, uint8_t *buffer, uint8_t mode)
+{
+    struct CODEC2 *codec2 = codec2_create(mode);
+    size_t played = 0;
+
+    if (codec2 == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create Codec2 decoder for mode %d", mode);
+        return 0;
+    }
+
+    const size_t frame_bytes = codec2_bytes_per_frame(codec2);
+    const size_t frame_samples = codec2_samples_per_frame(codec2);
+    // Frame bits go first, decoded samples after them
+    int16_t *samples = (int16_t *)&buffer[AUDIO_CODEC2_MAX_FRAME_BYTES];
+
+    if (frame_bytes > AUDIO_CODEC2_MAX_FRAME_BYTES || frame_samples > AUDIO_CODEC2_MAX_FRAME_SAMPLES)
+    {
+        ESP_LOGE(TAG, "Unsupported Codec2 mode %d", mode);
+        codec2_destroy(codec2);
+        return 0;
+    }
+
+    while (!atomic_load(&playCancelled) && fread(buffer, 1, frame_bytes, fd) == frame_bytes)
+    {
+        codec2_decode(codec2, samples, buffer);
+        AUDIO_OutputWrite(samples, frame_samples);
+        played += frame_samples;
+    }
+
+    codec2_destroy(codec2);
+
+    return played;
+}
+#endif
+
+// Convert data_bytes of PCM frames to 16-bit mono and resample them to the output rate, a block at a time
+// Returns amount of samples played
+static size_t AUDIO_PlayPcm(FILE *fd, uint8_t *buffer, size_t buffer_size, size_t data_bytes, uint16_t bits, uint16_t channels, AUDIO_WavPlayer_t *player)
+{
+    const size_t frame_size = channels * bits / 8;
+    const size_t frames_max = MIN(buffer_size / frame_size, AUDIO_WAV_BLOCK_FRAMES);
+    size_t frames_left = data_bytes / frame_size;
+    size_t played = 0;
+    size_t frames;
+
+    while (frames_left > 0 && !atomic_load(&playCancelled) && (frames = fread(buffer, frame_size, MIN(frames_left, frames_max), fd)) > 0)
+    {
+        frames_left -= frames;
+
+        PCM_ToMono16(buffer, frames, bits, channels, player->samples);
+        played += AUDIO_PlayResampled(player, player->samples, frames);
+    }
+
+    return played + AUDIO_PlayFlush(player);
 }
 
 esp_err_t AUDIO_PlayWav(const char *filepath)
@@ -866,58 +2089,96 @@ esp_err_t AUDIO_PlayWav(const char *filepath)
         return ESP_FAIL;
     }
 
-    /**
-     * read head of WAV file
-     */
-    wav_header_t wav_head;
-    int len = fread(&wav_head, 1, sizeof(wav_header_t), fd);
-    if (len <= 0)
+    // Codec2 recordings are raw frames after a short header of their own
+    c2_header_t c2_head;
+
+    if (fread(&c2_head, 1, sizeof(c2_header_t), fd) == sizeof(c2_header_t) && memcmp(c2_head.magic, AUDIO_C2_MAGIC, 3) == 0)
     {
-        ESP_LOGE(TAG, "Read wav header failed");
+#if CONFIG_AUDIO_RECORDER_CODEC2
+        pwm_audio_apply_settings();
+        pwm_audio_set_param(AUDIO_CODEC2_SAMPLE_FREQ, AUDIO_OUTPUT_BITS_PER_SAMPLE, 1);
+        pwm_audio_start();
+
+        const size_t played = AUDIO_PlayCodec2(fd, buffer, c2_head.mode);
+
+        pwm_audio_stop();
+        fclose(fd);
+        free(buffer);
+
+        ESP_LOGI(TAG, "File reading complete, total: %d samples", played);
+        return ESP_OK;
+#else
+        ESP_LOGE(TAG, "Codec2 support is disabled (CONFIG_AUDIO_RECORDER_CODEC2)");
         fclose(fd);
+        free(buffer);
         return ESP_FAIL;
+#endif
     }
-    if (NULL == strstr((char *)wav_head.Subchunk1ID, "fmt") &&
-        NULL == strstr((char *)wav_head.Subchunk2ID, "data"))
+
+    // Leaves the file at the start of the audio data
+    WAV_Info_t wav;
+
+    if (WAV_Parse(fd, &wav) != ESP_OK)
     {
         ESP_LOGE(TAG, "Header of wav format error");
         fclose(fd);
+        free(buffer);
         return ESP_FAIL;
     }
 
-    ESP_LOGI(TAG, "frame_rate= %" PRIi32 ", ch=%d, width=%d", wav_head.SampleRate, wav_head.NumChannels, wav_head.BitsPerSample);
+    ESP_LOGI(TAG, "frame_rate= %" PRIu32 ", ch=%d, width=%d, data=%" PRIu32 " bytes at %" PRIu32,
+             wav.sample_rate, wav.channels, wav.bits, wav.data_len, wav.data_offset);
 
     pwm_audio_apply_settings();
 
-    pwm_audio_start();
-
-    /**
-     * read wave data of WAV file
-     */
-    size_t write_num = 0;
-    size_t cnt;
-
-    do
+    if (wav.format == AUDIO_WAV_FORMAT_IMA_ADPCM)
     {
-        /* Read file in chunks into the scratch buffer */
-        len = fread(buffer, 1, chunk_size, fd);
-        if (len <= 0)
+        if (wav.channels != 1 || wav.block_align <= ADPCM_BLOCK_HEADER_SIZE)
         {
-            break;
+            ESP_LOGE(TAG, "Unsupported IMA ADPCM wav layout");
+            fclose(fd);
+            free(buffer);
+            return ESP_FAIL;
         }
-        pwm_audio_write(buffer, len, &cnt, 1000 / portTICK_PERIOD_MS);
+    }
+    else if (wav.format != AUDIO_WAV_FORMAT_PCM ||
+             !PCM_Supported(wav.bits, wav.channels) ||
+             wav.block_align != wav.channels * wav.bits / 8)
+    {
+        ESP_LOGE(TAG, "Unsupported wav format %d, %d channels of %d bits", wav.format, wav.channels, wav.bits);
+        fclose(fd);
+        free(buffer);
+        return ESP_FAIL;
+    }
+
+    AUDIO_WavPlayer_t *player = malloc(sizeof(AUDIO_WavPlayer_t));
+
+    if (player == NULL || !RESAMPLER_Init(&player->resampler, wav.sample_rate, AUDIO_OUTPUT_SAMPLE_FREQ))
+    {
+        ESP_LOGE(TAG, "Unsupported wav sample rate %" PRIu32 " Hz or out of memory", wav.sample_rate);
+        fclose(fd);
+        free(buffer);
+        free(player);
+        return ESP_FAIL;
+    }
+
+    player->output_len = 0;
+    pwm_audio_start();
 
-        write_num += len;
-    } while (1);
+    // Both are resampled, so files of any supported rate play at the right speed and pitch
+    const size_t played = (wav.format == AUDIO_WAV_FORMAT_IMA_ADPCM)
+                              ? AUDIO_PlayAdpcm(fd, buffer, chunk_size, wav.block_align, WAV_Samples(&wav), player)
+                              : AUDIO_PlayPcm(fd, buffer, chunk_size, wav.data_len, wav.bits, wav.channels, player);
 
     // Stop audio
     pwm_audio_stop();
     // Close file
     fclose(fd);
-    // Deallocate temp buffer
+    // Deallocate temp buffers
     free(buffer);
+    free(player);
 
-    ESP_LOGI(TAG, "File reading complete, total: %d bytes", write_num);
+    ESP_LOGI(TAG, "File reading complete, total: %d samples", played);
     return ESP_OK;
 }
 
@@ -950,18 +2211,15 @@ void AUDIO_Init(void)
     transmitSemaphore = xSemaphoreCreateBinary();
     xSemaphoreGive(transmitSemaphore);
 
-    receiveSemaphore = xSemaphoreCreateBinary();
-    xSemaphoreGive(receiveSemaphore);
+    // Initialize audio input bus
+    BUS_Init(&gAudioBus, AUDIO_BusNotify);
 
-    // Create ADC ring buffer to store ADC samples (FIFO)
-    adcRingBufferHandle = xRingbufferCreate(AUDIO_ADC_RING_BUFFER_SIZE, AUDIO_ADC_RING_BUFFER_TYPE);
-    if (adcRingBufferHandle == NULL)
-    {
-        ESP_LOGE(TAG, "Failed to create ADC ring buffer");
-    }
-    else
+    // Init DC tracker and squelch
+    RX_IngestInit(&ingest, AUDIO_DC_TRACKER_SHIFT, AUDIO_SQUELCH_ATTACK_BLOCKS, (AUDIO_SQUELCH_HANG_MS * AUDIO_INPUT_SAMPLE_FREQ) / 1000, AUDIO_CycleCount);
+    // Continue from the last known DC value if there is one
+    if (gSettings.calibration.adc.is_valid == SETTINGS_TRUE)
     {
-        ESP_LOGI(TAG, "ADC ring buffer initialized");
+        DC_Seed(&ingest.dc, gSettings.calibration.adc.value);
     }
 
     initialize_pwm_audio();
@@ -17,37 +17,59 @@
 #ifndef HARDWARE_AUDIO_H
 #define HARDWARE_AUDIO_H
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
 #include <driver/i2s_pdm.h>
+#include <soc/soc_caps.h>
 
 #include "board.h"
+#include "dsp/bus.h"
+#include "dsp/pipeline.h"
+#include "helper/wav.h"
 
 // --- Audio input ---
 
 // Define audio ADC data type representing single audio sample
-#define AUDIO_ADC_DATA_TYPE uint16_t
+#define AUDIO_ADC_DATA_TYPE int16_t
 // Define chunk size for audio input we process at a time
 #define AUDIO_INPUT_CHUNK_SIZE 2048
+// Define max amount of samples decoded from single ADC chunk (one block is published to the audio bus at a time)
+#define AUDIO_INPUT_BLOCK_SIZE (AUDIO_INPUT_CHUNK_SIZE / (SOC_ADC_DIGI_RESULT_BYTES * AUDIO_INPUT_MIN_UPSAMPLE_FACTOR))
 // Define audio input max buffer size
 #define AUDIO_INPUT_MAX_BUFF_SIZE AUDIO_INPUT_CHUNK_SIZE * 1
-// Define ADC ring buffer size
-#define AUDIO_ADC_RING_BUFFER_SIZE AUDIO_INPUT_CHUNK_SIZE * 4
-// Define ADC ring buffer type
-#define AUDIO_ADC_RING_BUFFER_TYPE RINGBUF_TYPE_BYTEBUF
+// Define how long audio input consumers wait for a new block before giving up
+#define AUDIO_INPUT_BLOCK_TIMEOUT_MS 1000
 // Define audio input sampling frequency in Hz
 #define AUDIO_INPUT_SAMPLE_FREQ 32000
-// Defines how many ADC measurements will be taken per single sample (sample is mean value of all the measurements)
-#define AUDIO_INPUT_UPSAMPLE_FACTOR 2
-// Determine whether to digitally filter the audio input recorded
-// #define AUDIO_RECORDER_FILTER_ENABLED
-#ifdef AUDIO_RECORDER_FILTER_ENABLED
-// Define 1st order lowpass filter cutoff frequency
-#define AUDIO_INPUT_LPF_1_FREQ 4600
-// Define 2nd order lowpass filter cutoff frequency
-#define AUDIO_INPUT_LPF_2_FREQ 2300
-// Define 3rd order lowpass filter cutoff frequency
-#define AUDIO_INPUT_LPF_3_FREQ 2000
-// Define highpass filter cutoff frequency
-#define AUDIO_INPUT_HPF_FREQ 300
+// Defines how many ADC measurements will be taken per single sample when the setting is invalid,
+// ADC runs at AUDIO_INPUT_SAMPLE_FREQ * factor and the decimator filters it down to AUDIO_INPUT_SAMPLE_FREQ
+#define AUDIO_INPUT_DEFAULT_UPSAMPLE_FACTOR 2
+// Defines lowest supported upsample factor (largest amount of samples per ADC chunk)
+#define AUDIO_INPUT_MIN_UPSAMPLE_FACTOR 2
+// Define max pre-roll length in ms (audio from before the squelch opened kept in recordings)
+#define AUDIO_RECORDER_PREROLL_MAX_MS 2000
+// Define largest recording file, RIFF sizes have to fit into int32_t fields of wav_header_t
+#define AUDIO_RECORDER_MAX_FILE_SIZE 0x7FFFFFFF
+// Define amount of the oldest recordings the storage cleanup collects in a single directory scan
+#define AUDIO_RECORDER_CLEANUP_BATCH 8
+// Define name of the logger index file, kept in the logger directory
+#define AUDIO_LOGGER_INDEX_FILENAME "index.bin"
+// Define extension of the files written by the logger
+#define AUDIO_LOGGER_FILE_EXT ".wav"
+#define AUDIO_LOGGER_CODEC2_FILE_EXT ".c2"
+// Define length of the logger file name without the extension, YYYYmmdd_HHMMSS_mmm
+#define AUDIO_LOGGER_NAME_LEN 19
+// Define sample rate Codec2 works at
+#define AUDIO_CODEC2_SAMPLE_FREQ 8000
+// Define largest Codec2 frame in samples (40ms at 1600bps)
+#define AUDIO_CODEC2_MAX_FRAME_SAMPLES 320
+// Define largest Codec2 frame in bytes
+#define AUDIO_CODEC2_MAX_FRAME_BYTES 8
+// Define stack size of the tasks recording and playing audio, Codec2 keeps its frame analysis on the stack
+#if CONFIG_AUDIO_RECORDER_CODEC2
+#define AUDIO_TASK_STACK_SIZE (16 * 1024)
+#else
+#define AUDIO_TASK_STACK_SIZE 4096
 #endif
 // Define initial gain used for incoming audio
 #define AUDIO_INPUT_AGC_INITIAL_GAIN 10
@@ -55,8 +77,8 @@
 // continous ADC driver samples at 80% of the advertised frequency
 // this value increases the sample frequency by 25% to counter that issue
 #define AUDIO_INPUT_SAMPLE_RATE_WORKAROUND 1.25
-// Define amount of samples used for ADC calibration
-#define AUDIO_ADC_CALIBRATION_SAMPLES AUDIO_INPUT_SAMPLE_FREQ / 2
+// Define DC tracker time constant as a power of 2 of input blocks, 8 gives roughly 4 seconds
+#define AUDIO_DC_TRACKER_SHIFT 8
 // Define ADC conv mode
 #define AUDIO_ADC_CONV_MODE ADC_CONV_SINGLE_UNIT_1
 // Define ADC output type
@@ -65,13 +87,14 @@
 #define AUDIO_ADC_ATTEN ADC_ATTEN_DB_12 // ADC_ATTEN_DB_12 allows to measure 0-3.3V
 // Define ADC bit width
 #define AUDIO_ADC_BIT_WIDTH SOC_ADC_DIGI_MAX_BITWIDTH
-#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
-#define AUDIO_ADC_GET_CHANNEL(p_data)     ((p_data)->type1.channel)
-#define AUDIO_ADC_GET_DATA(p_data)        ((p_data)->type1.data)
-#else
-#define AUDIO_ADC_GET_CHANNEL(p_data)     ((p_data)->type2.channel)
-#define AUDIO_ADC_GET_DATA(p_data)        ((p_data)->type2.data)
-#endif
+// Define amount of consecutive blocks over the squelch threshold needed to open the squelch
+#define AUDIO_SQUELCH_ATTACK_BLOCKS 1
+// Define how long the squelch stays open after the signal drops under the threshold in ms
+#define AUDIO_SQUELCH_HANG_MS 2000
+// Define task notification index used to wake up audio bus consumers, needs CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES above it
+#define AUDIO_BUS_NOTIFY_INDEX 1
+// Define how often ingest statistics are reported in ms
+#define AUDIO_INGEST_STATS_INTERVAL_MS 2000
 
 // --- Audio output ---
 
@@ -82,6 +105,12 @@
 #define AUDIO_OUTPUT_SAMPLE_FREQ 32000
 // Bits per sample
 #define AUDIO_OUTPUT_BITS_PER_SAMPLE 16
+// Define amount of samples the synthesizers render per output write, 20ms
+#define AUDIO_OUTPUT_BLOCK_SAMPLES (AUDIO_OUTPUT_SAMPLE_FREQ / 50)
+// Define max amount of wav frames converted at once, the resampler turns them into output blocks
+#define AUDIO_WAV_BLOCK_FRAMES 512
+// Define length of the tone attack and decay ramps in ms
+#define AUDIO_TONE_RAMP_MS 5
 // volume * AUDIO_VOLUME_MULTIPLIER = 1~32767, affects the volume
 #define AUDIO_VOLUME_MULTIPLIER (320.0)
 // Modulation constraints
@@ -99,7 +128,10 @@ typedef enum
 {
     BIT_STOP_LISTEN = (1 << 0), // used to request the listen task to stop listening, needed for audio transmit
     BIT_STOPPED_LISTENING = (1 << 1), // used to indicate that listen task stopped listening
-    BIT_DONE_TX = (1 << 2) // used to indicate that audio tx is done
+    BIT_DONE_TX = (1 << 2), // used to indicate that audio tx is done
+    BIT_SQUELCH_OPEN = (1 << 3), // set while the squelch is open
+    BIT_SQUELCH_CHANGED = (1 << 4), // set by the listen task each time the squelch opens or closes
+    BIT_STOP_RECORD = (1 << 5) // used to request the record task to finish the recording
 } AudioEventBit_t;
 
 typedef enum
@@ -129,26 +161,122 @@ typedef struct
     int32_t Subchunk2Size;
 } wav_header_t;
 
+// Define wav AudioFormat values
+#define AUDIO_WAV_FORMAT_PCM WAV_FORMAT_PCM
+#define AUDIO_WAV_FORMAT_IMA_ADPCM WAV_FORMAT_IMA_ADPCM
+
+// IMA ADPCM wav header, the format needs extended "fmt " and "fact" chunks
+typedef struct
+{
+    uint8_t ChunkID[4];
+    int32_t ChunkSize;
+    uint8_t Format[4];
+    // The "fmt" sub-chunk
+    uint8_t Subchunk1ID[4];
+    int32_t Subchunk1Size;
+    int16_t AudioFormat;
+    int16_t NumChannels;
+    int32_t SampleRate;
+    int32_t ByteRate;
+    int16_t BlockAlign;
+    int16_t BitsPerSample;
+    int16_t ExtraSize;
+    int16_t SamplesPerBlock;
+    // The "fact" sub-chunk
+    uint8_t FactID[4];
+    int32_t FactSize;
+    int32_t SampleLength;
+    uint8_t Subchunk2ID[4];
+    int32_t Subchunk2Size;
+} wav_ima_adpcm_header_t;
+
+// Codec2 file header, same as written by the codec2 c2enc tool, frames follow it directly
+typedef struct
+{
+    uint8_t magic[3];      // 0xc0 0xde 0xc2
+    uint8_t version_major;
+    uint8_t version_minor;
+    uint8_t mode;          // codec2 mode i.e CODEC2_MODE_3200
+    uint8_t flags;
+} c2_header_t;
+
+// Define Codec2 file header values
+#define AUDIO_C2_MAGIC "\xc0\xde\xc2"
+#define AUDIO_C2_VERSION_MAJOR 1
+#define AUDIO_C2_VERSION_MINOR 0
+// Define codec2 mode numbers stored in the header
+#define AUDIO_C2_MODE_3200 0
+#define AUDIO_C2_MODE_1600 2
+
+typedef enum
+{
+    AUDIO_RECORD_FORMAT_PCM,         // 16-bit PCM
+    AUDIO_RECORD_FORMAT_IMA_ADPCM,   // 4-bit IMA ADPCM, 4 times smaller
+    AUDIO_RECORD_FORMAT_CODEC2_3200, // Codec2 3200bps at 8kHz, .c2 file, needs CONFIG_AUDIO_RECORDER_CODEC2
+    AUDIO_RECORD_FORMAT_CODEC2_1600, // Codec2 1600bps at 8kHz, .c2 file, needs CONFIG_AUDIO_RECORDER_CODEC2
+    AUDIO_RECORD_FORMAT_LAST
+} AUDIO_RecordFormat_t;
+
 typedef struct
 {
     char        filepath[64]; // filepath under which the file will be saved i.e 'sample.wav' or 'recordings/1.wav'
-    uint16_t    duration_sec; // desired recording length in seconds
+    uint16_t    duration_sec; // desired recording length in seconds, 0 records until stopped
+    uint16_t    segment_sec;  // start next numbered file i.e 'log_00002.wav' after this many seconds, 0 disables the time limit
+    uint16_t    segment_mb;   // start next numbered file once the current one reaches this size in MB, 0 disables the size limit
+    uint16_t    min_free_mb;  // delete the oldest segments or logger files to keep this much free space in MB, 0 disables the cleanup
+    uint16_t    format;       // AUDIO_RecordFormat_t - file encoding
+    uint16_t    logger;       // SETTINGS_Bool_t - filepath is a directory, each transmission is recorded to its own timestamped file
+    uint16_t    sample_rate;  // sample rate of the recording in Hz: 32000, 16000 or 8000, Codec2 is always 8000
 } AUDIO_RecordParam_t;
 
+// Logger index record, one is appended to AUDIO_LOGGER_INDEX_FILENAME per transmission.
+// Records have fixed size, so the list of transmissions can be read without scanning the directory.
+typedef struct
+{
+    int64_t     start_ms;     // wall clock time of the first recorded sample in ms since epoch (since boot if the clock is not set)
+    uint32_t    duration_ms;  // length of the recording including the pre-roll
+    uint32_t    offset;       // byte offset of the audio data in the file
+    uint16_t    peak;         // peak absolute sample value
+    uint16_t    format;       // AUDIO_RecordFormat_t - file encoding
+    char        filename[44]; // file name within the logger directory
+} AUDIO_LoggerEntry_t;
+
+// Tone played by AUDIO_PlayTones
+typedef struct
+{
+    uint16_t freq;        // frequency in Hz, 0 is silence
+    uint16_t duration_ms; // tone length
+} AUDIO_Tone_t;
+
+// Fills up to max samples at AUDIO_OUTPUT_SAMPLE_FREQ for AUDIO_PlayStream, returning 0 ends the stream
+typedef size_t (*AUDIO_StreamCallback_t)(int16_t *samples, size_t max, void *arg);
+
 extern AudioState_t gAudioState;
+// Audio event bits, see AudioEventBit_t
+extern EventGroupHandle_t audioEventGroup;
+// Audio input bus, each consumer reads decoded blocks with its own cursor
+extern BUS_t gAudioBus;
+// Receive path processing chain, rebuilt from settings when recording starts
+extern PIPELINE_t gAudioPipeline;
 
 esp_err_t AUDIO_TransmitStart(void);
 esp_err_t AUDIO_TransmitStop(void);
 void AUDIO_Listen(void *pvParameters);
 void AUDIO_PlayTone(uint16_t freq, uint16_t duration_ms);
+void AUDIO_PlayTones(const AUDIO_Tone_t *tones, size_t count);
 void AUDIO_PlayAFSK(const uint8_t *data, size_t len, uint16_t baud, uint16_t zero_freq, uint16_t one_freq);
+void AUDIO_PlayAFSKLine(const uint8_t *bits, size_t count, uint16_t baud, uint16_t zero_freq, uint16_t one_freq);
+void AUDIO_PlayStream(AUDIO_StreamCallback_t callback, void *arg);
+void AUDIO_SetPlayCancelled(bool cancelled);
 void AUDIO_Init(void);
 void AUDIO_AdcStop(void);
 esp_err_t AUDIO_PlayWav(const char *filepath);
-void AUDIO_AdcCalibrate(void *pvParameters);
-void AUDIO_EmptyAdcRingBuffer(void *pvParameters);
+BUS_Consumer_t *AUDIO_Subscribe(const char *name);
+void AUDIO_Unsubscribe(BUS_Consumer_t *consumer);
+const BUS_Block_t *AUDIO_WaitBlock(BUS_Consumer_t *consumer, uint32_t timeout_ms);
 void AUDIO_SquelchControl(void *pvParameters);
 void AUDIO_Watchdog(void *pvParameters);
 void AUDIO_Record(void *pvParameters);
+void AUDIO_RecordStop(void);
 
 #endif
\ No newline at end of file
@@ -22,7 +22,7 @@
 
 /* Scratch buffer size */
 #define SCRATCH_BUFSIZE 8192
-#define HTTP_SERVER_MAX_URI_HANDLERS 20
+#define HTTP_SERVER_MAX_URI_HANDLERS 24
 
 extern httpd_handle_t gHttpServerHandle;
 
@@ -43,7 +43,7 @@ esp_err_t SD_Init(void)
     esp_vfs_fat_sdmmc_mount_config_t mount_config = {
         .format_if_mount_failed = true,
         .max_files = 4, // max number of open files
-        .allocation_unit_size = 32 * 1024};
+        .allocation_unit_size = SD_ALLOCATION_UNIT_SIZE};
 
     ESP_LOGI(TAG, "Initializing SD card");
 
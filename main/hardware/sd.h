@@ -18,6 +18,8 @@
 
 // base path for the SD card storage
 #define SD_BASE_PATH "/sd"
+// FAT cluster size used when formatting the SD card
+#define SD_ALLOCATION_UNIT_SIZE (32 * 1024)
 
 esp_err_t SD_Init(void);
 esp_err_t SD_Shutdown(void);
@@ -16,6 +16,7 @@
 
 #include <esp_err.h>
 #include <esp_spiffs.h>
+#include <esp_vfs_fat.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <string.h>
@@ -67,3 +68,24 @@ FILESYSTEM_Path_t get_path_type(const char *filepath)
         return FILESYSTEM_PATH_UNKNOWN;
     }
 }
+
+// returns free space of the filesystem the filepath belongs to
+esp_err_t get_free_space(const char *filepath, uint64_t *free_bytes)
+{
+    size_t total = 0;
+    size_t used = 0;
+    uint64_t total_bytes = 0;
+    esp_err_t ret;
+
+    switch (get_path_type(filepath))
+    {
+    case FILESYSTEM_PATH_FLASH:
+        ret = esp_spiffs_info(NULL, &total, &used);
+        *free_bytes = (total > used) ? total - used : 0;
+        return ret;
+    case FILESYSTEM_PATH_SD:
+        return esp_vfs_fat_info(SD_BASE_PATH, &total_bytes, free_bytes);
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
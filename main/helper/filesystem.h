@@ -17,6 +17,7 @@
 #ifndef HELPER_FILESYSTEM_H
 #define HELPER_FILESYSTEM_H
 
+#include <stdint.h>
 #include <esp_err.h>
 
 typedef enum
@@ -28,5 +29,6 @@ typedef enum
 
 esp_err_t delete_file(const char *filepath);
 FILESYSTEM_Path_t get_path_type(const char *filepath);
+esp_err_t get_free_space(const char *filepath, uint64_t *free_bytes);
 
 #endif
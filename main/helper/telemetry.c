@@ -0,0 +1,112 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "telemetry.h"
+
+// Each stage is recorded by single task only, readers may see partially updated statistics which is fine for diagnostics
+static TELEMETRY_Stage_t stages[TELEMETRY_STAGE_LAST];
+static uint32_t counters[TELEMETRY_COUNTER_LAST];
+
+static const char *stageNames[TELEMETRY_STAGE_LAST] = {
+    "adc_read",
+    "decode",
+    "decimate",
+    "dc",
+    "squelch",
+    "publish",
+    "pipeline",
+    "file_write",
+    "demod",
+    "cw"};
+
+static const char *counterNames[TELEMETRY_COUNTER_LAST] = {
+    "adc_dropped_frames",
+    "adc_invalid_samples",
+    "recorder_dropped_samples",
+    "writer_dropped_jobs"};
+
+/// @brief Record single latency measurement of the stage
+/// @param id stage
+/// @param cycles latency in CPU cycles
+void TELEMETRY_Record(TELEMETRY_StageId_t id, uint32_t cycles)
+{
+    TELEMETRY_Stage_t *stage = &stages[id];
+    // log2 of the latency, zero falls into the first bucket
+    uint32_t bucket = (cycles > 1) ? 31 - __builtin_clz(cycles) : 0;
+
+    if (bucket >= TELEMETRY_HISTOGRAM_BUCKETS)
+    {
+        bucket = TELEMETRY_HISTOGRAM_BUCKETS - 1;
+    }
+
+    stage->count++;
+    stage->total_cycles += cycles;
+    stage->histogram[bucket]++;
+
+    if (cycles > stage->max_cycles)
+    {
+        stage->max_cycles = cycles;
+    }
+}
+
+/// @brief Increase event counter
+/// @param id counter
+/// @param amount amount of events
+void TELEMETRY_Count(TELEMETRY_CounterId_t id, uint32_t amount)
+{
+    counters[id] += amount;
+}
+
+/// @brief Get latency statistics of the stage
+/// @param id stage
+/// @return statistics accumulated since boot or last reset
+const TELEMETRY_Stage_t *TELEMETRY_GetStage(TELEMETRY_StageId_t id)
+{
+    return &stages[id];
+}
+
+/// @brief Get event counter
+/// @param id counter
+/// @return amount of events since boot or last reset
+uint32_t TELEMETRY_GetCounter(TELEMETRY_CounterId_t id)
+{
+    return counters[id];
+}
+
+/// @brief Get stage name used for reporting
+/// @param id stage
+/// @return stage name
+const char *TELEMETRY_StageName(TELEMETRY_StageId_t id)
+{
+    return stageNames[id];
+}
+
+/// @brief Get counter name used for reporting
+/// @param id counter
+/// @return counter name
+const char *TELEMETRY_CounterName(TELEMETRY_CounterId_t id)
+{
+    return counterNames[id];
+}
+
+/// @brief Clear all statistics and counters
+void TELEMETRY_Reset(void)
+{
+    memset(stages, 0, sizeof(stages));
+    memset(counters, 0, sizeof(counters));
+}
@@ -0,0 +1,69 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef HELPER_TELEMETRY_H
+#define HELPER_TELEMETRY_H
+
+#include <stdint.h>
+
+// Define amount of log2 latency histogram buckets, bucket n counts latencies of 2^n to 2^(n+1)-1 cycles
+// the last one also counts everything longer
+#define TELEMETRY_HISTOGRAM_BUCKETS 24
+
+// Measured stages of the audio path
+typedef enum
+{
+    TELEMETRY_STAGE_ADC_READ,
+    TELEMETRY_STAGE_DECODE,
+    TELEMETRY_STAGE_DECIMATE,
+    TELEMETRY_STAGE_DC,
+    TELEMETRY_STAGE_SQUELCH,
+    TELEMETRY_STAGE_PUBLISH,
+    TELEMETRY_STAGE_PIPELINE,
+    TELEMETRY_STAGE_FILE_WRITE,
+    TELEMETRY_STAGE_DEMOD,
+    TELEMETRY_STAGE_CW,
+    TELEMETRY_STAGE_LAST
+} TELEMETRY_StageId_t;
+
+// Event counters of the audio path
+typedef enum
+{
+    TELEMETRY_COUNTER_ADC_DROPPED_FRAMES,
+    TELEMETRY_COUNTER_ADC_INVALID_SAMPLES,
+    TELEMETRY_COUNTER_RECORDER_DROPPED_SAMPLES,
+    TELEMETRY_COUNTER_WRITER_DROPPED_JOBS,
+    TELEMETRY_COUNTER_LAST
+} TELEMETRY_CounterId_t;
+
+// Latency statistics of single stage (in CPU cycles)
+typedef struct
+{
+    uint32_t count;        // amount of measurements
+    uint32_t max_cycles;   // longest measurement
+    uint64_t total_cycles; // sum of all measurements
+    uint32_t histogram[TELEMETRY_HISTOGRAM_BUCKETS];
+} TELEMETRY_Stage_t;
+
+void TELEMETRY_Record(TELEMETRY_StageId_t id, uint32_t cycles);
+void TELEMETRY_Count(TELEMETRY_CounterId_t id, uint32_t amount);
+const TELEMETRY_Stage_t *TELEMETRY_GetStage(TELEMETRY_StageId_t id);
+uint32_t TELEMETRY_GetCounter(TELEMETRY_CounterId_t id);
+const char *TELEMETRY_StageName(TELEMETRY_StageId_t id);
+const char *TELEMETRY_CounterName(TELEMETRY_CounterId_t id);
+void TELEMETRY_Reset(void);
+
+#endif
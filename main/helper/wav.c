@@ -0,0 +1,160 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "wav.h"
+#include "dsp/adpcm.h"
+
+// Define size of the RIFF header, "RIFF", its size and "WAVE"
+#define WAV_RIFF_HEADER_SIZE 12
+// Define size of the chunk header, id and size
+#define WAV_CHUNK_HEADER_SIZE 8
+// Define size of the plain "fmt " chunk
+#define WAV_FMT_SIZE 16
+// Define size of the WAVE_FORMAT_EXTENSIBLE "fmt " chunk
+#define WAV_FMT_EXTENSIBLE_SIZE 40
+// Define offset of the subformat GUID in the "fmt " chunk, its first two bytes are the AudioFormat
+#define WAV_FMT_SUBFORMAT_OFFSET 24
+
+static uint16_t WAV_Read16(const uint8_t *data)
+{
+    return data[0] | data[1] << 8;
+}
+
+static uint32_t WAV_Read32(const uint8_t *data)
+{
+    return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+// Fill info from the "fmt " chunk contents
+static void WAV_ParseFmt(const uint8_t *fmt, size_t len, WAV_Info_t *info)
+{
+    info->format = WAV_Read16(&fmt[0]);
+    info->channels = WAV_Read16(&fmt[2]);
+    info->sample_rate = WAV_Read32(&fmt[4]);
+    info->block_align = WAV_Read16(&fmt[12]);
+    info->bits = WAV_Read16(&fmt[14]);
+
+    if (info->format == WAV_FORMAT_EXTENSIBLE && len >= WAV_FMT_EXTENSIBLE_SIZE)
+    {
+        info->format = WAV_Read16(&fmt[WAV_FMT_SUBFORMAT_OFFSET]);
+    }
+}
+
+// Locate the "fmt " and "data" chunks of a wav file, skipping any others i.e "LIST" or "fact" by seeking over them
+// Returns ESP_OK with the file positioned at the start of the audio data
+esp_err_t WAV_Parse(FILE *fd, WAV_Info_t *info)
+{
+    uint8_t chunk[WAV_FMT_EXTENSIBLE_SIZE];
+    bool fmt_found = false;
+    bool data_found = false;
+
+    memset(info, 0, sizeof(WAV_Info_t));
+
+    if (fseek(fd, 0, SEEK_END) != 0)
+    {
+        return ESP_FAIL;
+    }
+
+    const long file_size = ftell(fd);
+
+    if (file_size < WAV_RIFF_HEADER_SIZE || fseek(fd, 0, SEEK_SET) != 0 ||
+        fread(chunk, 1, WAV_RIFF_HEADER_SIZE, fd) != WAV_RIFF_HEADER_SIZE ||
+        memcmp(&chunk[0], "RIFF", 4) != 0 || memcmp(&chunk[8], "WAVE", 4) != 0)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    uint32_t position = WAV_RIFF_HEADER_SIZE;
+
+    while (!(fmt_found && data_found) && (long)position + WAV_CHUNK_HEADER_SIZE <= file_size &&
+           fread(chunk, 1, WAV_CHUNK_HEADER_SIZE, fd) == WAV_CHUNK_HEADER_SIZE)
+    {
+        const uint32_t size = WAV_Read32(&chunk[4]);
+        const uint32_t contents = position + WAV_CHUNK_HEADER_SIZE;
+
+        if (memcmp(chunk, "fmt ", 4) == 0)
+        {
+            const size_t len = size < sizeof(chunk) ? size : sizeof(chunk);
+
+            if (size < WAV_FMT_SIZE || fread(chunk, 1, len, fd) != len)
+            {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+
+            WAV_ParseFmt(chunk, len, info);
+            fmt_found = true;
+        }
+        else if (memcmp(chunk, "fact", 4) == 0 && size >= 4)
+        {
+            if (fread(chunk, 1, 4, fd) != 4)
+            {
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+
+            info->sample_length = WAV_Read32(chunk);
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            // Recordings in progress declare more data than has been written so far
+            info->data_offset = contents;
+            info->data_len = ((uint64_t)size <= (uint64_t)(file_size - contents)) ? size : (uint32_t)(file_size - contents);
+            data_found = true;
+        }
+
+        // Chunks are padded to even size, the next one may start past the end of a truncated file
+        const uint64_t next = (uint64_t)contents + size + (size & 1);
+
+        if (next > (uint64_t)file_size || fseek(fd, (long)next, SEEK_SET) != 0)
+        {
+            break;
+        }
+
+        position = next;
+    }
+
+    if (!fmt_found || !data_found || info->channels == 0 || info->block_align == 0 || info->sample_rate == 0)
+    {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return (fseek(fd, info->data_offset, SEEK_SET) == 0) ? ESP_OK : ESP_FAIL;
+}
+
+// Amount of samples per channel in the "data" chunk
+// IMA ADPCM blocks are always whole, the "fact" chunk tells how much of the last one is padding
+uint32_t WAV_Samples(const WAV_Info_t *info)
+{
+    const uint32_t blocks = info->data_len / info->block_align;
+
+    if (info->format != WAV_FORMAT_IMA_ADPCM)
+    {
+        return blocks;
+    }
+
+    if (info->block_align <= ADPCM_BLOCK_HEADER_SIZE * info->channels)
+    {
+        return 0;
+    }
+
+    // Header holds the first sample, each code byte two more
+    const uint32_t samples = blocks * (1 + (info->block_align - ADPCM_BLOCK_HEADER_SIZE * info->channels) * 2 / info->channels);
+
+    return (info->sample_length > 0 && info->sample_length < samples) ? info->sample_length : samples;
+}
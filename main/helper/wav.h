@@ -0,0 +1,47 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#ifndef HELPER_WAV_H
+#define HELPER_WAV_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <esp_err.h>
+
+// Define wav AudioFormat values
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_IMA_ADPCM 0x11
+// Define AudioFormat of files describing the actual format in the subformat GUID
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+// Audio data of a wav file, found by walking its RIFF chunks
+typedef struct
+{
+    uint16_t format;        // AudioFormat i.e AUDIO_WAV_FORMAT_PCM, the subformat for WAV_FORMAT_EXTENSIBLE files
+    uint16_t channels;      // amount of interleaved channels
+    uint32_t sample_rate;   // sample rate in Hz
+    uint16_t block_align;   // bytes per frame, bytes per block for IMA ADPCM
+    uint16_t bits;          // bits per sample
+    uint32_t sample_length; // samples per channel from the "fact" chunk, 0 if there is none
+    uint32_t data_offset;   // byte offset of the "data" chunk contents in the file
+    uint32_t data_len;      // length of the "data" chunk contents, limited to what the file holds
+} WAV_Info_t;
+
+esp_err_t WAV_Parse(FILE *fd, WAV_Info_t *info);
+uint32_t WAV_Samples(const WAV_Info_t *info);
+
+#endif
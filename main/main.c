@@ -19,6 +19,11 @@
 #include "board.h"
 #include "system.h"
 #include "app/beacon.h"
+#include "app/writer.h"
+#include "app/waveform.h"
+#include "app/packet.h"
+#include "app/cwreader.h"
+#include "app/transmit.h"
 #include "helper/rtos.h"
 #include "hardware/audio.h"
 #include "hardware/button.h"
@@ -43,16 +48,28 @@ void app_main()
     // Audio listen task
     xTaskCreate(AUDIO_Listen, "AUDIO_Listen", 4096, NULL, RTOS_PRIORITY_HIGHEST, NULL);
 
-    // Audio empty ADC ring buffer task
-    xTaskCreate(AUDIO_EmptyAdcRingBuffer, "AUDIO_EmptyAdcRingBuffer", 2048, NULL, RTOS_PRIORITY_IDLE, NULL);
-
     // Audio watchdog    
     xTaskCreate(AUDIO_Watchdog, "AUDIO_Watchdog", 2048, NULL, RTOS_PRIORITY_IDLE, NULL);
 
     // Audio squelch control
     xTaskCreate(AUDIO_SquelchControl, "AUDIO_SquelchControl", 4096, NULL, RTOS_PRIORITY_MEDIUM, NULL);
 
-    // Create Morse code transmit task
+    // File writer task, keeps slow storage away from the audio tasks
+    xTaskCreate(WRITER_Task, "WRITER_Task", 4096, NULL, RTOS_PRIORITY_LOW, NULL);
+
+    // Waveform indexer, writes peaks sidecars of the recordings which have none
+    xTaskCreate(WAVEFORM_Task, "WAVEFORM_Task", 4096, NULL, RTOS_PRIORITY_IDLE, NULL);
+
+    // Packet decoder, consumes the audio input next to the recorder
+    xTaskCreate(PACKET_Task, "PACKET_Task", 4096, NULL, RTOS_PRIORITY_MEDIUM, NULL);
+
+    // CW decoder, consumes the audio input next to the recorder
+    xTaskCreate(CWREADER_Task, "CWREADER_Task", 4096, NULL, RTOS_PRIORITY_MEDIUM, NULL);
+
+    // Transmit worker, puts the queued jobs on air one by one
+    xTaskCreate(TRANSMIT_Task, "TRANSMIT_Task", AUDIO_TASK_STACK_SIZE, NULL, RTOS_PRIORITY_HIGHEST, NULL);
+
+    // Beacon scheduler, queues beacons to the transmit worker
     xTaskCreate(BEACON_Scheduler, "BEACON_Scheduler", 4096, NULL, RTOS_PRIORITY_IDLE, NULL);
 
     // Create websocket ping task
@@ -16,12 +16,14 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <stddef.h>
 #include <string.h>
 #include <esp_log.h>
 #include <esp_spiffs.h>
 
 #include "settings.h"
 #include "system.h"
+#include "helper/misc.h"
 
 static const char *TAG = "SETTINGS";
 
@@ -29,6 +31,13 @@ SETTINGS_Config_t gSettings;
 
 SemaphoreHandle_t settingsSemaphore;
 
+_Static_assert(sizeof(SETTINGS_Config_t) <= UINT16_MAX, "Settings size does not fit into the header");
+
+// Define where calibration starts counting from the end of the file, it closes every layout so far
+#define SETTINGS_CALIBRATION_TAIL (sizeof(SETTINGS_Config_t) - offsetof(SETTINGS_Config_t, calibration))
+// Define where WiFi and GPIO settings end, they lead every layout so far
+#define SETTINGS_PREFIX_END offsetof(SETTINGS_Config_t, audio)
+
 // Initialize settings
 esp_err_t SETTINGS_Init(void)
 {
@@ -40,6 +49,15 @@ esp_err_t SETTINGS_Init(void)
     return ESP_OK;
 }
 
+// Keep the values the API and older files may hold within the ranges the users of the settings expect
+static void SETTINGS_Clamp(void)
+{
+    SETTINGS_MorseCodeBeaconConfig_t *morse_code = &gSettings.beacon.morse_code;
+
+    morse_code->wpm = MIN(MAX(morse_code->wpm, SETTINGS_MORSE_CODE_MIN_WPM), SETTINGS_MORSE_CODE_MAX_WPM);
+    morse_code->farnsworth_wpm = MIN(morse_code->farnsworth_wpm, SETTINGS_MORSE_CODE_MAX_WPM);
+}
+
 // Load settings from local filesystem
 esp_err_t SETTINGS_Load(void)
 {
@@ -60,9 +78,44 @@ esp_err_t SETTINGS_Load(void)
     }
     else
     {
-        fread(&gSettings, 1, sizeof(gSettings), fd);
+        const size_t len = fread(&gSettings, 1, sizeof(gSettings), fd);
+        // File saved by other firmware, only the fields at the same place in every layout can be kept
+        const bool changed = len != sizeof(gSettings) || gSettings.version != SETTINGS_VERSION || gSettings.size != sizeof(gSettings);
+        const bool keep_prefix = changed && len >= SETTINGS_PREFIX_END;
+        SETTINGS_Calibration_t calibration;
+        const bool keep_calibration = keep_prefix &&
+                                      fseek(fd, -(long)SETTINGS_CALIBRATION_TAIL, SEEK_END) == 0 &&
+                                      ftell(fd) >= (long)SETTINGS_PREFIX_END &&
+                                      fread(&calibration, 1, sizeof(calibration), fd) == sizeof(calibration);
         fclose(fd);
         xSemaphoreGive(settingsSemaphore);
+
+        if (changed)
+        {
+            const SETTINGS_WifiConfig_t wifi = gSettings.wifi;
+            const SETTINGS_GpioConfig_t gpio = gSettings.gpio;
+
+            ESP_LOGW(TAG, "Config file layout changed (version %u, %u bytes), restoring defaults.", gSettings.version, gSettings.size);
+            memset(&gSettings, 0, sizeof(gSettings));
+            SETTINGS_FactoryReset(false);
+
+            if (keep_prefix)
+            {
+                gSettings.wifi = wifi;
+                gSettings.gpio = gpio;
+                ESP_LOGW(TAG, "Kept WiFi and GPIO settings.");
+            }
+
+            if (keep_calibration)
+            {
+                gSettings.calibration = calibration;
+                ESP_LOGW(TAG, "Kept calibration settings.");
+            }
+
+            SETTINGS_Save();
+        }
+
+        SETTINGS_Clamp();
     }
 
     return ESP_OK;
@@ -79,6 +132,10 @@ esp_err_t SETTINGS_Save(void)
 
     FILE *fd = NULL;
 
+    SETTINGS_Clamp();
+    gSettings.version = SETTINGS_VERSION;
+    gSettings.size = sizeof(gSettings);
+
     fd = fopen(CONFIG_LOCATION, "wb");
     fwrite(&gSettings, 1, sizeof(gSettings), fd);
     fclose(fd);
@@ -116,6 +173,12 @@ esp_err_t SETTINGS_FactoryReset(bool reboot)
     // Audio
     gSettings.audio.out.volume = CONFIG_AUDIO_OUT_VOLUME;
     gSettings.audio.in.squelch = CONFIG_AUDIO_IN_SQUELCH;
+    gSettings.audio.in.upsample_factor = CONFIG_AUDIO_IN_UPSAMPLE_FACTOR;
+    gSettings.audio.in.preroll_ms = CONFIG_AUDIO_IN_PREROLL_MS;
+    gSettings.audio.in.agc = CONFIG_AUDIO_IN_AGC;
+    gSettings.audio.in.filter = CONFIG_AUDIO_IN_FILTER;
+    gSettings.audio.in.packet = CONFIG_AUDIO_IN_PACKET;
+    gSettings.audio.in.cw = CONFIG_AUDIO_IN_CW;
     // LED
     gSettings.led.max_brightness = CONFIG_STATUS_LED_GPIO_MAX_BRIGHTNESS;
     // Beacon
@@ -124,13 +187,18 @@ esp_err_t SETTINGS_FactoryReset(bool reboot)
     strcpy(gSettings.beacon.text, CONFIG_BEACON_TEXT);
     // Morse code beacon
     gSettings.beacon.morse_code.tone_freq = CONFIG_MORSE_CODE_BEACON_TONE_FREQ;
-    gSettings.beacon.morse_code.baud = CONFIG_MORSE_CODE_BEACON_BAUD;
+    gSettings.beacon.morse_code.wpm = CONFIG_MORSE_CODE_BEACON_WPM;
+    gSettings.beacon.morse_code.farnsworth_wpm = CONFIG_MORSE_CODE_BEACON_FARNSWORTH_WPM;
     // AFSK beacon
     gSettings.beacon.afsk.baud = CONFIG_AFSK_BEACON_BAUD;
     gSettings.beacon.afsk.zero_freq = CONFIG_AFSK_ZERO_FREQ;
     gSettings.beacon.afsk.one_freq = CONFIG_AFSK_ONE_FREQ;
     // WAV beacon
     strcpy(gSettings.beacon.wav.filepath, CONFIG_WAV_BEACON_FILEPATH);
+    // APRS beacon
+    strcpy(gSettings.beacon.aprs.callsign, CONFIG_APRS_BEACON_CALLSIGN);
+    strcpy(gSettings.beacon.aprs.destination, CONFIG_APRS_BEACON_DESTINATION);
+    strcpy(gSettings.beacon.aprs.path, CONFIG_APRS_BEACON_PATH);
     // Calibration
     gSettings.calibration.adc.value = 0;
     gSettings.calibration.adc.is_valid = SETTINGS_FALSE;
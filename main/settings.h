@@ -17,6 +17,7 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
+#include <stdint.h>
 #include <esp_err.h>
 
 #include "helper/api.h"
@@ -26,6 +27,12 @@
 #define CONFIG_FILE_PATH "/config.bin"
 // Determines location of where the config file is stored ie. /storage/config.bin
 #define CONFIG_LOCATION FLASH_BASE_PATH CONFIG_FILE_PATH
+// Define layout version of the config file, bump it when a field changes its meaning
+// Adding or removing fields changes the size, which is checked as well
+#define SETTINGS_VERSION 1
+// Define range of the Morse code beacon speeds, they are narrowed to uint8_t by the encoder
+#define SETTINGS_MORSE_CODE_MIN_WPM 5
+#define SETTINGS_MORSE_CODE_MAX_WPM 60
 
 // BOOL type
 typedef enum
@@ -93,13 +100,15 @@ typedef enum {
     SETTINGS_BEACON_MODE_OFF,
     SETTINGS_BEACON_MODE_MORSE_CODE,
     SETTINGS_BEACON_MODE_AFSK,
-    SETTINGS_BEACON_MODE_WAV
+    SETTINGS_BEACON_MODE_WAV,
+    SETTINGS_BEACON_MODE_APRS
 } SETTINGS_BeaconMode_t;
 
 // Morse code beacon settings
 typedef struct
 {
-    API_INTEGER_TYPE baud;
+    API_INTEGER_TYPE wpm;            // character speed in words per minute
+    API_INTEGER_TYPE farnsworth_wpm; // overall speed, gaps are stretched to reach it, 0 disables
     API_INTEGER_TYPE tone_freq;
 } SETTINGS_MorseCodeBeaconConfig_t;
 
@@ -117,6 +126,14 @@ typedef struct
     char filepath[64]; // path to .wav file
 } SETTINGS_WavBeaconConfig_t;
 
+// APRS beacon settings, beacon text is the information field
+typedef struct
+{
+    char callsign[10];    // source callsign with optional SSID, e.g. N0CALL-7
+    char destination[10]; // destination callsign, e.g. APRS
+    char path[32];        // comma separated digipeaters, e.g. WIDE1-1,WIDE2-1
+} SETTINGS_AprsBeaconConfig_t;
+
 // Audio out settings
 typedef struct
 {
@@ -126,7 +143,13 @@ typedef struct
 // Audio in settings
 typedef struct
 {
-    API_INTEGER_TYPE squelch; // 0-100 - determines squelch sensitivity
+    API_INTEGER_TYPE squelch;         // 0-100 - determines squelch sensitivity
+    API_INTEGER_TYPE upsample_factor; // 2 or 4 - ADC measurements per sample, filtered out by the decimator
+    API_INTEGER_TYPE preroll_ms;      // 0-2000 - audio from before the squelch opened kept in recordings, 0 disables
+    API_INTEGER_TYPE agc;             // SETTINGS_Bool_t - automatic gain control of recordings
+    API_INTEGER_TYPE filter;          // SETTINGS_Bool_t - highpass and lowpass filtering of recordings
+    API_INTEGER_TYPE packet;          // SETTINGS_Bool_t - decode AX.25 packets (Bell 202 AFSK) from the audio input
+    API_INTEGER_TYPE cw;              // SETTINGS_Bool_t - decode Morse code from the audio input
 } SETTINGS_AudioInConfig_t;
 
 // Audio settings
@@ -151,13 +174,14 @@ typedef struct
     SETTINGS_MorseCodeBeaconConfig_t morse_code;
     SETTINGS_AfskBeaconConfig_t      afsk;
     SETTINGS_WavBeaconConfig_t       wav;
+    SETTINGS_AprsBeaconConfig_t      aprs;
 } SETTINGS_BeaconConfig_t;
 
 // Calibration subtype
 typedef struct
 {
     API_INTEGER_TYPE value;    // value when there is no audio in signal
-    SETTINGS_Bool_t       is_valid; // set it to false to trigger calibration
+    SETTINGS_Bool_t       is_valid; // set it to false to track the value from scratch
 } SETTINGS_CalibrationSubtype_t;
 
 // Calibration settings
@@ -170,7 +194,8 @@ typedef struct
 // Global settings
 typedef struct
 {
-    char                             padding[4];
+    uint16_t                         version; // SETTINGS_VERSION the file was saved with
+    uint16_t                         size;    // size of the settings the file was saved with
     SETTINGS_WifiConfig_t            wifi;
     SETTINGS_GpioConfig_t            gpio;
     SETTINGS_AudioConfig_t           audio;
@@ -17,23 +17,45 @@
 #include <esp_err.h>
 #include <esp_http_server.h>
 #include <esp_log.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
 #include <cJSON.h>
 
+#include "../../../settings.h"
 #include "hardware/audio.h"
 #include "helper/rtos.h"
 #include "helper/api.h"
 #include "helper/http.h"
+#include "helper/telemetry.h"
+#include "helper/misc.h"
+#include "hardware/sd.h"
+#include "web/router.h"
+#include "app/waveform.h"
+#include "board.h"
 #include <app/transmit.h>
 
+// Define amount of points returned by the peaks API when the request does not say
+#define API_AUDIO_PEAKS_DEFAULT_POINTS 500
+// Define max amount of points returned by the peaks API
+#define API_AUDIO_PEAKS_MAX_POINTS 2000
+
 static const char *TAG = "WEB/API/AUDIO";
 
 static const char *audioRecordTaskName = "AUDIO_Record";
-static const char *audioTransmitWAVTaskName = "TRANSMIT_Wav";
 
 // Default values
 AUDIO_RecordParam_t record_param = {
     .filepath = AUDIO_DEFAULT_WAV_SAMPLE_FILEPATH,
-    .duration_sec = 10};
+    .duration_sec = 10,
+    .segment_sec = 0,
+    .segment_mb = 0,
+    .min_free_mb = 0,
+    .format = AUDIO_RECORD_FORMAT_PCM,
+    .logger = SETTINGS_FALSE,
+    .sample_rate = AUDIO_INPUT_SAMPLE_FREQ};
 
 TRANSMIT_WavParam_t transmit_wav_param = {
     .filepath = AUDIO_DEFAULT_WAV_SAMPLE_FILEPATH};
@@ -41,7 +63,13 @@ TRANSMIT_WavParam_t transmit_wav_param = {
 // List of audio record attributes
 ApiAttr_t record_attributes[] = {
     {"filepath", &record_param.filepath, 0},
-    {"duration_sec", &record_param.duration_sec, 1}};
+    {"duration_sec", &record_param.duration_sec, 1},
+    {"segment_sec", &record_param.segment_sec, 1},
+    {"segment_mb", &record_param.segment_mb, 1},
+    {"min_free_mb", &record_param.min_free_mb, 1},
+    {"format", &record_param.format, 1},
+    {"logger", &record_param.logger, 1},
+    {"sample_rate", &record_param.sample_rate, 1}};
 
 // List of audio transmit WAV attributes
 ApiAttr_t transmit_wav_attributes[] = {
@@ -63,25 +91,54 @@ esp_err_t API_AUDIO_Record(httpd_req_t *req)
         return ret;
     }
 
-    if (audioRecordTaskHandle == NULL)
+    if (audioRecordTaskHandle != NULL)
     {
-        xTaskCreate(AUDIO_Record, audioRecordTaskName, 4096, &record_param, RTOS_PRIORITY_MEDIUM, NULL);
-        httpd_json_resp_send(req, HTTPD_200, "OK. Recording will start once the squelch opens.");
+        httpd_json_resp_send(req, HTTPD_500, "Recording task is already running.");
+        return ESP_OK;
     }
-    else
+
+    // Task owns a copy of the params, the next request must not change them under the running recording
+    AUDIO_RecordParam_t *param = malloc(sizeof(AUDIO_RecordParam_t));
+
+    if (param == NULL)
     {
-        httpd_json_resp_send(req, HTTPD_500, "Recording task is already running.");
+        httpd_json_resp_send(req, HTTPD_500, "Not enough memory to start the recording.");
+        return ESP_OK;
+    }
+
+    *param = record_param;
+
+    if (xTaskCreate(AUDIO_Record, audioRecordTaskName, AUDIO_TASK_STACK_SIZE, param, RTOS_PRIORITY_MEDIUM, NULL) != pdPASS)
+    {
+        free(param);
+        httpd_json_resp_send(req, HTTPD_500, "Recording task could not be started.");
+        return ESP_OK;
     }
 
+    httpd_json_resp_send(req, HTTPD_200, "OK. Recording will start once the squelch opens.");
+
     return ESP_OK;
 }
 
-// Schedule audio transmit wav task
-esp_err_t API_AUDIO_TransmitWAV(httpd_req_t *req)
+// Finish the running recording, the file header is patched before the task ends
+esp_err_t API_AUDIO_RecordDestroy(httpd_req_t *req)
 {
-    // Check if there is other instance of the task running
-    TaskHandle_t audioRecordTaskHandle = xTaskGetHandle(audioTransmitWAVTaskName);
+    if (xTaskGetHandle(audioRecordTaskName) == NULL)
+    {
+        httpd_json_resp_send(req, HTTPD_500, "Recording task is not running.");
+        return ESP_OK;
+    }
+
+    AUDIO_RecordStop();
 
+    httpd_json_resp_send(req, HTTPD_200, "OK. Recording will stop shortly.");
+
+    return ESP_OK;
+}
+
+// Queue transmission of the WAV file
+esp_err_t API_AUDIO_TransmitWAV(httpd_req_t *req)
+{
     esp_err_t ret = process_api_attributes(req, TAG, transmit_wav_attributes, (sizeof(transmit_wav_attributes) / sizeof(transmit_wav_attributes[0])));
 
     ESP_LOGI(TAG, "Received audio play request for: %s", transmit_wav_param.filepath);
@@ -92,15 +149,305 @@ esp_err_t API_AUDIO_TransmitWAV(httpd_req_t *req)
         return ret;
     }
 
-    if (audioRecordTaskHandle == NULL)
+    // Job gets its own copy of the parameters
+    if (TRANSMIT_Wav(&transmit_wav_param, TRANSMIT_PRIORITY_NORMAL) == ESP_OK)
     {
-        xTaskCreate(TRANSMIT_Wav, audioTransmitWAVTaskName, 4096, &transmit_wav_param, RTOS_PRIORITY_HIGHEST, NULL);
-        httpd_json_resp_send(req, HTTPD_200, "OK. Scheduled transmision of the WAV file.");
+        httpd_json_resp_send(req, HTTPD_200, "OK. Queued transmision of the WAV file.");
     }
     else
     {
-        httpd_json_resp_send(req, HTTPD_500, "Transmit task is already running.");
+        httpd_json_resp_send(req, HTTPD_500, "Transmit queue is full.");
     }
 
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+// Stop the transmission on air and drop the queued ones
+esp_err_t API_AUDIO_TransmitDestroy(httpd_req_t *req)
+{
+    TRANSMIT_Cancel();
+
+    httpd_json_resp_send(req, HTTPD_200, "OK. Transmissions cancelled.");
+
+    return ESP_OK;
+}
+
+// Append text to the response, sent in chunks once the scratch buffer fills
+static void API_AUDIO_PeaksPrint(httpd_req_t *req, size_t *len, const char *format, int value)
+{
+    char *buf = ((file_server_data *)(req->user_ctx))->scratch;
+
+    *len += snprintf(&buf[*len], SCRATCH_BUFSIZE - *len, format, value);
+
+    if (*len > SCRATCH_BUFSIZE - 32)
+    {
+        httpd_resp_send_chunk(req, buf, *len);
+        *len = 0;
+    }
+}
+
+// Decode the percent encoded filepath of the request, false unless it is a file within one of the storages
+static bool API_AUDIO_PeaksPath(char *filepath, size_t size, const char *path, size_t path_len)
+{
+    size_t len = 0;
+
+    for (size_t i = 0; i < path_len; i++)
+    {
+        char c = path[i];
+
+        if (c == '%')
+        {
+            const char hex[3] = {(i + 1 < path_len) ? path[i + 1] : '\0', (i + 2 < path_len) ? path[i + 2] : '\0', '\0'};
+
+            if (!isxdigit((unsigned char)hex[0]) || !isxdigit((unsigned char)hex[1]))
+            {
+                return false;
+            }
+
+            c = (char)strtoul(hex, NULL, 16);
+
+            if (c == '\0')
+            {
+                return false;
+            }
+            i += 2;
+        }
+
+        if (len + 1 >= size)
+        {
+            return false;
+        }
+        filepath[len++] = c;
+    }
+    filepath[len] = '\0';
+
+    // Dot dot segments would step out of the storage
+    for (const char *segment = filepath; segment != NULL; segment = strchr(segment + 1, '/'))
+    {
+        if (strncmp(segment, "/..", 3) == 0 && (segment[3] == '/' || segment[3] == '\0'))
+        {
+            return false;
+        }
+    }
+
+    const size_t flash_len = strlen(FLASH_BASE_PATH);
+    const size_t sd_len = strlen(SD_BASE_PATH);
+
+    return (strncmp(filepath, FLASH_BASE_PATH "/", flash_len + 1) == 0 && filepath[flash_len + 1] != '\0') ||
+           (strncmp(filepath, SD_BASE_PATH "/", sd_len + 1) == 0 && filepath[sd_len + 1] != '\0');
+}
+
+// Waveform peaks of the recording read from its sidecar
+// GET /api/audio/peaks/<filepath>?start_ms=0&end_ms=0&points=500, end_ms 0 means the end of the recording
+// Responds with {"peak_ms", "duration_ms", "start_ms", "end_ms", "peaks": [min, max, ...]}, values are -128 to 127
+esp_err_t API_AUDIO_PeaksShow(httpd_req_t *req)
+{
+    char filepath[64];
+    char query[64];
+    char value[16];
+    uint32_t start_ms = 0;
+    uint32_t end_ms = 0;
+    size_t points = API_AUDIO_PEAKS_DEFAULT_POINTS;
+    const char *path = req->uri + strlen(PEAKS_URI_PREFIX);
+    const size_t path_len = strcspn(path, "?");
+
+    if (!API_AUDIO_PeaksPath(filepath, sizeof(filepath), path, path_len))
+    {
+        httpd_json_resp_send(req, HTTPD_400, "Invalid filepath");
+        return ESP_OK;
+    }
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK)
+    {
+        if (httpd_query_key_value(query, "start_ms", value, sizeof(value)) == ESP_OK)
+            start_ms = strtoul(value, NULL, 10);
+
+        if (httpd_query_key_value(query, "end_ms", value, sizeof(value)) == ESP_OK)
+            end_ms = strtoul(value, NULL, 10);
+
+        if (httpd_query_key_value(query, "points", value, sizeof(value)) == ESP_OK)
+            points = strtoul(value, NULL, 10);
+    }
+
+    WAVEFORM_Header_t header;
+    size_t count;
+    FILE *fd = WAVEFORM_Open(filepath, &header, &count);
+
+    if (fd == NULL)
+    {
+        struct stat file_stat;
+
+        if (stat(filepath, &file_stat) == -1)
+        {
+            httpd_json_resp_send(req, HTTPD_404, "File does not exist");
+        }
+        // Recordings made before the sidecars existed are indexed in the background
+        else if (WAVEFORM_Index(filepath) == ESP_OK)
+        {
+            httpd_json_resp_send(req, "202 Accepted", "Peaks are being generated, try again shortly.");
+        }
+        else
+        {
+            httpd_json_resp_send(req, HTTPD_500, "Peaks are not available.");
+        }
+        return ESP_OK;
+    }
+
+    // Peaks of the requested range, a point merges all the peaks it covers
+    const uint32_t peak_ms_x1000 = (uint32_t)header.per_peak * 1000;
+    const size_t first = MIN((size_t)((uint64_t)start_ms * header.sample_rate / peak_ms_x1000), count);
+    const size_t last = (end_ms > 0) ? MIN((size_t)(((uint64_t)end_ms * header.sample_rate + peak_ms_x1000 - 1) / peak_ms_x1000), count) : count;
+    const size_t total = (last > first) ? last - first : 0;
+
+    points = MIN(MIN(MAX(points, (size_t)1), (size_t)API_AUDIO_PEAKS_MAX_POINTS), total);
+    fseek(fd, first * 2, SEEK_CUR);
+
+    size_t len = 0;
+
+    httpd_resp_set_type(req, "application/json");
+    API_AUDIO_PeaksPrint(req, &len, "{\"peak_ms\":%d,", (int)(peak_ms_x1000 / header.sample_rate));
+    API_AUDIO_PeaksPrint(req, &len, "\"duration_ms\":%d,", (int)((uint64_t)count * peak_ms_x1000 / header.sample_rate));
+    API_AUDIO_PeaksPrint(req, &len, "\"start_ms\":%d,", (int)((uint64_t)first * peak_ms_x1000 / header.sample_rate));
+    API_AUDIO_PeaksPrint(req, &len, "\"end_ms\":%d,\"peaks\":[", (int)((uint64_t)(first + total) * peak_ms_x1000 / header.sample_rate));
+
+    size_t read = 0;
+
+    for (size_t i = 0; i < points; i++)
+    {
+        const size_t end = (uint64_t)(i + 1) * total / points;
+        int8_t min = INT8_MAX;
+        int8_t max = INT8_MIN;
+        int8_t peak[2];
+
+        for (; read < end && fread(peak, 1, sizeof(peak), fd) == sizeof(peak); read++)
+        {
+            min = MIN(min, peak[0]);
+            max = MAX(max, peak[1]);
+        }
+
+        API_AUDIO_PeaksPrint(req, &len, (i == 0) ? "%d" : ",%d", min);
+        API_AUDIO_PeaksPrint(req, &len, ",%d", max);
+    }
+
+    API_AUDIO_PeaksPrint(req, &len, "]}", 0);
+    fclose(fd);
+
+    httpd_resp_send_chunk(req, ((file_server_data *)(req->user_ctx))->scratch, len);
+    httpd_resp_send_chunk(req, NULL, 0);
+
+    return ESP_OK;
+}
+
+// Audio path telemetry
+esp_err_t API_AUDIO_TelemetryIndex(httpd_req_t *req)
+{
+    cJSON *root = cJSON_CreateObject();
+
+    // Latencies are in CPU cycles
+    cJSON_AddNumberToObject(root, "cpu_freq_mhz", CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+
+    cJSON *stages = cJSON_AddObjectToObject(root, "stages");
+
+    for (TELEMETRY_StageId_t id = 0; id < TELEMETRY_STAGE_LAST; id++)
+    {
+        const TELEMETRY_Stage_t *stage = TELEMETRY_GetStage(id);
+        cJSON *item = cJSON_AddObjectToObject(stages, TELEMETRY_StageName(id));
+
+        cJSON_AddNumberToObject(item, "count", stage->count);
+        cJSON_AddNumberToObject(item, "avg_cycles", stage->count ? (double)stage->total_cycles / stage->count : 0);
+        cJSON_AddNumberToObject(item, "max_cycles", stage->max_cycles);
+
+        // Bucket n counts latencies of 2^n to 2^(n+1)-1 cycles
+        cJSON *histogram = cJSON_AddArrayToObject(item, "log2_histogram");
+
+        for (size_t i = 0; i < TELEMETRY_HISTOGRAM_BUCKETS; i++)
+        {
+            cJSON_AddItemToArray(histogram, cJSON_CreateNumber(stage->histogram[i]));
+        }
+    }
+
+    // Cost of each stage of the receive path processing chain
+    cJSON *pipeline = cJSON_AddArrayToObject(root, "pipeline");
+
+    for (uint8_t i = 0; i < gAudioPipeline.len; i++)
+    {
+        const PIPELINE_Stage_t *stage = &gAudioPipeline.stages[i];
+        cJSON *item = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(item, "name", stage->name);
+        cJSON_AddNumberToObject(item, "blocks", stage->blocks);
+        cJSON_AddNumberToObject(item, "avg_cycles", stage->blocks ? (double)stage->cycles / stage->blocks : 0);
+        cJSON_AddItemToArray(pipeline, item);
+    }
+
+    cJSON *counters = cJSON_AddObjectToObject(root, "counters");
+
+    for (TELEMETRY_CounterId_t id = 0; id < TELEMETRY_COUNTER_LAST; id++)
+    {
+        cJSON_AddNumberToObject(counters, TELEMETRY_CounterName(id), TELEMETRY_GetCounter(id));
+    }
+
+    cJSON *bus = cJSON_AddObjectToObject(root, "bus");
+
+    cJSON_AddNumberToObject(bus, "block_size", BUS_BLOCK_SIZE);
+    cJSON_AddNumberToObject(bus, "block_count", BUS_BLOCK_COUNT);
+
+    cJSON *consumers = cJSON_AddArrayToObject(bus, "consumers");
+
+    for (size_t i = 0; i < BUS_MAX_CONSUMERS; i++)
+    {
+        BUS_Consumer_t *consumer = &gAudioBus.consumers[i];
+
+        if (!atomic_load(&consumer->in_use))
+        {
+            continue;
+        }
+
+        cJSON *item = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(item, "name", consumer->name);
+        cJSON_AddNumberToObject(item, "pending", BUS_Pending(&gAudioBus, consumer));
+        cJSON_AddNumberToObject(item, "high_water", atomic_load(&consumer->high_water));
+        cJSON_AddNumberToObject(item, "overruns", atomic_load(&consumer->overruns));
+        cJSON_AddItemToArray(consumers, item);
+    }
+
+    // Transmit queue, wait is the time from queueing a job to putting it on air
+    TRANSMIT_Status_t transmit_status;
+    cJSON *transmit = cJSON_AddObjectToObject(root, "transmit");
+
+    TRANSMIT_GetStatus(&transmit_status);
+
+    cJSON_AddNumberToObject(transmit, "depth", transmit_status.depth);
+    cJSON_AddNumberToObject(transmit, "max_depth", transmit_status.max_depth);
+    cJSON_AddStringToObject(transmit, "active", transmit_status.active ? TRANSMIT_JobName(transmit_status.job) : "");
+    cJSON_AddNumberToObject(transmit, "jobs", transmit_status.jobs);
+    cJSON_AddNumberToObject(transmit, "rejected", transmit_status.rejected);
+    cJSON_AddNumberToObject(transmit, "cancelled", transmit_status.cancelled);
+    cJSON_AddNumberToObject(transmit, "last_wait_ms", transmit_status.last_wait_ms);
+    cJSON_AddNumberToObject(transmit, "avg_wait_ms", transmit_status.jobs ? (double)transmit_status.total_wait_ms / transmit_status.jobs : 0);
+    cJSON_AddNumberToObject(transmit, "max_wait_ms", transmit_status.max_wait_ms);
+
+    httpd_resp_set_type(req, "application/json");
+    char *json_str = cJSON_Print(root);
+
+    // Send response
+    httpd_resp_sendstr(req, json_str);
+
+    // Free memory, it handles all the objects belonging to root
+    cJSON_Delete(root);
+    free(json_str);
+
+    return ESP_OK;
+}
+
+// Reset audio path telemetry
+esp_err_t API_AUDIO_TelemetryDestroy(httpd_req_t *req)
+{
+    TELEMETRY_Reset();
+    TRANSMIT_ResetStatus();
+
+    httpd_json_resp_send(req, HTTPD_200, "OK. Telemetry reset.");
+
+    return ESP_OK;
+}
@@ -21,6 +21,11 @@
 #include <esp_http_server.h>
 
 esp_err_t API_AUDIO_Record(httpd_req_t *req);
+esp_err_t API_AUDIO_RecordDestroy(httpd_req_t *req);
 esp_err_t API_AUDIO_TransmitWAV(httpd_req_t *req);
+esp_err_t API_AUDIO_TransmitDestroy(httpd_req_t *req);
+esp_err_t API_AUDIO_PeaksShow(httpd_req_t *req);
+esp_err_t API_AUDIO_TelemetryIndex(httpd_req_t *req);
+esp_err_t API_AUDIO_TelemetryDestroy(httpd_req_t *req);
 
 #endif
\ No newline at end of file
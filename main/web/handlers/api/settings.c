@@ -39,16 +39,26 @@ ApiAttr_t settings[] = {
     {"gpio.ptt",                         &gSettings.gpio.ptt,                         1},
     {"audio.out.volume",                 &gSettings.audio.out.volume,                 1},
     {"audio.in.squelch",                 &gSettings.audio.in.squelch,                 1},
+    {"audio.in.upsample_factor",         &gSettings.audio.in.upsample_factor,         1},
+    {"audio.in.preroll_ms",              &gSettings.audio.in.preroll_ms,              1},
+    {"audio.in.agc",                     &gSettings.audio.in.agc,                     1},
+    {"audio.in.filter",                  &gSettings.audio.in.filter,                  1},
+    {"audio.in.packet",                  &gSettings.audio.in.packet,                  1},
+    {"audio.in.cw",                      &gSettings.audio.in.cw,                      1},
     {"led.max_brightness",               &gSettings.led.max_brightness,               1},
     {"beacon.mode",                      &gSettings.beacon.mode,                      1},
     {"beacon.text",                      &gSettings.beacon.text,                      0},
     {"beacon.delay_seconds",             &gSettings.beacon.delay_seconds,             1},
-    {"beacon.morse_code.baud",           &gSettings.beacon.morse_code.baud,           1},
+    {"beacon.morse_code.wpm",            &gSettings.beacon.morse_code.wpm,            1},
+    {"beacon.morse_code.farnsworth_wpm", &gSettings.beacon.morse_code.farnsworth_wpm, 1},
     {"beacon.morse_code.tone_freq",      &gSettings.beacon.morse_code.tone_freq,      1},
     {"beacon.afsk.baud",                 &gSettings.beacon.afsk.baud,                 1},
     {"beacon.afsk.zero_freq",            &gSettings.beacon.afsk.zero_freq,            1},
     {"beacon.afsk.one_freq",             &gSettings.beacon.afsk.one_freq,             1},
-    {"beacon.wav.filepath",              &gSettings.beacon.wav.filepath,              0}
+    {"beacon.wav.filepath",              &gSettings.beacon.wav.filepath,              0},
+    {"beacon.aprs.callsign",             &gSettings.beacon.aprs.callsign,             0},
+    {"beacon.aprs.destination",          &gSettings.beacon.aprs.destination,          0},
+    {"beacon.aprs.path",                 &gSettings.beacon.aprs.path,                 0}
 };
 
 // Shows current settings
@@ -25,6 +25,8 @@
 #include "helper/http.h"
 #include "helper/api.h"
 #include "helper/filesystem.h"
+#include "hardware/audio.h"
+#include "app/waveform.h"
 #include "board.h"
 
 static const char *TAG = "WEB/STATIC_FILES";
@@ -401,6 +403,16 @@ esp_err_t STATIC_FILES_Delete(httpd_req_t *req)
 
     if(ret == ESP_OK)
     {
+        char sidecar[FILE_PATH_MAX];
+        const char *ext = strrchr(filepath, '.');
+
+        // Peaks sidecar goes away with the recording
+        if (ext != NULL && (strcasecmp(ext, AUDIO_LOGGER_FILE_EXT) == 0 || strcmp(ext, AUDIO_LOGGER_CODEC2_FILE_EXT) == 0) &&
+            WAVEFORM_Path(sidecar, sizeof(sidecar), filepath))
+        {
+            delete_file(sidecar);
+        }
+
         httpd_json_resp_send(req, HTTPD_200, "File deleted");
     }
     else if (ret == ESP_ERR_NOT_FOUND)
@@ -20,7 +20,7 @@
 #include <esp_err.h>
 #include <esp_http_server.h>
 
-#define WEBSOCKET_MESSAGE_MAX_LENGTH 200
+#define WEBSOCKET_MESSAGE_MAX_LENGTH 400
 
 esp_err_t WEBSOCKET_Handle(httpd_req_t *req);
 void WEBSOCKET_Send(const char *tag, const char *format, ...);
@@ -105,6 +105,13 @@ void ROUTER_Init(file_server_data *server_data, httpd_handle_t *server)
         .user_ctx = server_data};
     httpd_register_uri_handler(server, &api_audio_record_uri);
 
+    httpd_uri_t api_audio_record_destroy_uri = {
+        .uri = "/api/audio/record",
+        .method = HTTP_DELETE,
+        .handler = API_AUDIO_RecordDestroy,
+        .user_ctx = server_data};
+    httpd_register_uri_handler(server, &api_audio_record_destroy_uri);
+
     httpd_uri_t api_audio_transmit_wav_uri = {
         .uri = "/api/audio/transmit_wav",
         .method = HTTP_PUT,
@@ -112,6 +119,34 @@ void ROUTER_Init(file_server_data *server_data, httpd_handle_t *server)
         .user_ctx = server_data};
     httpd_register_uri_handler(server, &api_audio_transmit_wav_uri);
 
+    httpd_uri_t api_audio_transmit_destroy_uri = {
+        .uri = "/api/audio/transmit",
+        .method = HTTP_DELETE,
+        .handler = API_AUDIO_TransmitDestroy,
+        .user_ctx = server_data};
+    httpd_register_uri_handler(server, &api_audio_transmit_destroy_uri);
+
+    httpd_uri_t api_audio_peaks_show_uri = {
+        .uri = PEAKS_URI_PREFIX "/*",
+        .method = HTTP_GET,
+        .handler = API_AUDIO_PeaksShow,
+        .user_ctx = server_data};
+    httpd_register_uri_handler(server, &api_audio_peaks_show_uri);
+
+    httpd_uri_t api_audio_telemetry_index_uri = {
+        .uri = "/api/audio/telemetry",
+        .method = HTTP_GET,
+        .handler = API_AUDIO_TelemetryIndex,
+        .user_ctx = server_data};
+    httpd_register_uri_handler(server, &api_audio_telemetry_index_uri);
+
+    httpd_uri_t api_audio_telemetry_destroy_uri = {
+        .uri = "/api/audio/telemetry",
+        .method = HTTP_DELETE,
+        .handler = API_AUDIO_TelemetryDestroy,
+        .user_ctx = server_data};
+    httpd_register_uri_handler(server, &api_audio_telemetry_destroy_uri);
+
     // API Event
     httpd_uri_t api_event_create_uri = {
         .uri = "/api/event",
@@ -19,6 +19,7 @@
 
 #define UPLOAD_URI_PREFIX "/upload"
 #define DELETE_URI_PREFIX "/delete"
+#define PEAKS_URI_PREFIX "/api/audio/peaks"
 
 #include "helper/http.h"
 
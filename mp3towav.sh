@@ -1,4 +1,5 @@
 # script to convert all mp3 files to 32kHz wav files
+# the device plays other PCM wav layouts too, 32kHz 16-bit mono just saves it the conversion
 # to run: ./mp3towav.sh *.mp3
 mp3towav() {
     # create out dir
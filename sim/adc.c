@@ -0,0 +1,157 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <hal/adc_types.h>
+#include <soc/soc_caps.h>
+
+#include "adc.h"
+#include "wavfile.h"
+
+struct SIM_Adc_t
+{
+    SIM_Wav_t wav;
+    uint32_t sample_freq;
+    bool realtime;
+    uint64_t produced;       // amount of ADC results produced
+    struct timespec started; // time of the first read, used for pacing
+};
+
+/// @brief Open WAV file replayed by adc_continuous_read
+/// @param config ADC configuration
+/// @param handle opened ADC
+/// @return ESP_OK on success
+esp_err_t SIM_AdcOpen(const SIM_AdcConfig_t *config, adc_continuous_handle_t *handle)
+{
+    struct SIM_Adc_t *adc = calloc(1, sizeof(struct SIM_Adc_t));
+
+    if (adc == NULL)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = SIM_WavLoad(&adc->wav, config->filepath);
+
+    if (ret != ESP_OK)
+    {
+        free(adc);
+        return ret;
+    }
+
+    adc->sample_freq = config->sample_freq;
+    adc->realtime = config->realtime;
+    *handle = adc;
+
+    return ESP_OK;
+}
+
+/// @brief Close ADC opened by SIM_AdcOpen
+/// @param handle opened ADC
+void SIM_AdcClose(adc_continuous_handle_t handle)
+{
+    SIM_WavFree(&handle->wav);
+    free(handle);
+}
+
+/// @brief Get length of the replayed input
+/// @param handle opened ADC
+/// @return length in seconds
+double SIM_AdcDuration(adc_continuous_handle_t handle)
+{
+    return (double)handle->wav.len / handle->wav.sample_rate;
+}
+
+// Linearly interpolated WAV sample at given ADC result index
+static int32_t SIM_AdcSample(adc_continuous_handle_t handle, uint64_t index)
+{
+    const double position = (double)index * handle->wav.sample_rate / handle->sample_freq;
+    const size_t i = (size_t)position;
+    const double fraction = position - i;
+    const int32_t a = handle->wav.samples[i];
+    const int32_t b = (i + 1 < handle->wav.len) ? handle->wav.samples[i + 1] : a;
+
+    return a + (int32_t)((b - a) * fraction);
+}
+
+/// @brief Stand-in for the ESP-IDF continuous ADC read, fills the buffer with type1 results of the WAV file
+/// @param handle opened ADC
+/// @param buf buffer for the results
+/// @param length_max size of the buffer in bytes
+/// @param out_length amount of bytes written
+/// @param timeout_ms unused, reads never wait, see SIM_AdcWait
+/// @return ESP_OK, ESP_ERR_NOT_FOUND once the whole file was replayed
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max, uint32_t *out_length, uint32_t timeout_ms)
+{
+    const uint64_t total = (uint64_t)handle->wav.len * handle->sample_freq / handle->wav.sample_rate;
+    uint32_t count = length_max / SOC_ADC_DIGI_RESULT_BYTES;
+
+    *out_length = 0;
+
+    if (handle->produced >= total)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (count > total - handle->produced)
+    {
+        count = total - handle->produced;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        adc_digi_output_data_t *p = (adc_digi_output_data_t *)&buf[i * SOC_ADC_DIGI_RESULT_BYTES];
+        int32_t code = SIM_ADC_BIAS + (SIM_AdcSample(handle, handle->produced + i) >> SIM_ADC_SHIFT);
+
+        p->val = 0;
+        p->type1.channel = SIM_ADC_CHANNEL;
+        p->type1.data = code < 0 ? 0 : (code > 4095 ? 4095 : code);
+    }
+
+    handle->produced += count;
+    *out_length = count * SOC_ADC_DIGI_RESULT_BYTES;
+
+    return ESP_OK;
+}
+
+/// @brief Stand-in for waiting on the conversion done interrupt
+// In real time mode it sleeps until the next chunk would be sampled, otherwise it returns right away
+/// @param handle opened ADC
+/// @param length_max size of the chunk in bytes
+void SIM_AdcWait(adc_continuous_handle_t handle, uint32_t length_max)
+{
+    if (!handle->realtime)
+        return;
+
+    if (handle->produced == 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &handle->started);
+    }
+
+    const uint64_t results = handle->produced + length_max / SOC_ADC_DIGI_RESULT_BYTES;
+    const uint64_t due_ns = results * 1000000000ULL / handle->sample_freq;
+    struct timespec due = {
+        .tv_sec = handle->started.tv_sec + due_ns / 1000000000ULL,
+        .tv_nsec = handle->started.tv_nsec + due_ns % 1000000000ULL};
+
+    if (due.tv_nsec >= 1000000000L)
+    {
+        due.tv_sec++;
+        due.tv_nsec -= 1000000000L;
+    }
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+}
@@ -0,0 +1,47 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef SIM_ADC_H
+#define SIM_ADC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <esp_err.h>
+
+// Define ADC code of the silent input (DC bias of the audio input)
+#define SIM_ADC_BIAS 1850
+// Define how many bits the 16-bit WAV samples are shifted down to fit the 12-bit ADC
+#define SIM_ADC_SHIFT 4
+// Define ADC channel reported in the results
+#define SIM_ADC_CHANNEL 6
+
+typedef struct SIM_Adc_t *adc_continuous_handle_t;
+
+typedef struct
+{
+    const char *filepath; // WAV file replayed as the ADC input
+    uint32_t sample_freq; // ADC sampling frequency in Hz, the WAV file is resampled to it
+    bool realtime;        // whether chunks are paced at the sampling frequency
+} SIM_AdcConfig_t;
+
+esp_err_t SIM_AdcOpen(const SIM_AdcConfig_t *config, adc_continuous_handle_t *handle);
+void SIM_AdcClose(adc_continuous_handle_t handle);
+double SIM_AdcDuration(adc_continuous_handle_t handle);
+void SIM_AdcWait(adc_continuous_handle_t handle, uint32_t length_max);
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max, uint32_t *out_length, uint32_t timeout_ms);
+
+#endif
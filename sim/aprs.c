@@ -0,0 +1,219 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "wavfile.h"
+#include "dsp/afsk.h"
+#include "dsp/ax25.h"
+#include "dsp/hdlc.h"
+
+// Values below mirror app/transmit.h and hardware/audio.h
+
+// Define output sampling frequency in Hz
+#define SIM_OUTPUT_SAMPLE_FREQ 32000
+// Define Bell 202 modulation
+#define SIM_APRS_BAUD 1200
+#define SIM_APRS_MARK_FREQ 1200
+#define SIM_APRS_SPACE_FREQ 2200
+// Define flags around the frame
+#define SIM_APRS_PREAMBLE_FLAGS 45
+#define SIM_APRS_TAIL_FLAGS 3
+// Define amplitude of the rendered audio
+#define SIM_APRS_AMPLITUDE 16000
+
+typedef struct
+{
+    const char *source;
+    const char *destination;
+    const char *path;
+    uint32_t iterations;
+    const char *info;
+    const char *output;
+} SIM_AprsOptions_t;
+
+typedef struct
+{
+    uint64_t build_ns;
+    uint64_t encode_ns;
+    uint64_t modulate_ns;
+} SIM_AprsCost_t;
+
+static uint64_t SIM_Nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void SIM_AprsUsage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] info [output.wav]\n"
+            "Builds an APRS frame like the beacon does, measures framing and modulation cost and optionally writes the audio.\n"
+            "  -c call     source callsign (default N0CALL)\n"
+            "  -d call     destination (default APRS)\n"
+            "  -p path     digipeater path (default WIDE1-1,WIDE2-1)\n"
+            "  -n count    iterations to average (default 1000)\n",
+            name);
+}
+
+static bool SIM_AprsParseOptions(int argc, char **argv, SIM_AprsOptions_t *options)
+{
+    int opt;
+
+    *options = (SIM_AprsOptions_t){
+        .source = "N0CALL",
+        .destination = "APRS",
+        .path = "WIDE1-1,WIDE2-1",
+        .iterations = 1000};
+
+    while ((opt = getopt(argc, argv, "c:d:p:n:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            options->source = optarg;
+            break;
+        case 'd':
+            options->destination = optarg;
+            break;
+        case 'p':
+            options->path = optarg;
+            break;
+        case 'n':
+            options->iterations = atoi(optarg);
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (argc - optind < 1 || argc - optind > 2 || options->iterations == 0)
+        return false;
+
+    options->info = argv[optind];
+    options->output = argc - optind == 2 ? argv[optind + 1] : NULL;
+
+    return true;
+}
+
+// Modulate the line bits like AUDIO_PlayAFSKLine, samples may be NULL to only measure
+static size_t SIM_AprsModulate(const uint8_t *line, size_t bits, int16_t *samples, FILE *fd)
+{
+    AFSK_t afsk;
+    size_t len = 0;
+
+    AFSK_Init(&afsk, SIM_OUTPUT_SAMPLE_FREQ, SIM_APRS_BAUD, SIM_APRS_MARK_FREQ, SIM_APRS_SPACE_FREQ, SIM_APRS_AMPLITUDE);
+
+    for (size_t i = 0; i < bits; i++)
+    {
+        const size_t count = AFSK_RenderBit(&afsk, (line[i / 8] >> (i % 8)) & 1, samples);
+
+        if (fd)
+        {
+            fwrite(samples, sizeof(int16_t), count, fd);
+        }
+
+        len += count;
+    }
+
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    SIM_AprsOptions_t options;
+    SIM_AprsCost_t cost = {0};
+    uint8_t frame[AX25_MAX_FRAME_SIZE];
+    uint8_t line[HDLC_ENCODED_SIZE(AX25_MAX_FRAME_SIZE, SIM_APRS_PREAMBLE_FLAGS + SIM_APRS_TAIL_FLAGS)];
+    int16_t samples[SIM_OUTPUT_SAMPLE_FREQ / SIM_APRS_BAUD + 1];
+    HDLC_Encoder_t encoder;
+    size_t len = 0;
+    size_t samples_len = 0;
+
+    if (!SIM_AprsParseOptions(argc, argv, &options))
+    {
+        SIM_AprsUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 0; i < options.iterations; i++)
+    {
+        const uint64_t start = SIM_Nanoseconds();
+
+        len = AX25_BuildUI(frame, sizeof(frame), options.source, options.destination, options.path, (const uint8_t *)options.info, strlen(options.info));
+
+        if (len == 0)
+        {
+            fprintf(stderr, "Invalid frame, check callsign, destination and path\n");
+            return EXIT_FAILURE;
+        }
+
+        const uint64_t built = SIM_Nanoseconds();
+
+        HDLC_EncoderInit(&encoder, line, sizeof(line));
+        HDLC_EncodeFlags(&encoder, SIM_APRS_PREAMBLE_FLAGS);
+        HDLC_EncodeFrame(&encoder, frame, len);
+        HDLC_EncodeFlags(&encoder, SIM_APRS_TAIL_FLAGS);
+
+        const uint64_t encoded = SIM_Nanoseconds();
+
+        samples_len = SIM_AprsModulate(line, encoder.bits, samples, NULL);
+
+        cost.build_ns += built - start;
+        cost.encode_ns += encoded - built;
+        cost.modulate_ns += SIM_Nanoseconds() - encoded;
+    }
+
+    const size_t frame_bits = (len + HDLC_FCS_SIZE) * 8;
+    const size_t flag_bits = (SIM_APRS_PREAMBLE_FLAGS + SIM_APRS_TAIL_FLAGS) * 8;
+    const double airtime = (double)samples_len / SIM_OUTPUT_SAMPLE_FREQ;
+
+    printf("%s>%s%s%s:%s\n", options.source, options.destination, options.path[0] ? "," : "", options.path, options.info);
+    printf("Frame %zu bytes + FCS, %zu line bits (%zu stuffed), %zu flags, %.3f s on air\n",
+           len, encoder.bits, encoder.bits - frame_bits - flag_bits, (size_t)(SIM_APRS_PREAMBLE_FLAGS + SIM_APRS_TAIL_FLAGS), airtime);
+
+    printf("\n%-12s %12s %14s\n", "stage", "ns/frame", "ns/line bit");
+    printf("%-12s %12" PRIu64 " %14.1f\n", "build", cost.build_ns / options.iterations, (double)cost.build_ns / options.iterations / encoder.bits);
+    printf("%-12s %12" PRIu64 " %14.1f\n", "hdlc", cost.encode_ns / options.iterations, (double)cost.encode_ns / options.iterations / encoder.bits);
+    printf("%-12s %12" PRIu64 " %14.1f\n", "modulate", cost.modulate_ns / options.iterations, (double)cost.modulate_ns / options.iterations / encoder.bits);
+    printf("\nFraming takes %.4f%% of the airtime\n", (cost.build_ns + cost.encode_ns) / (double)options.iterations / (airtime * 1e9) * 100);
+
+    if (options.output)
+    {
+        FILE *fd = SIM_WavCreate(options.output, SIM_OUTPUT_SAMPLE_FREQ);
+
+        if (fd == NULL)
+        {
+            fprintf(stderr, "Failed to create %s\n", options.output);
+            return EXIT_FAILURE;
+        }
+
+        SIM_WavFinish(fd, SIM_AprsModulate(line, encoder.bits, samples, fd));
+        printf("Wrote %s\n", options.output);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,427 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "wavfile.h"
+#include "helper/misc.h"
+#include "dsp/bus.h"
+#include "dsp/cw.h"
+#include "dsp/morse.h"
+#include "dsp/nco.h"
+
+// Values below mirror app/cwreader.h and hardware/audio.h
+
+// Define audio input sampling frequency in Hz, the decoder runs at it
+#define SIM_INPUT_SAMPLE_FREQ 32000
+// Define max amount of decoded characters kept
+#define SIM_CW_MAX_TEXT 4096
+// Define fixture generation
+#define SIM_CW_AMPLITUDE 8000
+#define SIM_CW_RAMP_MS 5
+#define SIM_CW_LEAD_MS 1000
+#define SIM_CW_TAIL_MS 2000
+// Define bandwidth the SNR of the fixtures is given in, a typical receiver audio passband
+#define SIM_CW_NOISE_BANDWIDTH 2500
+#define SIM_CW_DEFAULT_TEXT "CQ CQ DE N0CALL N0CALL PSE K RST 599 QTH PARIS NAME ED 73 TU SK"
+
+typedef struct
+{
+    bool sweep;
+    uint16_t freq;
+    const char *text;
+    const char *fixtures; // prefix of the fixture files written by the sweep
+    const char *input;
+} SIM_CwOptions_t;
+
+typedef struct
+{
+    char text[SIM_CW_MAX_TEXT];
+    size_t len;
+} SIM_CwText_t;
+
+static const uint8_t SIM_CW_SWEEP_WPM[] = {5, 10, 15, 20, 25, 30, 40};
+static const int8_t SIM_CW_SWEEP_SNR[] = {20, 10, 6, 3, 0, -3};
+
+static uint64_t SIM_Nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void SIM_CwUsage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] input.wav\n"
+            "       %s -s [options]\n"
+            "Decodes Morse code from input.wav like the CW reader on the device does,\n"
+            "or sweeps generated fixtures over speed and SNR and reports the character error rate.\n"
+            "  -s          sweep generated fixtures instead of decoding a file\n"
+            "  -t text     text of the fixtures (default \"" SIM_CW_DEFAULT_TEXT "\")\n"
+            "  -f freq     tone frequency of the fixtures in Hz (default 700)\n"
+            "  -o prefix   write fixtures to prefix-<wpm>wpm-<snr>db.wav\n",
+            name, name);
+}
+
+static bool SIM_CwParseOptions(int argc, char **argv, SIM_CwOptions_t *options)
+{
+    int opt;
+
+    *options = (SIM_CwOptions_t){.freq = 700, .text = SIM_CW_DEFAULT_TEXT};
+
+    while ((opt = getopt(argc, argv, "st:f:o:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            options->sweep = true;
+            break;
+        case 't':
+            options->text = optarg;
+            break;
+        case 'f':
+            options->freq = atoi(optarg);
+            break;
+        case 'o':
+            options->fixtures = optarg;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (options->sweep)
+        return argc == optind;
+
+    if (argc - optind != 1)
+        return false;
+
+    options->input = argv[optind];
+
+    return true;
+}
+
+// Mirrors CWREADER_Character without the websocket
+static void SIM_CwCharacter(char c, void *arg)
+{
+    SIM_CwText_t *text = (SIM_CwText_t *)arg;
+
+    if (text->len < sizeof(text->text) - 1)
+    {
+        text->text[text->len++] = c;
+        text->text[text->len] = '\0';
+    }
+}
+
+// Run the decoder in audio bus sized blocks, returns time spent in ns
+static uint64_t SIM_CwDecode(const int16_t *samples, size_t len, SIM_CwText_t *text, CW_t *cw)
+{
+    *text = (SIM_CwText_t){0};
+    CW_Init(cw, SIM_INPUT_SAMPLE_FREQ, SIM_CwCharacter, text);
+
+    const uint64_t started = SIM_Nanoseconds();
+
+    for (size_t i = 0; i < len; i += BUS_BLOCK_SIZE)
+    {
+        CW_Process(cw, &samples[i], (len - i < BUS_BLOCK_SIZE) ? len - i : BUS_BLOCK_SIZE);
+    }
+
+    return SIM_Nanoseconds() - started;
+}
+
+// Linear interpolation to the input sample rate of the device
+static int16_t *SIM_CwResample(const SIM_Wav_t *wav, size_t *len)
+{
+    *len = (uint64_t)wav->len * SIM_INPUT_SAMPLE_FREQ / wav->sample_rate;
+
+    int16_t *samples = malloc(*len * sizeof(int16_t));
+
+    if (samples == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < *len; i++)
+    {
+        const uint64_t position = (uint64_t)i * wav->sample_rate;
+        const size_t index = position / SIM_INPUT_SAMPLE_FREQ;
+        const int32_t frac = position % SIM_INPUT_SAMPLE_FREQ;
+        const int32_t a = wav->samples[index];
+        const int32_t b = (index + 1 < wav->len) ? wav->samples[index + 1] : a;
+
+        samples[i] = a + (int32_t)((int64_t)(b - a) * frac / SIM_INPUT_SAMPLE_FREQ);
+    }
+
+    return samples;
+}
+
+// Standard normal deviate, Box-Muller
+static double SIM_CwGaussian(void)
+{
+    const double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    const double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+// Render the text keyed at the speed with white noise at the SNR, returns the amount of samples
+static int16_t *SIM_CwGenerate(const char *text, uint8_t wpm, int8_t snr, uint16_t freq, size_t *len)
+{
+    const size_t text_len = strlen(text);
+    MORSE_Timing_t timing;
+    MORSE_Element_t *elements = malloc(MORSE_MAX_ELEMENTS(text_len) * sizeof(MORSE_Element_t));
+
+    if (elements == NULL)
+        return NULL;
+
+    MORSE_Timing(&timing, wpm, 0);
+
+    const size_t count = MORSE_Encode(text, text_len, &timing, elements, MORSE_MAX_ELEMENTS(text_len));
+    uint64_t duration_ms = SIM_CW_LEAD_MS + SIM_CW_TAIL_MS;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        duration_ms += elements[i].duration_ms;
+    }
+
+    *len = duration_ms * SIM_INPUT_SAMPLE_FREQ / 1000;
+
+    int16_t *samples = malloc(*len * sizeof(int16_t));
+
+    if (samples == NULL)
+    {
+        free(elements);
+        return NULL;
+    }
+
+    // Tone power is A^2/2, spread the noise so the receiver passband holds tone power / SNR
+    const double sigma = sqrt(SIM_CW_AMPLITUDE * SIM_CW_AMPLITUDE / 2.0 / pow(10.0, snr / 10.0) * (SIM_INPUT_SAMPLE_FREQ / 2.0) / SIM_CW_NOISE_BANDWIDTH);
+    const size_t ramp = SIM_CW_RAMP_MS * SIM_INPUT_SAMPLE_FREQ / 1000;
+    size_t position = SIM_CW_LEAD_MS * SIM_INPUT_SAMPLE_FREQ / 1000;
+    NCO_t nco;
+
+    NCO_Init(&nco);
+    NCO_SetFreq(&nco, freq, SIM_INPUT_SAMPLE_FREQ);
+    memset(samples, 0, *len * sizeof(int16_t));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const size_t n = (size_t)elements[i].duration_ms * SIM_INPUT_SAMPLE_FREQ / 1000;
+
+        for (size_t j = 0; j < n && elements[i].key; j++)
+        {
+            const size_t edge = (j < n - j) ? j : n - j;
+            const double envelope = (edge < ramp) ? 0.5 - 0.5 * cos(M_PI * edge / ramp) : 1.0;
+
+            samples[position + j] = NCO_Sine(nco.phase) * envelope * SIM_CW_AMPLITUDE / INT16_MAX;
+            nco.phase += nco.step;
+        }
+
+        position += n;
+    }
+
+    for (size_t i = 0; i < *len; i++)
+    {
+        const double x = samples[i] + SIM_CwGaussian() * sigma;
+
+        samples[i] = (x > INT16_MAX) ? INT16_MAX : (x < INT16_MIN) ? INT16_MIN : x;
+    }
+
+    free(elements);
+
+    return samples;
+}
+
+// Reference as the decoder reports it, upper case with single spaces
+static void SIM_CwNormalize(const char *text, char *output, size_t size)
+{
+    size_t len = 0;
+
+    for (; *text && len < size - 1; text++)
+    {
+        const char c = (*text >= 'a' && *text <= 'z') ? *text - 'a' + 'A' : *text;
+
+        if (c == ' ' && (len == 0 || output[len - 1] == ' '))
+            continue;
+
+        output[len++] = c;
+    }
+
+    while (len > 0 && output[len - 1] == ' ')
+    {
+        len--;
+    }
+
+    output[len] = '\0';
+}
+
+// Levenshtein distance, counts substituted, dropped and inserted characters
+static size_t SIM_CwDistance(const char *a, const char *b)
+{
+    const size_t a_len = strlen(a);
+    const size_t b_len = strlen(b);
+    size_t *row = malloc((b_len + 1) * sizeof(size_t));
+
+    for (size_t j = 0; j <= b_len; j++)
+    {
+        row[j] = j;
+    }
+
+    for (size_t i = 1; i <= a_len; i++)
+    {
+        size_t diagonal = row[0];
+
+        row[0] = i;
+
+        for (size_t j = 1; j <= b_len; j++)
+        {
+            const size_t above = row[j];
+            size_t best = diagonal + (a[i - 1] != b[j - 1]);
+
+            best = (above + 1 < best) ? above + 1 : best;
+            best = (row[j - 1] + 1 < best) ? row[j - 1] + 1 : best;
+            diagonal = above;
+            row[j] = best;
+        }
+    }
+
+    const size_t distance = row[b_len];
+
+    free(row);
+
+    return distance;
+}
+
+static int SIM_CwSweep(const SIM_CwOptions_t *options)
+{
+    static CW_t cw;
+    static SIM_CwText_t decoded;
+    char reference[SIM_CW_MAX_TEXT];
+    char trimmed[SIM_CW_MAX_TEXT];
+    uint64_t elapsed = 0;
+    uint64_t processed = 0;
+
+    SIM_CwNormalize(options->text, reference, sizeof(reference));
+    srand(1);
+
+    printf("Character error rate of \"%s\" at %u Hz, SNR in %d Hz\n\n", reference, options->freq, SIM_CW_NOISE_BANDWIDTH);
+    printf("  wpm");
+
+    for (size_t s = 0; s < ARRAY_SIZE(SIM_CW_SWEEP_SNR); s++)
+    {
+        printf(" %5d dB", SIM_CW_SWEEP_SNR[s]);
+    }
+
+    printf("\n");
+
+    for (size_t w = 0; w < ARRAY_SIZE(SIM_CW_SWEEP_WPM); w++)
+    {
+        printf("%5u", SIM_CW_SWEEP_WPM[w]);
+
+        for (size_t s = 0; s < ARRAY_SIZE(SIM_CW_SWEEP_SNR); s++)
+        {
+            size_t len;
+            int16_t *samples = SIM_CwGenerate(reference, SIM_CW_SWEEP_WPM[w], SIM_CW_SWEEP_SNR[s], options->freq, &len);
+
+            if (samples == NULL)
+            {
+                fprintf(stderr, "Out of memory\n");
+                return EXIT_FAILURE;
+            }
+
+            if (options->fixtures != NULL)
+            {
+                char filepath[256];
+
+                snprintf(filepath, sizeof(filepath), "%s-%uwpm-%ddb.wav", options->fixtures, SIM_CW_SWEEP_WPM[w], SIM_CW_SWEEP_SNR[s]);
+
+                FILE *fd = SIM_WavCreate(filepath, SIM_INPUT_SAMPLE_FREQ);
+
+                if (fd != NULL)
+                {
+                    fwrite(samples, sizeof(int16_t), len, fd);
+                    SIM_WavFinish(fd, len);
+                }
+            }
+
+            elapsed += SIM_CwDecode(samples, len, &decoded, &cw);
+            processed += len;
+            SIM_CwNormalize(decoded.text, trimmed, sizeof(trimmed));
+            printf(" %7.1f%%", 100.0 * SIM_CwDistance(reference, trimmed) / strlen(reference));
+            free(samples);
+        }
+
+        printf("\n");
+    }
+
+    printf("\nProcessed %" PRIu64 " samples: %.1f ns/sample, %.2f%% of one host core at %d Hz\n",
+           processed, (double)elapsed / processed, (double)elapsed * SIM_INPUT_SAMPLE_FREQ / processed / 1e7, SIM_INPUT_SAMPLE_FREQ);
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    SIM_CwOptions_t options;
+    SIM_Wav_t wav;
+    static CW_t cw;
+    static SIM_CwText_t decoded;
+    size_t len;
+
+    if (!SIM_CwParseOptions(argc, argv, &options))
+    {
+        SIM_CwUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.sweep)
+        return SIM_CwSweep(&options);
+
+    if (SIM_WavLoad(&wav, options.input) != ESP_OK)
+        return EXIT_FAILURE;
+
+    int16_t *samples = SIM_CwResample(&wav, &len);
+
+    if (samples == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        SIM_WavFree(&wav);
+        return EXIT_FAILURE;
+    }
+
+    printf("Decoding %s (%.3f s at %" PRIu32 " Hz, resampled to %d Hz)\n", options.input, (double)wav.len / wav.sample_rate, wav.sample_rate, SIM_INPUT_SAMPLE_FREQ);
+
+    const uint64_t elapsed = SIM_CwDecode(samples, len, &decoded, &cw);
+
+    printf("\n%s\n\nTone %u Hz, %u wpm\n", decoded.text, CW_Frequency(&cw), CW_Wpm(&cw));
+    printf("Processed %zu samples in %.3f s: %.1f ns/sample, %.2f%% of one host core at %d Hz\n",
+           len, elapsed / 1e9, (double)elapsed / len, (double)elapsed * SIM_INPUT_SAMPLE_FREQ / len / 1e7, SIM_INPUT_SAMPLE_FREQ);
+
+    free(samples);
+    SIM_WavFree(&wav);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,42 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+// Host simulator stand-in, mirrors ESP32 ADC DMA result layout from ESP-IDF
+#ifndef SIM_HAL_ADC_TYPES_H
+#define SIM_HAL_ADC_TYPES_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    union
+    {
+        struct
+        {
+            uint16_t data : 12;   // ADC real output data info
+            uint16_t channel : 4; // ADC channel index info
+        } type1;
+        struct
+        {
+            uint16_t data : 11;   // ADC real output data info
+            uint16_t channel : 4; // ADC channel index info
+            uint16_t unit : 1;    // ADC unit index info
+        } type2;
+        uint16_t val;
+    };
+} adc_digi_output_data_t;
+
+#endif
@@ -0,0 +1,396 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "adc.h"
+#include "wavfile.h"
+#include "dsp/bus.h"
+#include "dsp/rx.h"
+#include "dsp/preroll.h"
+#include "helper/misc.h"
+#include "helper/telemetry.h"
+
+// Values below mirror hardware/audio.h and Kconfig defaults
+
+// Define chunk size for audio input we process at a time
+#define SIM_INPUT_CHUNK_SIZE 2048
+// Define audio input sampling frequency in Hz
+#define SIM_INPUT_SAMPLE_FREQ 32000
+// Define amount of consecutive blocks over the squelch threshold needed to open the squelch
+#define SIM_SQUELCH_ATTACK_BLOCKS 1
+// Define how long the squelch stays open after the signal drops under the threshold in ms
+#define SIM_SQUELCH_HANG_MS 2000
+// Define DC tracker time constant as a power of 2 of input blocks
+#define SIM_DC_TRACKER_SHIFT 8
+// Define initial gain used for incoming audio
+#define SIM_AGC_INITIAL_GAIN 10
+// Define max pre-roll length in ms
+#define SIM_PREROLL_MAX_MS 2000
+// Define ADC unit used for the audio input
+#define SIM_ADC_UNIT 0
+
+typedef struct
+{
+    uint8_t upsample_factor;
+    uint8_t squelch;
+    uint16_t preroll_ms;
+    bool agc;
+    bool filter;
+    bool realtime;
+    const char *input;
+    const char *output;
+} SIM_Options_t;
+
+// Recorder consuming the audio bus, mirrors AUDIO_Record without duration limit
+typedef struct
+{
+    BUS_Consumer_t *consumer;
+    PREROLL_t preroll;
+    int16_t buffer[SIM_INPUT_CHUNK_SIZE];
+    size_t buffered;
+    FILE *fd;
+    uint32_t samples_written;
+} SIM_Recorder_t;
+
+static BUS_t bus;
+static RX_Ingest_t ingest;
+static PIPELINE_t pipeline;
+static AGC_t agc;
+static RX_Filters_t filters;
+
+// Host clock in nanoseconds, stands in for the CPU cycle counter
+static uint32_t SIM_Clock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)(now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+static double SIM_Seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void SIM_RecorderWrite(SIM_Recorder_t *recorder, const int16_t *samples, size_t len)
+{
+    const uint32_t start = SIM_Clock();
+
+    recorder->samples_written += fwrite(samples, sizeof(int16_t), len, recorder->fd);
+
+    TELEMETRY_Record(TELEMETRY_STAGE_FILE_WRITE, SIM_Clock() - start);
+}
+
+static void SIM_RecorderProcess(int16_t *samples, size_t len)
+{
+    const uint32_t start = SIM_Clock();
+
+    PIPELINE_Process(&pipeline, samples, len);
+
+    TELEMETRY_Record(TELEMETRY_STAGE_PIPELINE, SIM_Clock() - start);
+}
+
+// Read all the published blocks
+static void SIM_RecorderConsume(SIM_Recorder_t *recorder, bool squelch_open)
+{
+    const BUS_Block_t *block;
+
+    while ((block = BUS_Peek(&bus, recorder->consumer)) != NULL)
+    {
+        // Keep audio in the pre-roll until squelch opens
+        if (!squelch_open)
+        {
+            PREROLL_Push(&recorder->preroll, block->samples, block->len);
+
+            if (!BUS_Release(&bus, recorder->consumer))
+            {
+                PREROLL_Reset(&recorder->preroll);
+            }
+            continue;
+        }
+
+        // Squelch just opened, write the pre-roll ahead of the live stream
+        if (recorder->preroll.len > 0)
+        {
+            if (recorder->buffered > 0)
+            {
+                SIM_RecorderWrite(recorder, recorder->buffer, recorder->buffered);
+                recorder->buffered = 0;
+            }
+
+            const size_t preroll_len = PREROLL_Linearize(&recorder->preroll);
+
+            SIM_RecorderProcess(recorder->preroll.samples, preroll_len);
+            SIM_RecorderWrite(recorder, recorder->preroll.samples, preroll_len);
+            PREROLL_Reset(&recorder->preroll);
+        }
+
+        const size_t count = block->len;
+
+        memcpy(&recorder->buffer[recorder->buffered], block->samples, count * sizeof(int16_t));
+
+        if (BUS_Release(&bus, recorder->consumer))
+        {
+            SIM_RecorderProcess(&recorder->buffer[recorder->buffered], count);
+            recorder->buffered += count;
+        }
+
+        // Write to file once the buffer cannot fit another block
+        if (recorder->buffered + BUS_BLOCK_SIZE > SIM_INPUT_CHUNK_SIZE)
+        {
+            SIM_RecorderWrite(recorder, recorder->buffer, recorder->buffered);
+            recorder->buffered = 0;
+        }
+    }
+}
+
+static void SIM_Usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] input.wav output.wav\n"
+            "Replays input.wav through the audio input path and records it like the device would.\n"
+            "  -u factor   upsample factor, 2 or 4 (default 2)\n"
+            "  -s percent  squelch level (default 5)\n"
+            "  -p ms       pre-roll, 0 disables (default 500)\n"
+            "  -a 0|1      AGC (default 1)\n"
+            "  -f 0|1      filters (default 0)\n"
+            "  -r          replay in real time instead of maximum speed\n",
+            name);
+}
+
+static bool SIM_ParseOptions(int argc, char **argv, SIM_Options_t *options)
+{
+    int opt;
+
+    *options = (SIM_Options_t){
+        .upsample_factor = 2,
+        .squelch = 5,
+        .preroll_ms = 500,
+        .agc = true,
+        .filter = false,
+        .realtime = false};
+
+    while ((opt = getopt(argc, argv, "u:s:p:a:f:rh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'u':
+            options->upsample_factor = atoi(optarg);
+            break;
+        case 's':
+            options->squelch = atoi(optarg);
+            break;
+        case 'p':
+            options->preroll_ms = MIN(atoi(optarg), SIM_PREROLL_MAX_MS);
+            break;
+        case 'a':
+            options->agc = atoi(optarg) != 0;
+            break;
+        case 'f':
+            options->filter = atoi(optarg) != 0;
+            break;
+        case 'r':
+            options->realtime = true;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (argc - optind != 2)
+        return false;
+
+    options->input = argv[optind];
+    options->output = argv[optind + 1];
+
+    return true;
+}
+
+static void SIM_Report(double elapsed, uint64_t samples, double duration)
+{
+    printf("\nProcessed %" PRIu64 " samples in %.3f s: %.0f samples/s, %.1fx real time\n",
+           samples, elapsed, samples / elapsed, duration / elapsed);
+
+    printf("\n%-12s %10s %10s %10s\n", "stage", "count", "avg ns", "max ns");
+
+    for (TELEMETRY_StageId_t id = 0; id < TELEMETRY_STAGE_LAST; id++)
+    {
+        const TELEMETRY_Stage_t *stage = TELEMETRY_GetStage(id);
+
+        if (stage->count == 0)
+            continue;
+
+        printf("%-12s %10" PRIu32 " %10" PRIu64 " %10" PRIu32 "\n",
+               TELEMETRY_StageName(id), stage->count, stage->total_cycles / stage->count, stage->max_cycles);
+    }
+
+    for (uint8_t i = 0; i < pipeline.len; i++)
+    {
+        const PIPELINE_Stage_t *stage = &pipeline.stages[i];
+
+        if (stage->blocks == 0)
+            continue;
+
+        printf("  %-10s %10" PRIu32 " %10" PRIu64 "\n", stage->name, stage->blocks, stage->cycles / stage->blocks);
+    }
+
+    for (TELEMETRY_CounterId_t id = 0; id < TELEMETRY_COUNTER_LAST; id++)
+    {
+        if (TELEMETRY_GetCounter(id) > 0)
+        {
+            printf("%s: %" PRIu32 "\n", TELEMETRY_CounterName(id), TELEMETRY_GetCounter(id));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    SIM_Options_t options;
+    SIM_Recorder_t recorder = {0};
+    adc_continuous_handle_t adc = NULL;
+    int16_t *preroll_samples = NULL;
+    uint8_t result[SIM_INPUT_CHUNK_SIZE] __attribute__((aligned(4)));
+    uint32_t received_bytes;
+    uint64_t samples_in = 0;
+    int ret = EXIT_FAILURE;
+
+    if (!SIM_ParseOptions(argc, argv, &options))
+    {
+        SIM_Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    RX_IngestInit(&ingest, SIM_DC_TRACKER_SHIFT, SIM_SQUELCH_ATTACK_BLOCKS, (SIM_SQUELCH_HANG_MS * SIM_INPUT_SAMPLE_FREQ) / 1000, SIM_Clock);
+
+    if (!DECIMATOR_Init(&ingest.decimator, options.upsample_factor))
+    {
+        fprintf(stderr, "Unsupported upsample factor: %d\n", options.upsample_factor);
+        return EXIT_FAILURE;
+    }
+
+    SIM_AdcConfig_t adc_config = {
+        .filepath = options.input,
+        .sample_freq = SIM_INPUT_SAMPLE_FREQ * options.upsample_factor,
+        .realtime = options.realtime};
+
+    if (SIM_AdcOpen(&adc_config, &adc) != ESP_OK)
+    {
+        return EXIT_FAILURE;
+    }
+
+    BUS_Init(&bus, NULL);
+    AGC_Init(&agc, SIM_AGC_INITIAL_GAIN);
+    RX_PipelineBuild(&pipeline, SIM_Clock, options.agc ? &agc : NULL, options.filter ? &filters : NULL, SIM_INPUT_SAMPLE_FREQ);
+
+    const size_t preroll_capacity = options.preroll_ms * SIM_INPUT_SAMPLE_FREQ / 1000;
+
+    if (preroll_capacity > 0)
+    {
+        preroll_samples = malloc(preroll_capacity * sizeof(int16_t));
+    }
+
+    PREROLL_Init(&recorder.preroll, preroll_samples, preroll_samples ? preroll_capacity : 0);
+    recorder.consumer = BUS_Subscribe(&bus, "recorder", NULL);
+    recorder.fd = SIM_WavCreate(options.output, SIM_INPUT_SAMPLE_FREQ);
+
+    if (recorder.fd == NULL)
+    {
+        fprintf(stderr, "Failed to create %s\n", options.output);
+        goto Done;
+    }
+
+    printf("Replaying %s (%.3f s), ADC at %" PRIu32 " Hz%s\n", options.input, SIM_AdcDuration(adc), adc_config.sample_freq, options.realtime ? " in real time" : "");
+
+    const double started = SIM_Seconds();
+
+    while (1)
+    {
+        size_t samples, block_len;
+
+        SIM_AdcWait(adc, SIM_INPUT_CHUNK_SIZE);
+
+        const uint32_t cycles_start = SIM_Clock();
+
+        if (adc_continuous_read(adc, result, SIM_INPUT_CHUNK_SIZE, &received_bytes, 0) != ESP_OK)
+            break;
+
+        const uint32_t cycles_read = SIM_Clock();
+
+        samples = RX_Unpack(result, received_bytes, SOC_ADC_CHANNEL_NUM(SIM_ADC_UNIT));
+
+        const uint32_t cycles_decode = SIM_Clock();
+
+        BUS_Block_t *block = BUS_WriteBlock(&bus);
+        SQUELCH_Event_t event = RX_IngestProcess(&ingest, (int16_t *)result, samples, block->samples, &block_len, options.squelch);
+        block->len = block_len;
+
+        const uint32_t cycles_ingest = SIM_Clock();
+
+        if (block->len > 0)
+        {
+            BUS_Publish(&bus);
+        }
+
+        TELEMETRY_Record(TELEMETRY_STAGE_ADC_READ, cycles_read - cycles_start);
+        TELEMETRY_Record(TELEMETRY_STAGE_DECODE, cycles_decode - cycles_read);
+        TELEMETRY_Record(TELEMETRY_STAGE_PUBLISH, SIM_Clock() - cycles_ingest);
+
+        // Timestamp of the end of the block in the input
+        samples_in += block_len;
+
+        if (event != SQUELCH_EVENT_NONE)
+        {
+            printf("%8.3f s squelch %s (peak %d, rms %d, dc %d)\n",
+                   (double)samples_in / SIM_INPUT_SAMPLE_FREQ,
+                   event == SQUELCH_EVENT_OPEN ? "open" : "close",
+                   ingest.squelch.peak,
+                   ingest.squelch.rms,
+                   DC_Value(&ingest.dc));
+        }
+
+        SIM_RecorderConsume(&recorder, ingest.squelch.open);
+    }
+
+    if (recorder.buffered > 0)
+    {
+        SIM_RecorderWrite(&recorder, recorder.buffer, recorder.buffered);
+    }
+
+    SIM_Report(SIM_Seconds() - started, samples_in, SIM_AdcDuration(adc));
+
+    printf("\nRecorded %" PRIu32 " samples (%.3f s) to %s\n", recorder.samples_written, (double)recorder.samples_written / SIM_INPUT_SAMPLE_FREQ, options.output);
+
+    SIM_WavFinish(recorder.fd, recorder.samples_written);
+    ret = EXIT_SUCCESS;
+
+Done:
+    free(preroll_samples);
+    SIM_AdcClose(adc);
+
+    return ret;
+}
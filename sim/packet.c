@@ -0,0 +1,196 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "wavfile.h"
+#include "dsp/ax25.h"
+#include "dsp/bus.h"
+#include "dsp/demod.h"
+
+// Values below mirror app/packet.h and hardware/audio.h
+
+// Define audio input sampling frequency in Hz, the decoder runs at it
+#define SIM_INPUT_SAMPLE_FREQ 32000
+// Define Bell 202 modulation
+#define SIM_PACKET_BAUD 1200
+#define SIM_PACKET_MARK_FREQ 1200
+#define SIM_PACKET_SPACE_FREQ 2200
+
+typedef struct
+{
+    bool quiet;
+    const char *input;
+} SIM_PacketOptions_t;
+
+typedef struct
+{
+    bool quiet;
+    uint32_t valid;   // frames that passed the FCS check and formatted as AX.25 UI
+    uint32_t invalid; // frames that passed the FCS check only
+    uint64_t sample;  // position of the decoder in the input
+} SIM_PacketStats_t;
+
+static uint64_t SIM_Nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void SIM_PacketUsage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] input.wav\n"
+            "Decodes 1200 baud AX.25 packets from input.wav like the packet decoder on the device does.\n"
+            "  -q          only print the summary\n",
+            name);
+}
+
+static bool SIM_PacketParseOptions(int argc, char **argv, SIM_PacketOptions_t *options)
+{
+    int opt;
+
+    *options = (SIM_PacketOptions_t){.quiet = false};
+
+    while ((opt = getopt(argc, argv, "qh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'q':
+            options->quiet = true;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (argc - optind != 1)
+        return false;
+
+    options->input = argv[optind];
+
+    return true;
+}
+
+// Mirrors PACKET_Received without the websocket and the log
+static void SIM_PacketReceived(const uint8_t *frame, size_t len, void *arg)
+{
+    SIM_PacketStats_t *stats = (SIM_PacketStats_t *)arg;
+    char text[AX25_MAX_TEXT_SIZE];
+
+    if (AX25_Format(frame, len, text, sizeof(text)) == 0)
+    {
+        stats->invalid++;
+        return;
+    }
+
+    stats->valid++;
+
+    if (!stats->quiet)
+    {
+        printf("%4" PRIu32 " %9.3f s %s\n", stats->valid, (double)stats->sample / SIM_INPUT_SAMPLE_FREQ, text);
+    }
+}
+
+// Linear interpolation to the input sample rate of the device
+static int16_t *SIM_PacketResample(const SIM_Wav_t *wav, size_t *len)
+{
+    *len = (uint64_t)wav->len * SIM_INPUT_SAMPLE_FREQ / wav->sample_rate;
+
+    int16_t *samples = malloc(*len * sizeof(int16_t));
+
+    if (samples == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < *len; i++)
+    {
+        // Position in the input in 1/SIM_INPUT_SAMPLE_FREQ units
+        const uint64_t position = (uint64_t)i * wav->sample_rate;
+        const size_t index = position / SIM_INPUT_SAMPLE_FREQ;
+        const int32_t frac = position % SIM_INPUT_SAMPLE_FREQ;
+        const int32_t a = wav->samples[index];
+        const int32_t b = (index + 1 < wav->len) ? wav->samples[index + 1] : a;
+
+        samples[i] = a + (int32_t)((int64_t)(b - a) * frac / SIM_INPUT_SAMPLE_FREQ);
+    }
+
+    return samples;
+}
+
+int main(int argc, char **argv)
+{
+    SIM_PacketOptions_t options;
+    SIM_PacketStats_t stats = {0};
+    SIM_Wav_t wav;
+    static DEMOD_t demod;
+    size_t len;
+
+    if (!SIM_PacketParseOptions(argc, argv, &options))
+    {
+        SIM_PacketUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (SIM_WavLoad(&wav, options.input) != ESP_OK)
+        return EXIT_FAILURE;
+
+    int16_t *samples = SIM_PacketResample(&wav, &len);
+
+    if (samples == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        SIM_WavFree(&wav);
+        return EXIT_FAILURE;
+    }
+
+    stats.quiet = options.quiet;
+    DEMOD_Init(&demod, SIM_INPUT_SAMPLE_FREQ, SIM_PACKET_BAUD, SIM_PACKET_MARK_FREQ, SIM_PACKET_SPACE_FREQ, SIM_PacketReceived, &stats);
+
+    printf("Decoding %s (%.3f s at %" PRIu32 " Hz, resampled to %d Hz)\n", options.input, (double)wav.len / wav.sample_rate, wav.sample_rate, SIM_INPUT_SAMPLE_FREQ);
+
+    const uint64_t started = SIM_Nanoseconds();
+
+    // Feed blocks of the audio bus size like the device does
+    for (size_t i = 0; i < len; i += BUS_BLOCK_SIZE)
+    {
+        const size_t block_len = (len - i < BUS_BLOCK_SIZE) ? len - i : BUS_BLOCK_SIZE;
+
+        DEMOD_Process(&demod, &samples[i], block_len);
+        stats.sample += block_len;
+    }
+
+    const uint64_t elapsed = SIM_Nanoseconds() - started;
+    const double duration = (double)len / SIM_INPUT_SAMPLE_FREQ;
+
+    printf("\nDecoded %" PRIu32 " frames (%" PRIu32 " more passed FCS but are not AX.25 UI)\n", stats.valid, stats.invalid);
+    printf("Processed %zu samples in %.3f s: %.1f ns/sample, %.2f%% of one host core at %d Hz\n",
+           len, elapsed / 1e9, (double)elapsed / len, elapsed / (duration * 1e9) * 100, SIM_INPUT_SAMPLE_FREQ);
+
+    free(samples);
+    SIM_WavFree(&wav);
+
+    return EXIT_SUCCESS;
+}
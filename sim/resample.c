@@ -0,0 +1,252 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "helper/misc.h"
+#include "dsp/resampler.h"
+
+// Define output rate of the device, AUDIO_OUTPUT_SAMPLE_FREQ in hardware/audio.h
+#define SIM_OUTPUT_SAMPLE_FREQ 32000
+// Define length of each test tone in ms
+#define SIM_RESAMPLE_TONE_MS 500
+// Define output samples skipped while the filters fill up
+#define SIM_RESAMPLE_SETTLE 256
+// Define amplitude of the test tones, half of the full scale
+#define SIM_RESAMPLE_AMPLITUDE 16384
+// Define input block size, same as AUDIO_WAV_BLOCK_FRAMES
+#define SIM_RESAMPLE_BLOCK 512
+// Define amount of tones swept across the stopband
+#define SIM_RESAMPLE_STOPBAND_STEPS 48
+// Define limits the sweep is checked against
+#define SIM_RESAMPLE_MIN_SNR_DB 50.0
+#define SIM_RESAMPLE_MAX_ALIAS_DB -60.0
+
+// Rates of the wav files people play, the device supports RESAMPLER_MIN_RATE to RESAMPLER_MAX_RATE
+static const uint32_t SIM_RESAMPLE_RATES[] = {8000, 11025, 16000, 22050, 32000, 44100, 48000, 88200, 96000, 176400, 192000};
+// Passband tones, the ones above 0.4 of the lower rate are skipped
+static const uint32_t SIM_RESAMPLE_PASSBAND[] = {300, 1000, 3000, 6000, 10000, 12000};
+
+static uint64_t SIM_Nanoseconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void SIM_ResampleUsage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-o rate]\n"
+            "Resamples tones from the usual wav rates like the wav player on the device does,\n"
+            "reports the passband SNR and the strongest alias of the stopband tones.\n"
+            "  -o rate     output rate in Hz (default %d)\n",
+            name, SIM_OUTPUT_SAMPLE_FREQ);
+}
+
+// Resample a tone of the frequency in blocks of the wav player, returns amount of output samples
+static size_t SIM_ResampleTone(RESAMPLER_t *resampler, uint32_t input_rate, double freq, int16_t *output, size_t max, uint64_t *elapsed)
+{
+    const size_t len = (size_t)input_rate * SIM_RESAMPLE_TONE_MS / 1000;
+    int16_t block[SIM_RESAMPLE_BLOCK];
+    size_t out = 0;
+
+    for (size_t i = 0; i < len; i += SIM_RESAMPLE_BLOCK)
+    {
+        const size_t block_len = MIN(len - i, (size_t)SIM_RESAMPLE_BLOCK);
+        size_t offset = 0;
+
+        for (size_t j = 0; j < block_len; j++)
+        {
+            block[j] = (int16_t)lrint(SIM_RESAMPLE_AMPLITUDE * sin(2.0 * M_PI * freq * (i + j) / input_rate));
+        }
+
+        const uint64_t started = SIM_Nanoseconds();
+
+        while (offset < block_len && out < max)
+        {
+            size_t consumed;
+
+            out += RESAMPLER_Process(resampler, &block[offset], block_len - offset, &consumed, &output[out], max - out);
+            offset += consumed;
+        }
+
+        *elapsed += SIM_Nanoseconds() - started;
+    }
+
+    return out;
+}
+
+// SNR of the tone in dB, the sine of the frequency is fitted to the output, whatever is left is noise and distortion
+static double SIM_ResampleSnr(const int16_t *output, size_t len, double freq, uint32_t output_rate)
+{
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+
+    for (size_t i = SIM_RESAMPLE_SETTLE; i < len; i++)
+    {
+        const double s = sin(2.0 * M_PI * freq * i / output_rate);
+        const double c = cos(2.0 * M_PI * freq * i / output_rate);
+
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += output[i] * s;
+        yc += output[i] * c;
+    }
+
+    const double det = ss * cc - sc * sc;
+    const double a = (ys * cc - yc * sc) / det;
+    const double b = (yc * ss - ys * sc) / det;
+    double signal = 0, noise = 0;
+
+    for (size_t i = SIM_RESAMPLE_SETTLE; i < len; i++)
+    {
+        const double fit = a * sin(2.0 * M_PI * freq * i / output_rate) + b * cos(2.0 * M_PI * freq * i / output_rate);
+
+        signal += fit * fit;
+        noise += (output[i] - fit) * (output[i] - fit);
+    }
+
+    // Rounding to 16 bits bounds the result
+    return 10.0 * log10(signal / MAX(noise, 1e-3));
+}
+
+// Output level relative to the input tone in dB
+static double SIM_ResampleLevel(const int16_t *output, size_t len)
+{
+    double power = 0;
+
+    for (size_t i = SIM_RESAMPLE_SETTLE; i < len; i++)
+    {
+        power += (double)output[i] * output[i];
+    }
+
+    power /= MAX(len - SIM_RESAMPLE_SETTLE, (size_t)1);
+
+    return 10.0 * log10(MAX(power, 1e-3) / (SIM_RESAMPLE_AMPLITUDE * SIM_RESAMPLE_AMPLITUDE / 2.0));
+}
+
+int main(int argc, char **argv)
+{
+    static RESAMPLER_t resampler;
+    uint32_t output_rate = SIM_OUTPUT_SAMPLE_FREQ;
+    uint64_t elapsed = 0;
+    uint64_t processed = 0;
+    bool passed = true;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o':
+            output_rate = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            SIM_ResampleUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const size_t max = (size_t)RESAMPLER_MAX_RATE * SIM_RESAMPLE_TONE_MS / 1000;
+    int16_t *output = malloc(max * sizeof(int16_t));
+
+    if (output == NULL || optind != argc)
+    {
+        SIM_ResampleUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Resampling to %" PRIu32 " Hz, tones at %.0f dBFS\n\n", output_rate, 20.0 * log10(SIM_RESAMPLE_AMPLITUDE / 32768.0));
+    printf("   input  stages  min SNR    at Hz  max alias    at Hz\n");
+
+    for (size_t r = 0; r < ARRAY_SIZE(SIM_RESAMPLE_RATES); r++)
+    {
+        const uint32_t input_rate = SIM_RESAMPLE_RATES[r];
+        const uint32_t lower_rate = MIN(input_rate, output_rate);
+        double min_snr = INFINITY, max_alias = -INFINITY;
+        double min_snr_freq = 0, max_alias_freq = 0;
+
+        if (!RESAMPLER_Init(&resampler, input_rate, output_rate))
+        {
+            fprintf(stderr, "Unsupported rates %" PRIu32 " -> %" PRIu32 "\n", input_rate, output_rate);
+            return EXIT_FAILURE;
+        }
+
+        for (size_t t = 0; t < ARRAY_SIZE(SIM_RESAMPLE_PASSBAND) && SIM_RESAMPLE_PASSBAND[t] <= 0.4 * lower_rate; t++)
+        {
+            const double freq = SIM_RESAMPLE_PASSBAND[t];
+
+            RESAMPLER_Init(&resampler, input_rate, output_rate);
+
+            const size_t len = SIM_ResampleTone(&resampler, input_rate, freq, output, max, &elapsed);
+            const double snr = SIM_ResampleSnr(output, len, freq, output_rate);
+
+            processed += (size_t)input_rate * SIM_RESAMPLE_TONE_MS / 1000;
+
+            if (snr < min_snr)
+            {
+                min_snr = snr;
+                min_snr_freq = freq;
+            }
+        }
+
+        // Input tones the output cannot carry, from just past its Nyquist frequency up to the input one
+        for (size_t s = 0; input_rate > output_rate && s < SIM_RESAMPLE_STOPBAND_STEPS; s++)
+        {
+            const double start = 0.6 * output_rate;
+            const double freq = start + (0.49 * input_rate - start) * s / (SIM_RESAMPLE_STOPBAND_STEPS - 1);
+
+            RESAMPLER_Init(&resampler, input_rate, output_rate);
+
+            const size_t len = SIM_ResampleTone(&resampler, input_rate, freq, output, max, &elapsed);
+            const double level = SIM_ResampleLevel(output, len);
+
+            processed += (size_t)input_rate * SIM_RESAMPLE_TONE_MS / 1000;
+
+            if (level > max_alias)
+            {
+                max_alias = level;
+                max_alias_freq = freq;
+            }
+        }
+
+        printf("%8" PRIu32 "  %6u  %4.1f dB  %7.0f", input_rate, resampler.stages, min_snr, min_snr_freq);
+
+        if (input_rate > output_rate)
+            printf("  %6.1f dB  %7.0f", max_alias, max_alias_freq);
+
+        printf("\n");
+
+        passed &= min_snr >= SIM_RESAMPLE_MIN_SNR_DB && (input_rate <= output_rate || max_alias <= SIM_RESAMPLE_MAX_ALIAS_DB);
+    }
+
+    printf("\nProcessed %" PRIu64 " input samples: %.1f ns/sample\n", processed, (double)elapsed / processed);
+    printf("%s: SNR at least %.0f dB, aliases at most %.0f dB\n", passed ? "PASS" : "FAIL", SIM_RESAMPLE_MIN_SNR_DB, SIM_RESAMPLE_MAX_ALIAS_DB);
+
+    free(output);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
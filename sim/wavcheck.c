@@ -0,0 +1,304 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "helper/misc.h"
+#include "helper/wav.h"
+#include "wavfile.h"
+
+// Define amount of frames in each fixture
+#define SIM_WAVCHECK_FRAMES 1000
+// Define sample rate of the fixtures
+#define SIM_WAVCHECK_SAMPLE_FREQ 44100
+// Define largest fixture
+#define SIM_WAVCHECK_MAX_SIZE 8192
+
+// Fixture assembled chunk by chunk
+typedef struct
+{
+    uint8_t data[SIM_WAVCHECK_MAX_SIZE];
+    size_t len;
+} SIM_Fixture_t;
+
+// Layout of the fixture files
+typedef enum
+{
+    SIM_WAVCHECK_CANONICAL,   // header as written by the recorder
+    SIM_WAVCHECK_ODD_LIST,    // stereo, odd sized chunk and a LIST chunk in between fmt and data
+    SIM_WAVCHECK_EXTENSIBLE,  // WAVE_FORMAT_EXTENSIBLE fmt, fact, odd sized and LIST chunks
+    SIM_WAVCHECK_TRUNCATED,   // data chunk declares more than the file holds
+    SIM_WAVCHECK_8BIT,        // 8-bit PCM, rejected
+    SIM_WAVCHECK_NO_DATA,     // no data chunk, rejected
+} SIM_WavcheckLayout_t;
+
+// Case checked by the tool
+typedef struct
+{
+    const char *name;
+    SIM_WavcheckLayout_t layout;
+    uint16_t channels;
+    bool valid;       // SIM_WavLoad is expected to succeed
+    size_t frames;    // frames it is expected to load
+} SIM_WavcheckCase_t;
+
+static const SIM_WavcheckCase_t SIM_WAVCHECK_CASES[] = {
+    {"canonical", SIM_WAVCHECK_CANONICAL, 1, true, SIM_WAVCHECK_FRAMES},
+    {"odd chunk and LIST before data", SIM_WAVCHECK_ODD_LIST, 2, true, SIM_WAVCHECK_FRAMES},
+    {"extensible with fact and LIST", SIM_WAVCHECK_EXTENSIBLE, 2, true, SIM_WAVCHECK_FRAMES},
+    {"truncated data", SIM_WAVCHECK_TRUNCATED, 1, true, SIM_WAVCHECK_FRAMES / 2},
+    {"8-bit", SIM_WAVCHECK_8BIT, 1, false, 0},
+    {"no data", SIM_WAVCHECK_NO_DATA, 1, false, 0},
+};
+
+static void SIM_WavcheckUsage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-k]\n"
+            "Writes wav files with the chunk layouts found in the wild and checks the simulator\n"
+            "loads them through the firmware's WAV_Parse.\n"
+            "  -k          keep the fixtures\n",
+            name);
+}
+
+static void SIM_Put16(SIM_Fixture_t *fixture, uint16_t value)
+{
+    fixture->data[fixture->len++] = value & 0xFF;
+    fixture->data[fixture->len++] = value >> 8;
+}
+
+static void SIM_Put32(SIM_Fixture_t *fixture, uint32_t value)
+{
+    SIM_Put16(fixture, value & 0xFFFF);
+    SIM_Put16(fixture, value >> 16);
+}
+
+// Append chunk, odd sized contents are followed by the pad byte
+static void SIM_PutChunk(SIM_Fixture_t *fixture, const char *id, const void *contents, uint32_t size)
+{
+    memcpy(&fixture->data[fixture->len], id, 4);
+    fixture->len += 4;
+    SIM_Put32(fixture, size);
+    memcpy(&fixture->data[fixture->len], contents, size);
+    fixture->len += size;
+
+    if (size & 1)
+    {
+        fixture->data[fixture->len++] = 0;
+    }
+}
+
+// Sample of the frame and channel, channels other than the first are garbage the loader drops
+static int16_t SIM_WavcheckSample(size_t frame, uint16_t channel)
+{
+    return (channel == 0) ? (int16_t)(frame * 37 - 16000) : (int16_t)0x7A7A;
+}
+
+// Build the fixture of the case
+static void SIM_WavcheckBuild(SIM_Fixture_t *fixture, const SIM_WavcheckCase_t *test)
+{
+    static int16_t samples[SIM_WAVCHECK_FRAMES * 2];
+    SIM_Fixture_t fmt = {.len = 0};
+    const uint16_t bits = (test->layout == SIM_WAVCHECK_8BIT) ? 8 : 16;
+    const uint16_t block_align = test->channels * bits / 8;
+    const uint32_t data_size = SIM_WAVCHECK_FRAMES * block_align;
+
+    for (size_t i = 0; i < SIM_WAVCHECK_FRAMES; i++)
+    {
+        for (uint16_t c = 0; c < test->channels; c++)
+        {
+            samples[i * test->channels + c] = SIM_WavcheckSample(i, c);
+        }
+    }
+
+    SIM_Put16(&fmt, (test->layout == SIM_WAVCHECK_EXTENSIBLE) ? WAV_FORMAT_EXTENSIBLE : WAV_FORMAT_PCM);
+    SIM_Put16(&fmt, test->channels);
+    SIM_Put32(&fmt, SIM_WAVCHECK_SAMPLE_FREQ);
+    SIM_Put32(&fmt, SIM_WAVCHECK_SAMPLE_FREQ * block_align);
+    SIM_Put16(&fmt, block_align);
+    SIM_Put16(&fmt, bits);
+
+    if (test->layout == SIM_WAVCHECK_EXTENSIBLE)
+    {
+        // cbSize, valid bits, channel mask and the KSDATAFORMAT_SUBTYPE_PCM GUID
+        static const uint8_t guid_tail[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+        SIM_Put16(&fmt, 22);
+        SIM_Put16(&fmt, bits);
+        SIM_Put32(&fmt, 0x3);
+        SIM_Put16(&fmt, WAV_FORMAT_PCM);
+        memcpy(&fmt.data[fmt.len], guid_tail, sizeof(guid_tail));
+        fmt.len += sizeof(guid_tail);
+    }
+
+    fixture->len = 0;
+    memcpy(fixture->data, "RIFF", 4);
+    fixture->len = 8;
+    memcpy(&fixture->data[fixture->len], "WAVE", 4);
+    fixture->len += 4;
+
+    SIM_PutChunk(fixture, "fmt ", fmt.data, fmt.len);
+
+    if (test->layout == SIM_WAVCHECK_EXTENSIBLE)
+    {
+        uint8_t fact[4] = {SIM_WAVCHECK_FRAMES & 0xFF, SIM_WAVCHECK_FRAMES >> 8, 0, 0};
+
+        SIM_PutChunk(fixture, "fact", fact, sizeof(fact));
+    }
+
+    if (test->layout == SIM_WAVCHECK_ODD_LIST || test->layout == SIM_WAVCHECK_EXTENSIBLE)
+    {
+        // Odd sized chunk is padded, a reader ignoring the pad byte is off by one from here on
+        static const char id3[] = "ID3";
+        static const char list[] = "INFOISFT\x0e\x00\x00\x00Lavf60.16.100\0";
+
+        SIM_PutChunk(fixture, "id3 ", id3, 3);
+        SIM_PutChunk(fixture, "LIST", list, sizeof(list) - 1);
+    }
+
+    if (test->layout != SIM_WAVCHECK_NO_DATA)
+    {
+        const uint32_t stored = (test->layout == SIM_WAVCHECK_TRUNCATED) ? data_size / 2 : data_size;
+
+        SIM_PutChunk(fixture, "data", samples, stored);
+
+        // Recording cut by power loss, the header claims the whole size
+        if (test->layout == SIM_WAVCHECK_TRUNCATED)
+        {
+            const size_t size_offset = fixture->len - stored - 4;
+
+            fixture->data[size_offset] = data_size & 0xFF;
+            fixture->data[size_offset + 1] = (data_size >> 8) & 0xFF;
+            fixture->data[size_offset + 2] = (data_size >> 16) & 0xFF;
+            fixture->data[size_offset + 3] = data_size >> 24;
+        }
+    }
+
+    const uint32_t riff_size = fixture->len - 8;
+
+    fixture->data[4] = riff_size & 0xFF;
+    fixture->data[5] = (riff_size >> 8) & 0xFF;
+    fixture->data[6] = (riff_size >> 16) & 0xFF;
+    fixture->data[7] = riff_size >> 24;
+}
+
+// Write the fixture of the case, load it and compare the first channel
+static bool SIM_WavcheckRun(const char *dirpath, const SIM_WavcheckCase_t *test, size_t number)
+{
+    static SIM_Fixture_t fixture;
+    char filepath[256];
+    SIM_Wav_t wav;
+    bool passed = true;
+
+    SIM_WavcheckBuild(&fixture, test);
+    snprintf(filepath, sizeof(filepath), "%s/case%zu.wav", dirpath, number);
+
+    FILE *fd = fopen(filepath, "wb");
+
+    if (fd == NULL || fwrite(fixture.data, 1, fixture.len, fd) != fixture.len)
+    {
+        fprintf(stderr, "Failed to write %s\n", filepath);
+        if (fd != NULL)
+            fclose(fd);
+        return false;
+    }
+    fclose(fd);
+
+    const esp_err_t ret = SIM_WavLoad(&wav, filepath);
+
+    if ((ret == ESP_OK) != test->valid)
+    {
+        passed = false;
+    }
+    else if (ret == ESP_OK)
+    {
+        passed = wav.len == test->frames && wav.sample_rate == SIM_WAVCHECK_SAMPLE_FREQ;
+
+        for (size_t i = 0; passed && i < wav.len; i++)
+        {
+            passed = wav.samples[i] == SIM_WavcheckSample(i, 0);
+        }
+    }
+
+    printf("%-32s %5zu bytes  %-8s %5zu frames  %s\n", test->name, fixture.len, (ret == ESP_OK) ? "loaded" : "rejected", wav.len, passed ? "ok" : "FAIL");
+
+    SIM_WavFree(&wav);
+
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    char dirpath[] = "/tmp/espri-wavcheck-XXXXXX";
+    bool keep = false;
+    bool passed = true;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "kh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'k':
+            keep = true;
+            break;
+        default:
+            SIM_WavcheckUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind != argc)
+    {
+        SIM_WavcheckUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (mkdtemp(dirpath) == NULL)
+    {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(SIM_WAVCHECK_CASES); i++)
+    {
+        passed &= SIM_WavcheckRun(dirpath, &SIM_WAVCHECK_CASES[i], i);
+    }
+
+    if (keep)
+    {
+        printf("\nFixtures kept in %s\n", dirpath);
+    }
+    else
+    {
+        char filepath[256];
+
+        for (size_t i = 0; i < ARRAY_SIZE(SIM_WAVCHECK_CASES); i++)
+        {
+            snprintf(filepath, sizeof(filepath), "%s/case%zu.wav", dirpath, i);
+            unlink(filepath);
+        }
+        rmdir(dirpath);
+    }
+
+    printf("%s: %zu wav layouts\n", passed ? "PASS" : "FAIL", ARRAY_SIZE(SIM_WAVCHECK_CASES));
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
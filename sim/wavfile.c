@@ -0,0 +1,160 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "wavfile.h"
+#include "helper/wav.h"
+
+// Canonical header written by the recorder
+typedef struct __attribute__((packed))
+{
+    uint8_t ChunkID[4];
+    int32_t ChunkSize;
+    uint8_t Format[4];
+    uint8_t Subchunk1ID[4];
+    int32_t Subchunk1Size;
+    int16_t AudioFormat;
+    int16_t NumChannels;
+    int32_t SampleRate;
+    int32_t ByteRate;
+    int16_t BlockAlign;
+    int16_t BitsPerSample;
+    uint8_t Subchunk2ID[4];
+    int32_t Subchunk2Size;
+} SIM_WavHeader_t;
+
+/// @brief Load 16-bit PCM WAV file, the firmware's WAV_Parse walks the chunks so extra ones are skipped
+/// @param wav loaded file
+/// @param filepath path to the file
+/// @return ESP_OK on success
+esp_err_t SIM_WavLoad(SIM_Wav_t *wav, const char *filepath)
+{
+    esp_err_t ret = ESP_FAIL;
+    WAV_Info_t info;
+    int16_t *frames = NULL;
+
+    memset(wav, 0, sizeof(SIM_Wav_t));
+
+    FILE *fd = fopen(filepath, "rb");
+
+    if (fd == NULL)
+    {
+        fprintf(stderr, "Failed to open %s\n", filepath);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (WAV_Parse(fd, &info) != ESP_OK)
+    {
+        fprintf(stderr, "%s is not a WAV file or has no audio data\n", filepath);
+        goto Done;
+    }
+
+    // WAVE_FORMAT_EXTENSIBLE files come with the subformat in format
+    if (info.format != WAV_FORMAT_PCM || info.bits != 16 || info.block_align != info.channels * sizeof(int16_t))
+    {
+        fprintf(stderr, "Only 16-bit PCM WAV files are supported\n");
+        goto Done;
+    }
+
+    // Truncated files are accepted, WAV_Parse limits the data to what the file holds
+    size_t frame_count = WAV_Samples(&info);
+
+    frames = malloc(frame_count * info.block_align);
+    wav->samples = malloc(frame_count * sizeof(int16_t));
+
+    if (frames == NULL || wav->samples == NULL)
+    {
+        ret = ESP_ERR_NO_MEM;
+        goto Done;
+    }
+
+    frame_count = fread(frames, info.block_align, frame_count, fd);
+
+    for (size_t i = 0; i < frame_count; i++)
+    {
+        wav->samples[i] = frames[i * info.channels];
+    }
+
+    wav->len = frame_count;
+    wav->sample_rate = info.sample_rate;
+    ret = ESP_OK;
+
+Done:
+    free(frames);
+    fclose(fd);
+
+    if (ret != ESP_OK)
+    {
+        SIM_WavFree(wav);
+    }
+
+    return ret;
+}
+
+/// @brief Free loaded WAV file
+/// @param wav loaded file
+void SIM_WavFree(SIM_Wav_t *wav)
+{
+    free(wav->samples);
+    wav->samples = NULL;
+    wav->len = 0;
+}
+
+/// @brief Create mono 16-bit WAV file, header is completed by SIM_WavFinish
+/// @param filepath path to the file
+/// @param sample_rate sample rate in Hz
+/// @return opened file or NULL
+FILE *SIM_WavCreate(const char *filepath, uint32_t sample_rate)
+{
+    SIM_WavHeader_t header = {
+        .ChunkID = "RIFF",
+        .Format = "WAVE",
+        .Subchunk1ID = "fmt ",
+        .Subchunk1Size = 16,
+        .AudioFormat = 1,
+        .NumChannels = 1,
+        .SampleRate = sample_rate,
+        .ByteRate = sample_rate * sizeof(int16_t),
+        .BlockAlign = sizeof(int16_t),
+        .BitsPerSample = 16,
+        .Subchunk2ID = "data"};
+
+    FILE *fd = fopen(filepath, "wb");
+
+    if (fd != NULL)
+    {
+        fwrite(&header, 1, sizeof(header), fd);
+    }
+
+    return fd;
+}
+
+/// @brief Write final sizes into the header and close the file
+/// @param fd file returned by SIM_WavCreate
+/// @param samples_written amount of samples written after the header
+void SIM_WavFinish(FILE *fd, uint32_t samples_written)
+{
+    const int32_t data_size = samples_written * sizeof(int16_t);
+    const int32_t chunk_size = sizeof(SIM_WavHeader_t) - 8 + data_size;
+
+    fseek(fd, offsetof(SIM_WavHeader_t, ChunkSize), SEEK_SET);
+    fwrite(&chunk_size, sizeof(chunk_size), 1, fd);
+    fseek(fd, offsetof(SIM_WavHeader_t, Subchunk2Size), SEEK_SET);
+    fwrite(&data_size, sizeof(data_size), 1, fd);
+    fclose(fd);
+}
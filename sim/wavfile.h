@@ -0,0 +1,39 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef SIM_WAVFILE_H
+#define SIM_WAVFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include <esp_err.h>
+
+// 16-bit PCM WAV file loaded into memory, only the first channel is kept
+typedef struct
+{
+    int16_t *samples;     // samples of the first channel
+    size_t len;           // amount of samples
+    uint32_t sample_rate; // sample rate in Hz
+} SIM_Wav_t;
+
+esp_err_t SIM_WavLoad(SIM_Wav_t *wav, const char *filepath);
+void SIM_WavFree(SIM_Wav_t *wav);
+FILE *SIM_WavCreate(const char *filepath, uint32_t sample_rate);
+void SIM_WavFinish(FILE *fd, uint32_t samples_written);
+
+#endif